@@ -0,0 +1,160 @@
+/**
+ *  The MIT License (MIT)
+ *
+ *  Copyright (c) 2014 Kyle Wray, University of Massachusetts
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy of
+ *  this software and associated documentation files (the "Software"), to deal in
+ *  the Software without restriction, including without limitation the rights to
+ *  use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ *  the Software, and to permit persons to whom the Software is furnished to do so,
+ *  subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ *  FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ *  COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ *  IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ *  CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+#ifndef ACTION_SETS_H
+#define ACTION_SETS_H
+
+
+#include <vector>
+#include <unordered_map>
+#include <cstdint>
+#include <cstddef>
+
+/**
+ * A collection of interned sets of action indices. Each set is a fixed-width bitmask over the
+ * action indices 0 to m-1, and identical sets are stored only once, so a set is referred to by
+ * its index in the collection. The set of all actions always has index 0.
+ */
+class ActionSets {
+public:
+	/**
+	 * The constructor for the ActionSets class.
+	 * @param	numActions	The number of actions, m.
+	 */
+	ActionSets(unsigned int numActions);
+
+	/**
+	 * The deconstructor for the ActionSets class.
+	 */
+	virtual ~ActionSets();
+
+	/**
+	 * Remove all sets, except the set of all actions.
+	 */
+	void clear();
+
+	/**
+	 * Intern a set of actions, adding it if it is not already present.
+	 * @param	mask	The bitmask of the set, with get_num_words() words.
+	 * @return	The index of the set.
+	 */
+	unsigned int intern(const uint64_t *mask);
+
+	/**
+	 * Get the bitmask of a set. It is invalidated by the next call to intern.
+	 * @param	set		The index of the set.
+	 * @return	The bitmask of the set, with get_num_words() words.
+	 */
+	const uint64_t *get(unsigned int set) const;
+
+	/**
+	 * Copy the bitmask of a set into a scratch bitmask which, unlike get, is not invalidated by intern,
+	 * so that it may be modified and interned without allocating. It is invalidated by the next call
+	 * to copy.
+	 * @param	set		The index of the set.
+	 * @return	The copy of the bitmask of the set, with get_num_words() words.
+	 */
+	uint64_t *copy(unsigned int set);
+
+	/**
+	 * Get the number of actions in a set.
+	 * @param	set		The index of the set.
+	 * @return	The number of actions in the set.
+	 */
+	unsigned int get_size(unsigned int set) const;
+
+	/**
+	 * Check if a set contains an action.
+	 * @param	set		The index of the set.
+	 * @param	a		The index of the action.
+	 * @return	True if the action is in the set, false otherwise.
+	 */
+	bool contains(unsigned int set, unsigned int a) const;
+
+	/**
+	 * Get the index of the set of all actions.
+	 * @return	The index of the set of all actions.
+	 */
+	unsigned int get_full() const;
+
+	/**
+	 * Get the number of distinct sets.
+	 * @return	The number of distinct sets.
+	 */
+	unsigned int get_num_sets() const;
+
+	/**
+	 * Get the number of actions, m.
+	 * @return	The number of actions.
+	 */
+	unsigned int get_num_actions() const;
+
+	/**
+	 * Get the number of 64-bit words in each bitmask.
+	 * @return	The number of words in each bitmask.
+	 */
+	unsigned int get_num_words() const;
+
+protected:
+	/**
+	 * Compute the hash of a bitmask.
+	 * @param	mask	The bitmask, with get_num_words() words.
+	 * @return	The hash of the bitmask.
+	 */
+	std::size_t compute_hash(const uint64_t *mask) const;
+
+	/**
+	 * The number of actions.
+	 */
+	unsigned int m;
+
+	/**
+	 * The number of 64-bit words in each bitmask.
+	 */
+	unsigned int words;
+
+	/**
+	 * The bitmasks of the sets, one after the other.
+	 */
+	std::vector<uint64_t> masks;
+
+	/**
+	 * The number of actions in each set.
+	 */
+	std::vector<unsigned int> sizes;
+
+	/**
+	 * The scratch bitmask returned by copy.
+	 */
+	std::vector<uint64_t> scratch;
+
+	/**
+	 * The indices of the sets, keyed by the hash of their bitmasks.
+	 */
+	std::unordered_multimap<std::size_t, unsigned int> lookup;
+
+};
+
+
+#endif // ACTION_SETS_H
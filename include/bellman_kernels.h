@@ -0,0 +1,86 @@
+/**
+ *  The MIT License (MIT)
+ *
+ *  Copyright (c) 2014 Kyle Wray, University of Massachusetts
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy of
+ *  this software and associated documentation files (the "Software"), to deal in
+ *  the Software without restriction, including without limitation the rights to
+ *  use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ *  the Software, and to permit persons to whom the Software is furnished to do so,
+ *  subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ *  FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ *  COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ *  IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ *  CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+#ifndef BELLMAN_KERNELS_H
+#define BELLMAN_KERNELS_H
+
+
+/**
+ * The instruction sets for which Bellman backup kernels exist, from least to most capable.
+ */
+enum BellmanISA {
+	BELLMAN_ISA_SCALAR,
+	BELLMAN_ISA_SSE42,
+	BELLMAN_ISA_AVX2,
+	BELLMAN_ISA_AVX512
+};
+
+/**
+ * A Bellman backup kernel over a range of a compressed sparse row: the expected value, i.e., the sum
+ * over t in [begin, end) of T[t] * V[successors[t]]. The expected reward r(s, a) and the discount
+ * factor are applied by the caller, as r(s, a) + gamma * kernel. The vectorized kernels gather V at
+ * the successor indices, and add the terms in a different order than the scalar kernel does, so their
+ * result is within (end - begin) * 2^-53 times the sum of the terms' absolute values of the scalar result.
+ */
+typedef double (*BellmanKernel)(const unsigned int *successors, const double *T,
+		const double *V, unsigned int begin, unsigned int end);
+
+/**
+ * A Bellman backup kernel over float probabilities and values, which converts each term to double
+ * before accumulating it. The tolerance with respect to the scalar kernel is as for BellmanKernel.
+ */
+typedef double (*BellmanKernelFloat)(const unsigned int *successors, const float *T,
+		const float *V, unsigned int begin, unsigned int end);
+
+/**
+ * Detect the most capable instruction set which this processor supports.
+ * @return	The most capable supported instruction set.
+ */
+BellmanISA bellman_detect_isa();
+
+/**
+ * Get the name of an instruction set.
+ * @param	isa		The instruction set.
+ * @return	The name of the instruction set.
+ */
+const char *bellman_isa_name(BellmanISA isa);
+
+/**
+ * Select the double Bellman backup kernel for an instruction set. If the processor does not
+ * support it, the kernel of the most capable supported instruction set is selected instead.
+ * @param	isa		The instruction set. This will be updated to the one selected.
+ * @return	The kernel.
+ */
+BellmanKernel bellman_select_kernel(BellmanISA &isa);
+
+/**
+ * Select the float Bellman backup kernel for an instruction set. If the processor does not
+ * support it, the kernel of the most capable supported instruction set is selected instead.
+ * @param	isa		The instruction set. This will be updated to the one selected.
+ * @return	The kernel.
+ */
+BellmanKernelFloat bellman_select_kernel_float(BellmanISA &isa);
+
+
+#endif // BELLMAN_KERNELS_H
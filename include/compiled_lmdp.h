@@ -0,0 +1,349 @@
+/**
+ *  The MIT License (MIT)
+ *
+ *  Copyright (c) 2014 Kyle Wray, University of Massachusetts
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy of
+ *  this software and associated documentation files (the "Software"), to deal in
+ *  the Software without restriction, including without limitation the rights to
+ *  use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ *  the Software, and to permit persons to whom the Software is furnished to do so,
+ *  subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ *  FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ *  COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ *  IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ *  CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+#ifndef COMPILED_LMDP_H
+#define COMPILED_LMDP_H
+
+
+#include "../../librbr/librbr/include/core/states/states_map.h"
+#include "../../librbr/librbr/include/core/actions/actions_map.h"
+#include "../../librbr/librbr/include/core/state_transitions/state_transitions.h"
+#include "../../librbr/librbr/include/core/rewards/factored_rewards.h"
+#include "../../librbr/librbr/include/core/horizon.h"
+
+#include <vector>
+#include <unordered_map>
+
+/**
+ * A flat, integer-indexed form of an LMDP's states, actions, state transitions, and factored
+ * rewards. States and actions are numbered 0 to n-1 and 0 to m-1, respectively, and the
+ * successors of each state-action pair are stored in compressed sparse row (CSR) form. The
+ * rewards are folded into their expectation r_i(s, a) = sum_{s'} T(s, a, s') R_i(s, a, s') while
+ * compiling, so a Bellman backup is r_i(s, a) + gamma * sum_{s'} T(s, a, s') V_i(s'), and no
+ * per-successor rewards are kept.
+ */
+class CompiledLMDP {
+public:
+	/**
+	 * The default constructor for the CompiledLMDP class.
+	 */
+	CompiledLMDP();
+
+	/**
+	 * The deconstructor for the CompiledLMDP class.
+	 */
+	virtual ~CompiledLMDP();
+
+	/**
+	 * Compile the model provided into the flat representation. Any previously compiled
+	 * model is discarded.
+	 * @param	S							The finite states.
+	 * @param	A							The finite actions.
+	 * @param	T							The finite state transition function.
+	 * @param	R							The factored state-action-state rewards.
+	 * @param	h							The horizon.
+	 * @throw	StateTransitionException	A successor state was not one of the states.
+	 * @throw	RewardException				A reward factor was not a SASRewards object.
+	 */
+	void compile(StatesMap *S, ActionsMap *A, StateTransitions *T, FactoredRewards *R, Horizon *h);
+
+	/**
+	 * Compile single-precision copies of the state transition probabilities and expected rewards,
+	 * for solvers which store their values as floats. They are discarded by the next compile.
+	 */
+	void compile_single_precision();
+
+	/**
+	 * Compile a copy of the expected rewards which interleaves the k rewards of each state-action
+	 * pair, for backups which update all of the reward factors in one pass. It is discarded by the
+	 * next compile.
+	 */
+	void compile_interleaved_rewards();
+
+	/**
+	 * Compile the predecessors of each state from the successors, unless they already are. They are
+	 * discarded by the next compile.
+	 */
+	void compile_predecessors();
+
+	/**
+	 * Convert partitions over states into partitions over state indices.
+	 * @param	P				The partitions over states.
+	 * @param	result			The partitions over state indices. This will be updated.
+	 * @throw	StateException	A state in a partition was not one of the states.
+	 */
+	void convert_partitions(const std::vector<std::vector<State *> > &P,
+			std::vector<std::vector<unsigned int> > &result) const;
+
+	/**
+	 * Convert value functions over state indices into value functions over states.
+	 * @param	values	The value functions, one for each reward, indexed by state index.
+	 * @param	result	The value functions, one for each reward, keyed by state. This will be updated.
+	 */
+	void convert_values(const std::vector<std::vector<double> > &values,
+			std::vector<std::unordered_map<State *, double> > &result) const;
+
+	/**
+	 * Get the number of states.
+	 * @return	The number of states, n.
+	 */
+	unsigned int get_num_states() const;
+
+	/**
+	 * Get the number of actions.
+	 * @return	The number of actions, m.
+	 */
+	unsigned int get_num_actions() const;
+
+	/**
+	 * Get the number of reward factors.
+	 * @return	The number of rewards, k.
+	 */
+	unsigned int get_num_rewards() const;
+
+	/**
+	 * Get the discount factor of the horizon.
+	 * @return	The discount factor.
+	 */
+	double get_discount_factor() const;
+
+	/**
+	 * Get the state with a particular index.
+	 * @param	s	The index of the state.
+	 * @return	The state.
+	 */
+	State *get_state(unsigned int s) const;
+
+	/**
+	 * Get the index of a particular state.
+	 * @param	state			The state.
+	 * @throw	StateException	The state was not one of the compiled states.
+	 * @return	The index of the state.
+	 */
+	unsigned int get_state_index(State *state) const;
+
+	/**
+	 * Get the action with a particular index.
+	 * @param	a	The index of the action.
+	 * @return	The action.
+	 */
+	Action *get_action(unsigned int a) const;
+
+	/**
+	 * Get the index of a particular action.
+	 * @param	action			The action.
+	 * @throw	ActionException	The action was not one of the compiled actions.
+	 * @return	The index of the action.
+	 */
+	unsigned int get_action_index(Action *action) const;
+
+	/**
+	 * Get the row offsets of the successors, an (n * m + 1) array. The successors of
+	 * state-action pair (s, a) are found at [rows[s * m + a], rows[s * m + a + 1]).
+	 * @return	The row offsets.
+	 */
+	const std::vector<unsigned int> &get_rows() const;
+
+	/**
+	 * Get the successor state indices, parallel to the probabilities.
+	 * @return	The successor state indices.
+	 */
+	const std::vector<unsigned int> &get_successors() const;
+
+	/**
+	 * Get the state transition probabilities, parallel to the successors.
+	 * @return	The state transition probabilities.
+	 */
+	const std::vector<double> &get_probabilities() const;
+
+	/**
+	 * Get the expected rewards for a reward factor, an (n * m) array indexed by s * m + a.
+	 * @param	i	The index of the reward factor.
+	 * @return	The expected rewards r_i(s, a) for each state-action pair.
+	 */
+	const std::vector<double> &get_expected_rewards(unsigned int i) const;
+
+	/**
+	 * Get the single-precision state transition probabilities, parallel to the successors. These are
+	 * empty unless compile_single_precision was called.
+	 * @return	The single-precision state transition probabilities.
+	 */
+	const std::vector<float> &get_probabilities_single() const;
+
+	/**
+	 * Get the single-precision expected rewards for a reward factor, indexed by s * m + a. These are
+	 * empty unless compile_single_precision was called.
+	 * @param	i	The index of the reward factor.
+	 * @return	The single-precision expected rewards r_i(s, a) for each state-action pair.
+	 */
+	const std::vector<float> &get_expected_rewards_single(unsigned int i) const;
+
+	/**
+	 * Get the interleaved expected rewards, with the k rewards of state-action pair (s, a) at
+	 * [(s * m + a) * k, (s * m + a + 1) * k). These are empty unless compile_interleaved_rewards
+	 * was called.
+	 * @return	The interleaved expected rewards.
+	 */
+	const std::vector<double> &get_expected_rewards_interleaved() const;
+
+	/**
+	 * Get the row offsets of the predecessors, an (n + 1) array. The predecessors of state s' are
+	 * found at [predecessorRows[s'], predecessorRows[s' + 1]). These are empty unless
+	 * compile_predecessors was called.
+	 * @return	The row offsets of the predecessors.
+	 */
+	const std::vector<unsigned int> &get_predecessor_rows() const;
+
+	/**
+	 * Get the predecessor state indices, i.e., each state s with T(s, a, s') > 0 for some action a.
+	 * Each predecessor appears once for each s'.
+	 * @return	The predecessor state indices.
+	 */
+	const std::vector<unsigned int> &get_predecessors() const;
+
+	/**
+	 * Get the maximal probability max_a T(s, a, s') of each predecessor, parallel to the predecessors.
+	 * @return	The maximal probability of reaching s' from each predecessor s.
+	 */
+	const std::vector<double> &get_predecessor_probabilities() const;
+
+	/**
+	 * Get the minimum reward for a reward factor.
+	 * @param	i	The index of the reward factor.
+	 * @return	The minimum reward.
+	 */
+	double get_min(unsigned int i) const;
+
+	/**
+	 * Get the maximum reward for a reward factor.
+	 * @param	i	The index of the reward factor.
+	 * @return	The maximum reward.
+	 */
+	double get_max(unsigned int i) const;
+
+protected:
+	/**
+	 * The number of states.
+	 */
+	unsigned int n;
+
+	/**
+	 * The number of actions.
+	 */
+	unsigned int m;
+
+	/**
+	 * The number of reward factors.
+	 */
+	unsigned int k;
+
+	/**
+	 * The discount factor.
+	 */
+	double gamma;
+
+	/**
+	 * The states, in index order.
+	 */
+	std::vector<State *> states;
+
+	/**
+	 * A mapping from each state to its index.
+	 */
+	std::unordered_map<State *, unsigned int> stateIndices;
+
+	/**
+	 * The actions, in index order.
+	 */
+	std::vector<Action *> actions;
+
+	/**
+	 * A mapping from each action to its index.
+	 */
+	std::unordered_map<Action *, unsigned int> actionIndices;
+
+	/**
+	 * The row offsets of the successors for each state-action pair.
+	 */
+	std::vector<unsigned int> rows;
+
+	/**
+	 * The successor state indices.
+	 */
+	std::vector<unsigned int> successors;
+
+	/**
+	 * The state transition probabilities, parallel to the successors.
+	 */
+	std::vector<double> probabilities;
+
+	/**
+	 * The expected rewards, one (n * m) array for each reward factor.
+	 */
+	std::vector<std::vector<double> > expectedRewards;
+
+	/**
+	 * The single-precision state transition probabilities, parallel to the successors.
+	 */
+	std::vector<float> probabilitiesSingle;
+
+	/**
+	 * The single-precision expected rewards, one (n * m) array for each reward factor.
+	 */
+	std::vector<std::vector<float> > expectedRewardsSingle;
+
+	/**
+	 * The expected rewards of all reward factors, interleaved for each state-action pair.
+	 */
+	std::vector<double> expectedRewardsInterleaved;
+
+	/**
+	 * The row offsets of the predecessors for each state.
+	 */
+	std::vector<unsigned int> predecessorRows;
+
+	/**
+	 * The predecessor state indices.
+	 */
+	std::vector<unsigned int> predecessors;
+
+	/**
+	 * The maximal probability of reaching each state from each of its predecessors.
+	 */
+	std::vector<double> predecessorProbabilities;
+
+	/**
+	 * The minimum reward of each reward factor.
+	 */
+	std::vector<double> Rmin;
+
+	/**
+	 * The maximum reward of each reward factor.
+	 */
+	std::vector<double> Rmax;
+
+};
+
+
+#endif // COMPILED_LMDP_H
@@ -81,7 +81,8 @@ public:
 	std::vector<float> &get_slack();
 
 	/**
-	 * Set the partitions.
+	 * Set the partitions. Every state must be in one of them; the solvers reject models with a state
+	 * in none, since it would have no ordering.
 	 * @param	P	The new partitions.
 	 */
 	void set_partitions(const std::vector<std::vector<State *> > &P);
@@ -0,0 +1,177 @@
+/**
+ *  The MIT License (MIT)
+ *
+ *  Copyright (c) 2014 Kyle Wray, University of Massachusetts
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy of
+ *  this software and associated documentation files (the "Software"), to deal in
+ *  the Software without restriction, including without limitation the rights to
+ *  use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ *  the Software, and to permit persons to whom the Software is furnished to do so,
+ *  subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ *  FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ *  COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ *  IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ *  CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+#ifndef LPI_H
+#define LPI_H
+
+
+#include "lvi.h"
+#include "policy_evaluator.h"
+
+/**
+ * Solve a Lexicographic Markov Decision Process (LMDP) with lexicographic (modified) policy
+ * iteration. For each reward, in the order of the partition, a policy restricted to the actions
+ * within slack of the previous rewards is alternately evaluated and greedily improved. Policy
+ * evaluation either solves the policy's linear system over the partition, with the values of the
+ * other partitions fixed, or applies a fixed number of sweeps (modified policy iteration). The
+ * slack pruning between rewards is the same as in LVI.
+ */
+class LPI : public LVI {
+public:
+	/**
+	 * The default constructor for the LPI class. The default tolerance is 0.001 and
+	 * policy evaluation is exact.
+	 */
+	LPI();
+
+	/**
+	 * A constructor for the LPI class which allows for the specification of the convergence
+	 * criterion (tolerance) and the number of policy evaluation sweeps.
+	 * @param	tolerance			The tolerance which determines convergence of policy iteration.
+	 * @param	evaluationSteps		The number of policy evaluation sweeps per improvement, or 0 for
+	 * 								exact policy evaluation.
+	 */
+	LPI(double tolerance, unsigned int evaluationSteps);
+
+	/**
+	 * The deconstructor for the LPI class.
+	 */
+	virtual ~LPI();
+
+	/**
+	 * Set the number of policy evaluation sweeps per improvement. With 0, policy evaluation is exact:
+	 * the policy's linear system over the partition is solved with preconditioned BiCGSTAB to a
+	 * residual of (1 - gamma) times the convergence criterion, so that the values are within the
+	 * convergence criterion of the policy's. If BiCGSTAB does not converge, sweeps finish it.
+	 * @param	evaluationSteps		The number of sweeps, or 0 for exact policy evaluation.
+	 */
+	void set_evaluation_steps(unsigned int evaluationSteps);
+
+	/**
+	 * Get the number of policy evaluation sweeps per improvement.
+	 * @return	The number of sweeps, or 0 if policy evaluation is exact.
+	 */
+	unsigned int get_evaluation_steps() const;
+
+	/**
+	 * Get the number of Krylov iterations of exact policy evaluation over all rewards and partitions
+	 * by the last call to solve. These are not counted as sweeps.
+	 * @return	The number of Krylov iterations.
+	 */
+	unsigned long long get_num_evaluation_iterations() const;
+
+	/**
+	 * Get the number of policy improvement steps taken over all rewards and partitions
+	 * by the last call to solve.
+	 * @return	The number of policy improvement steps.
+	 */
+	unsigned int get_num_improvements() const;
+
+protected:
+	/**
+	 * Solve an infinite horizon LMDP using lexicographic policy iteration.
+	 * @param	S					The finite states.
+	 * @param	A					The finite actions.
+	 * @param	T					The finite state transition function.
+	 * @param	R					The factored state-action-state rewards.
+	 * @param	h					The horizon.
+	 * @param	delta				The slack vector.
+	 * @param	P					The vector of partitions.
+	 * @param	o					The vector of orderings.
+	 * @throw	PolicyException		An error occurred computing the policy.
+	 * @return	Return the optimal policy.
+	 */
+	virtual PolicyMap *solve_infinite_horizon(StatesMap *S, ActionsMap *A,
+			StateTransitions *T, FactoredRewards *R, Horizon *h,
+			std::vector<float> &delta,
+			std::vector<std::vector<State *> > &P,
+			std::vector<std::vector<unsigned int> > &o);
+
+	/**
+	 * Solve the infinite horizon MDP for a particular partition of the state space using
+	 * policy iteration for each reward.
+	 * @param	delta				The slack vector.
+	 * @param	Pj					The z-partition over state indices.
+	 * @param	oj					The z-array of orderings over each of the k rewards.
+	 * @param	VFixed				The fixed set of value functions from the previous outer step.
+	 * @param	values				The resultant value of the states. This is updated.
+	 * @param	pi					The index of the action of each state. This is updated for the partition.
+	 * @param	maxDifference		The maximal difference for convergence checking. This is updated.
+	 * @param	threads				The pool of threads which splits each sweep.
+	 * @throw	PolicyException		An error occurred computing the policy.
+	 */
+	virtual void compute_partition(std::vector<float> &delta,
+			std::vector<unsigned int> &Pj, std::vector<unsigned int> &oj,
+			std::vector<std::vector<double> > &VFixed,
+			std::vector<std::vector<double> > &values,
+			std::vector<unsigned int> &pi, std::vector<double> &maxDifference,
+			ThreadPool *threads);
+
+	/**
+	 * Interval bounds are never maintained, since policy iteration does not sweep the upper bounds.
+	 * @return	Always false.
+	 */
+	virtual bool is_interval() const;
+
+	/**
+	 * Perform one policy evaluation sweep of the states in a partition, following a fixed policy.
+	 * Sweeps are Jacobi or Gauss-Seidel, in the visit order, as with compute_sweep.
+	 * @param	i			The reward index.
+	 * @param	Pj			The z-partition over state indices.
+	 * @param	pij			The action of the policy for each state, indexed by position in the partition.
+	 * @param	Vi			The i-th value function. This will be updated.
+	 * @param	ViNext		The scratch values, indexed by position in the partition. This will be updated.
+	 * @param	threads		The pool of threads which splits the sweep.
+	 * @param	sweep		The number of sweeps so far, which decides the direction of alternating sweeps.
+	 * @return	The maximal difference between the values before and after the sweep.
+	 */
+	double compute_evaluation_sweep(unsigned int i, const std::vector<unsigned int> &Pj,
+			const std::vector<unsigned int> &pij, std::vector<double> &Vi,
+			std::vector<double> &ViNext, ThreadPool *threads, unsigned int sweep);
+
+	/**
+	 * The number of policy evaluation sweeps per improvement, or 0 for exact policy evaluation.
+	 */
+	unsigned int evaluationSteps;
+
+	/**
+	 * The evaluators of exact policy evaluation, one for each partition of the current solve, so
+	 * that the partitions may be solved concurrently.
+	 */
+	std::vector<PolicyEvaluator *> evaluators;
+
+	/**
+	 * The number of Krylov iterations of exact policy evaluation by the last call to solve.
+	 */
+	unsigned long long evaluationIterations;
+
+	/**
+	 * The number of policy improvement steps taken by the last call to solve.
+	 */
+	unsigned int improvements;
+
+};
+
+
+#endif // LPI_H
@@ -27,6 +27,13 @@
 
 
 #include "lmdp.h"
+#include "compiled_lmdp.h"
+#include "thread_pool.h"
+#include "action_sets.h"
+#include "lvi_telemetry.h"
+#include "bellman_kernels.h"
+#include "lvi_workspace.h"
+#include "time_indexed_policy.h"
 
 #include "../../librbr/librbr/include/core/policy/policy_map.h"
 
@@ -39,6 +46,92 @@
 #include "../../librbr/librbr/include/core/horizon.h"
 
 #include <unordered_map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <atomic>
+#include <chrono>
+
+/**
+ * The largest number of sweeps which evaluate an initial policy for each reward, when no initial
+ * values are given.
+ */
+#define LVI_MAX_INITIAL_SWEEPS 1000
+
+/**
+ * The order in which the states of a partition are visited by a Gauss-Seidel sweep.
+ */
+enum LVIVisitOrder {
+	LVI_VISIT_FORWARD,
+	LVI_VISIT_BACKWARD,
+	LVI_VISIT_ALTERNATING
+};
+
+/**
+ * The error of solving with single-precision values, probabilities, and rewards instead of
+ * double-precision ones.
+ */
+struct LVIPrecisionReport {
+	/**
+	 * The maximal absolute difference between the values, one for each reward.
+	 */
+	std::vector<double> maxError;
+
+	/**
+	 * The mean absolute difference between the values, one for each reward.
+	 */
+	std::vector<double> meanError;
+
+	/**
+	 * The number of states whose actions differ between the two policies.
+	 */
+	unsigned int policyDifferences;
+};
+
+/**
+ * The sweeps saved by Anderson acceleration, from solving once with and once without it.
+ */
+struct LVIAccelerationReport {
+	/**
+	 * The number of sweeps without acceleration, one for each reward.
+	 */
+	std::vector<unsigned int> plainSweeps;
+
+	/**
+	 * The number of sweeps with acceleration, one for each reward.
+	 */
+	std::vector<unsigned int> acceleratedSweeps;
+
+	/**
+	 * The number of outer iterations without acceleration.
+	 */
+	unsigned int plainIterations;
+
+	/**
+	 * The number of outer iterations with acceleration.
+	 */
+	unsigned int acceleratedIterations;
+
+	/**
+	 * The number of extrapolated sweeps which were kept.
+	 */
+	unsigned long long accepted;
+
+	/**
+	 * The number of extrapolated sweeps which were undone, since their residual grew.
+	 */
+	unsigned long long rejected;
+
+	/**
+	 * The maximal absolute difference between the values, one for each reward.
+	 */
+	std::vector<double> maxDifference;
+
+	/**
+	 * The number of states whose actions differ between the two policies.
+	 */
+	unsigned int policyDifferences;
+};
 
 /**
  * Solve a Lexicographic Markov Decision Process (LMDP).
@@ -71,18 +164,560 @@ public:
 	 * @throw	StateTransitionsException	The LMDP did not have a StateTransitions state transitions object.
 	 * @throw	RewardException				The LMDP did not have a FactoredRewards (elements SASRewards) rewards object.
 	 * @throw	CoreException				The LMDP was not infinite horizon.
-	 * @throw	PolicyException				An error occurred computing the policy.
+	 * @throw	PolicyException				A state was not in any partition, or an error occurred computing
+	 * 										the policy.
 	 * @return	Return the optimal policy.
 	 */
 	PolicyMap *solve(LMDP *lmdp);
 
+	/**
+	 * Solve the finite horizon LMDP provided using lexicographic backward induction. Each step keeps,
+	 * for each reward in each state's ordering, the actions within a per-step slack of the best, where
+	 * the slack delta_i is spread over the horizon as delta_i / sum_{t=0}^{H-1} gamma^t. Only the values
+	 * of the current and next steps are kept, so the memory is O(k n) regardless of the horizon. Afterwards,
+	 * get_V returns the values at step 0.
+	 * @param	lmdp						The LMDP to solve.
+	 * @throw	StateException				The LMDP did not have a StatesMap states object.
+	 * @throw	ActionException				The LMDP did not have a ActionsMap actions object.
+	 * @throw	StateTransitionsException	The LMDP did not have a StateTransitions state transitions object.
+	 * @throw	RewardException				The LMDP did not have a FactoredRewards (elements SASRewards) rewards object.
+	 * @throw	CoreException				The LMDP was not finite horizon.
+	 * @throw	PolicyException				A state was not in any partition.
+	 * @return	Return the policy, indexed by step. The caller must delete it.
+	 */
+	TimeIndexedPolicy *solve_finite(LMDP *lmdp);
+
+	/**
+	 * Solve the LMDP provided for each of a list of slack vectors, in one batch. The LMDP is only
+	 * compiled once, and each slack vector starts from the values of the one before it, so the list
+	 * should be sorted such that neighbouring slack vectors are close. The iteration counts are those
+	 * of the last slack vector. The LMDP's own slack is ignored.
+	 * @param	lmdp						The LMDP to solve.
+	 * @param	slacks						The slack vectors.
+	 * @param	sweepV						The values of the states for each slack vector, one for each
+	 * 										reward. This will be updated.
+	 * @throw	StateException				The LMDP did not have a StatesMap states object.
+	 * @throw	ActionException				The LMDP did not have a ActionsMap actions object.
+	 * @throw	StateTransitionsException	The LMDP did not have a StateTransitions state transitions object.
+	 * @throw	RewardException				The LMDP did not have a FactoredRewards (elements SASRewards) rewards
+	 * 										object, or a slack vector was invalid.
+	 * @throw	CoreException				The LMDP was not infinite horizon.
+	 * @throw	PolicyException				A state was not in any partition, or an error occurred computing
+	 * 										the policy.
+	 * @return	Return the optimal policy for each slack vector. The caller must delete them.
+	 */
+	std::vector<PolicyMap *> solve_slack_sweep(LMDP *lmdp,
+			const std::vector<std::vector<float> > &slacks,
+			std::vector<std::vector<std::unordered_map<State *, double> > > &sweepV);
+
 	/**
 	 * Get the values of the states.
 	 * @return	The values of all the states.
 	 */
 	std::vector<std::unordered_map<State *, double> > &get_V();
 
+	/**
+	 * Get the index of the action of each state from the last solve, in the order of the compiled states
+	 * and actions, for callers which do not need a PolicyMap. A state in no partition has no action, and
+	 * holds the number of actions instead.
+	 * @return	The index of the action of each state.
+	 */
+	const std::vector<unsigned int> &get_policy_actions() const;
+
+	/**
+	 * Set the number of threads used by each sweep over the states of a partition. Each sweep
+	 * is a Jacobi update, so the result is identical for any number of threads. The default is 1.
+	 * @param	numThreads		The number of threads, at least 1.
+	 */
+	void set_num_threads(unsigned int numThreads);
+
+	/**
+	 * Get the number of threads used by each sweep over the states of a partition.
+	 * @return	The number of threads.
+	 */
+	unsigned int get_num_threads() const;
+
+	/**
+	 * Set if the partitions should be solved concurrently within each outer iteration. Each
+	 * partition only reads the fixed values of the previous outer iteration, so the result is
+	 * identical either way. The threads are shared evenly among the partitions. The default is false.
+	 * @param	concurrent	If the partitions should be solved concurrently.
+	 */
+	void set_concurrent_partitions(bool concurrent);
+
+	/**
+	 * Get if the partitions are solved concurrently within each outer iteration.
+	 * @return	If the partitions are solved concurrently.
+	 */
+	bool get_concurrent_partitions() const;
+
+	/**
+	 * Set if each sweep should update the values in place (Gauss-Seidel), instead of from the
+	 * values of the previous sweep (Jacobi), optionally with over-relaxation. Gauss-Seidel sweeps
+	 * are sequential, so they do not use the threads. The default is Jacobi.
+	 * @param	enable	If Gauss-Seidel sweeps should be used.
+	 * @param	omega	The relaxation factor in (0, 2); 1.0 is plain Gauss-Seidel. The default is 1.0.
+	 */
+	void set_gauss_seidel(bool enable, double omega = 1.0);
+
+	/**
+	 * Get if Gauss-Seidel sweeps are used.
+	 * @return	If Gauss-Seidel sweeps are used.
+	 */
+	bool get_gauss_seidel() const;
+
+	/**
+	 * Get the relaxation factor of Gauss-Seidel sweeps.
+	 * @return	The relaxation factor.
+	 */
+	double get_relaxation() const;
+
+	/**
+	 * Set the order in which Gauss-Seidel sweeps visit the states of a partition. The default
+	 * is the order of the states in the partition.
+	 * @param	order	The visit order.
+	 */
+	void set_visit_order(LVIVisitOrder order);
+
+	/**
+	 * Get the order in which Gauss-Seidel sweeps visit the states of a partition.
+	 * @return	The visit order.
+	 */
+	LVIVisitOrder get_visit_order() const;
+
+	/**
+	 * Set if the slack pruning after each reward's final sweep uses the Q-values from that sweep,
+	 * fusing the final backup and the pruning into one pass. These Q-values were computed from the
+	 * values before the final sweep, which are within the convergence criterion of the final ones.
+	 * Otherwise (the default), they are reused only if the final sweep left the values unchanged,
+	 * and recomputed from the final values if not.
+	 * @param	enable	If the pruning is fused with the final sweep.
+	 */
+	void set_fused_pruning(bool enable);
+
+	/**
+	 * Get if the slack pruning is fused with each reward's final sweep.
+	 * @return	If the pruning is fused with the final sweep.
+	 */
+	bool get_fused_pruning() const;
+
+	/**
+	 * Set if the rewards whose actions are already fixed are backed up together. Once every state of a
+	 * partition is left with a single action, the remaining rewards only evaluate that policy, so each
+	 * sweep walks the successors of each state once for all of them. Their sweeps then continue until
+	 * all of them have converged. This is ignored with single precision. The default is off.
+	 * @param	enable	If the rewards with fixed actions are backed up together.
+	 */
+	void set_fused_backups(bool enable);
+
+	/**
+	 * Get if the rewards whose actions are already fixed are backed up together.
+	 * @return	If the rewards with fixed actions are backed up together.
+	 */
+	bool get_fused_backups() const;
+
+	/**
+	 * Set if the final policy is evaluated for all rewards once the outer iterations are done, so that
+	 * get_V provides the values of the policy returned rather than those of the last iteration. All
+	 * rewards are backed up together, as with set_fused_backups. The default is off.
+	 * @param	enable	If the final policy is evaluated.
+	 */
+	void set_policy_evaluation(bool enable);
+
+	/**
+	 * Get if the final policy is evaluated for all rewards once the outer iterations are done.
+	 * @return	If the final policy is evaluated.
+	 */
+	bool get_policy_evaluation() const;
+
+	/**
+	 * Set if actions which provably cannot be within slack of the best action are eliminated during
+	 * the sweeps of each reward. After each sweep, every Q_i(s, a) is within an error of Q_i^*(s, a)
+	 * which follows from the residuals, and an action whose upper bound is more than the slack eta_i
+	 * below the best action's lower bound is removed for the rest of that reward. This is ignored
+	 * while Gauss-Seidel sweeps are over-relaxed.
+	 * @param	enable	If actions are eliminated.
+	 */
+	void set_action_elimination(bool enable);
+
+	/**
+	 * Get if actions are eliminated during the sweeps of each reward.
+	 * @return	If actions are eliminated.
+	 */
+	bool get_action_elimination() const;
+
+	/**
+	 * Get the total number of actions eliminated during the last solve.
+	 * @return	The number of actions eliminated.
+	 */
+	unsigned long long get_num_eliminated() const;
+
+	/**
+	 * Set if the solves maintain lower and upper bounds on the values of each reward, seeded from
+	 * R_i^min / (1 - gamma) and R_i^max / (1 - gamma). Both bounds are swept over the same actions, so
+	 * they bracket V_i^* over the actions left by the slack, and the slack keeps each action whose
+	 * upper bound is within eta_i of the best lower bound. The sweeps of each reward and the outer
+	 * iterations stop as soon as the gap between the bounds at the target states is within epsilon,
+	 * and the values are then the lower bounds. The gap of one partition may rest on the bounds of
+	 * others, so it can stop shrinking before it closes; the outer iterations then also stop once
+	 * every partition meets the usual convergence criterion and the gap did not shrink over the last
+	 * outer iteration, and get_interval_closed tells which of the two ended the solve. The solvers
+	 * derived from LVI, which do not maintain the bounds, ignore this. While the bounds are maintained, actions are not eliminated and the rewards with fixed actions
+	 * are not backed up together. The bounds of a reward only hold for the actions they were swept
+	 * over, so whenever the slack of the previous rewards changes the actions of a partition, its
+	 * bounds of that reward are seeded again. They are sound for a single partition; with several,
+	 * the bounds of one partition rest on those of its neighbors, which are only sound once their
+	 * actions stop changing. This is ignored with single precision, while Gauss-Seidel sweeps are
+	 * over-relaxed, or without discounting, i.e., gamma >= 1, where the seeds are unbounded. The
+	 * default is off.
+	 * @param	enable	If the bounds are maintained.
+	 * @param	targets	The states whose gap must close, e.g., the initial state. By default, all of the
+	 * 					states in the partitions.
+	 */
+	void set_interval_bounds(bool enable, const std::vector<State *> &targets = std::vector<State *>());
+
+	/**
+	 * Get if the solves maintain lower and upper bounds on the values of each reward.
+	 * @return	If the bounds are maintained.
+	 */
+	bool get_interval_bounds() const;
+
+	/**
+	 * Get the lower bounds on the values of the states from the last solve with interval bounds.
+	 * @return	The lower bounds of all the states, one for each reward.
+	 */
+	std::vector<std::unordered_map<State *, double> > &get_V_lower();
+
+	/**
+	 * Get the upper bounds on the values of the states from the last solve with interval bounds.
+	 * @return	The upper bounds of all the states, one for each reward.
+	 */
+	std::vector<std::unordered_map<State *, double> > &get_V_upper();
+
+	/**
+	 * Get the largest gap between the upper and lower bounds at the target states over all rewards,
+	 * after the last solve with interval bounds.
+	 * @return	The largest gap at the target states.
+	 */
+	double get_interval_gap() const;
+
+	/**
+	 * Get if the gap at the target states closed to within epsilon in the last solve with interval
+	 * bounds, rather than the solve stopping once the gap no longer shrank.
+	 * @return	True if the gap closed, and false otherwise.
+	 */
+	bool get_interval_closed() const;
+
+	/**
+	 * Set the memory depth of Anderson acceleration of the sweeps of each reward. After each sweep, the
+	 * values which the next sweep starts from are extrapolated from the residuals of the last depth
+	 * sweeps, over the same set of actions. The memory is kept between outer iterations until the
+	 * actions, the values of the partition, or the values outside it which its sweeps read change, so
+	 * this also accelerates the single sweep of each outer iteration without the looping version when
+	 * the other partitions are settled. If the residual of the sweep from an extrapolation grows, it is
+	 * undone, the plain sweep before it is swept again, and the memory restarts. The sweeps still stop
+	 * on the residual of a sweep, and the values, actions, and Q-values they end with are those of a
+	 * plain sweep, so the convergence criterion and the slack keep their meaning. This is ignored with single precision or interval bounds, and only applies to the
+	 * sweeps of LVI itself. The default is 0, i.e., no acceleration.
+	 * @param	depth	The number of previous sweeps used by each extrapolation, or 0 for none.
+	 */
+	void set_anderson_depth(unsigned int depth);
+
+	/**
+	 * Get the memory depth of Anderson acceleration of the sweeps of each reward.
+	 * @return	The memory depth, or 0 if the sweeps are not accelerated.
+	 */
+	unsigned int get_anderson_depth() const;
+
+	/**
+	 * Get the number of extrapolated sweeps which were kept during the last solve.
+	 * @return	The number of extrapolations kept.
+	 */
+	unsigned long long get_num_anderson_accepted() const;
+
+	/**
+	 * Get the number of extrapolated sweeps which were undone during the last solve.
+	 * @return	The number of extrapolations undone.
+	 */
+	unsigned long long get_num_anderson_rejected() const;
+
+	/**
+	 * Set the instruction set of the Bellman backup kernel. By default, the scalar kernel is used, so
+	 * that the results do not depend on the processor; e.g., bellman_detect_isa() selects the most
+	 * capable one it supports. Instruction sets which the processor does not support fall back to the
+	 * most capable one it does; see bellman_kernels.h for the tolerance of each kernel with respect to
+	 * the scalar one. Within that tolerance, the slack may keep a different action of a near-tie, so
+	 * the policy may change.
+	 * @param	isa		The instruction set.
+	 */
+	void set_bellman_isa(BellmanISA isa);
+
+	/**
+	 * Get the instruction set of the Bellman backup kernel.
+	 * @return	The instruction set.
+	 */
+	BellmanISA get_bellman_isa() const;
+
+	/**
+	 * Set if the sweeps store the values, probabilities, and rewards as floats, which halves the bytes
+	 * read by each backup. Each backup still accumulates in double, and the values are widened back to
+	 * double once each reward's sweeps are done. This only applies to the sweeps of LVI itself, not to
+	 * those of the solvers derived from it. The default is double precision.
+	 * @param	enable	If the sweeps use single precision.
+	 */
+	void set_single_precision(bool enable);
+
+	/**
+	 * Get if the sweeps store the values, probabilities, and rewards as floats.
+	 * @return	If the sweeps use single precision.
+	 */
+	bool get_single_precision() const;
+
+	/**
+	 * Solve the LMDP provided with both double and single precision, and report the error of the latter.
+	 * Afterwards, the values are those of the single-precision solve, and the precision is restored.
+	 * @param	lmdp						The LMDP to solve.
+	 * @throw	StateException				The LMDP did not have a StatesMap states object.
+	 * @throw	ActionException				The LMDP did not have a ActionsMap actions object.
+	 * @throw	StateTransitionsException	The LMDP did not have a StateTransitions state transitions object.
+	 * @throw	RewardException				The LMDP did not have a FactoredRewards (elements SASRewards) rewards object.
+	 * @throw	CoreException				The LMDP was not infinite horizon.
+	 * @throw	PolicyException				An error occurred computing the policy.
+	 * @return	The error of the single-precision values and policy with respect to the double-precision ones.
+	 */
+	LVIPrecisionReport compare_precision(LMDP *lmdp);
+
+	/**
+	 * Solve the LMDP provided without and with Anderson acceleration, and report the sweeps it saved.
+	 * Afterwards, the values are those of the accelerated solve, or of the plain one if it throws.
+	 * @param	lmdp						The LMDP to solve.
+	 * @throw	StateException				The LMDP did not have a StatesMap states object.
+	 * @throw	ActionException				The LMDP did not have a ActionsMap actions object.
+	 * @throw	StateTransitionsException	The LMDP did not have a StateTransitions state transitions object.
+	 * @throw	RewardException				The LMDP did not have a FactoredRewards (elements SASRewards) rewards object.
+	 * @throw	CoreException				The LMDP was not infinite horizon.
+	 * @throw	PolicyException				An error occurred computing the policy.
+	 * @return	The sweeps of both solves, and the difference of the accelerated values and policy.
+	 */
+	LVIAccelerationReport compare_acceleration(LMDP *lmdp);
+
+	/**
+	 * Get the workspace whose buffers are reused by the outer iterations of each solve, e.g., to check
+	 * its number of buffer growths.
+	 * @return	The workspace.
+	 */
+	const LVIWorkspace &get_workspace() const;
+
+	/**
+	 * Get the number of outer iterations of the last solve.
+	 * @return	The number of outer iterations.
+	 */
+	unsigned int get_num_iterations() const;
+
+	/**
+	 * Get the total number of sweeps of the last solve, summed over all outer iterations and
+	 * partitions, for each reward.
+	 * @return	The number of sweeps, one for each reward.
+	 */
+	const std::vector<unsigned int> &get_num_sweeps() const;
+
+	/**
+	 * Get the total number of state backups of the last solve, i.e., the number of times
+	 * max_a Q_i(s, a) was computed for some state and reward.
+	 * @return	The number of backups.
+	 */
+	unsigned long long get_num_backups() const;
+
+	/**
+	 * Ask a running solve, e.g., on another thread, to stop. It stops at the end of the current sweep
+	 * of each reward in each partition, so that every state still has an action, and returns the best
+	 * policy found so far. Later solves stop the same way, until clear_stop is called.
+	 */
+	void request_stop();
+
+	/**
+	 * Clear a request to stop, so that the next solves run until they converge.
+	 */
+	void clear_stop();
+
+	/**
+	 * Set a wall-clock deadline for the next solves, which then stop as with request_stop once it
+	 * has passed.
+	 * @param	deadline	The deadline.
+	 */
+	void set_deadline(std::chrono::steady_clock::time_point deadline);
+
+	/**
+	 * Clear the deadline, so that the next solves run until they converge.
+	 */
+	void clear_deadline();
+
+	/**
+	 * Get the largest residual over all rewards and partitions of the latest outer iteration. This
+	 * may be called from another thread while solving.
+	 * @return	The latest residual, or the largest double if no outer iteration has completed.
+	 */
+	double get_residual() const;
+
+	/**
+	 * Get a bound on the error of the values from the latest residual, r gamma / (1 - gamma). For
+	 * rewards after the first, this holds for their values over the actions left by the slack.
+	 * This may be called from another thread while solving.
+	 * @return	The bound on the error of the values.
+	 */
+	double get_error_bound() const;
+
+	/**
+	 * Get if the last solve converged, or was stopped early.
+	 * @return	True if the last solve converged, false if it was stopped.
+	 */
+	bool get_converged() const;
+
+	/**
+	 * Set the telemetry which receives the convergence of each outer iteration of the next solves.
+	 * The telemetry is not owned by LVI. By default, no telemetry is gathered.
+	 * @param	sink	The telemetry, or nullptr for none.
+	 */
+	void set_telemetry(LVITelemetry *sink);
+
+	/**
+	 * Get the telemetry which receives the convergence of each outer iteration.
+	 * @return	The telemetry.
+	 */
+	LVITelemetry *get_telemetry() const;
+
+	/**
+	 * Set the values from which the next solves start, instead of 0. States are found by their hash
+	 * value, so the values may come from a different, but similar, LMDP, and then matched if they are
+	 * the same state or read the same, i.e., have the same to_string. States whose hash value is
+	 * shared with another, either here or in the LMDP solved, are never matched. States without an
+	 * initial value start at 0.
+	 * @param	initialValues	The initial values of the states, one for each reward.
+	 */
+	void set_initial_values(const std::vector<std::unordered_map<State *, double> > &initialValues);
+
+	/**
+	 * Set the policy from which the next solves start. States are matched as with the initial values,
+	 * and actions by their hash value, unless several actions share it. If no initial values are set,
+	 * the values start at those of this policy, evaluated for each reward by at most
+	 * LVI_MAX_INITIAL_SWEEPS sweeps, which also end once the solve is asked to stop.
+	 * @param	S				The states over which the policy is defined.
+	 * @param	initialPolicy	The initial policy.
+	 */
+	void set_initial_policy(StatesMap *S, PolicyMap *initialPolicy);
+
+	/**
+	 * Clear the initial values and policy, so that the next solves start from 0.
+	 */
+	void clear_initial_solution();
+
+	/**
+	 * Save the values of the last solve, and a policy for the same states, so that a later run may
+	 * start from them with load_solution. Each line holds a state's hash value, its action's hash
+	 * value, and its values for each reward, separated by commas.
+	 * @param	filename	The name of the file to save.
+	 * @param	policy		The policy returned by the last solve.
+	 * @return	Returns true if an error arose, and false otherwise.
+	 */
+	bool save_solution(std::string filename, PolicyMap *policy) const;
+
+	/**
+	 * Load values and a policy saved by save_solution as the initial values and policy of the
+	 * next solves. The file only holds hash values, so the states are matched by their hash value
+	 * alone, except those whose hash value is on several lines or shared by several states of the
+	 * LMDP solved, which are never matched.
+	 * @param	filename	The name of the file to load.
+	 * @return	Returns true if an error arose, and false otherwise.
+	 */
+	bool load_solution(std::string filename);
+
 protected:
+	/**
+	 * Check the LMDP provided, and compile it into its flat form.
+	 * @param	lmdp						The LMDP to compile.
+	 * @param	S							The finite states. This will be updated.
+	 * @param	A							The finite actions. This will be updated.
+	 * @param	T							The finite state transition function. This will be updated.
+	 * @param	R							The factored state-action-state rewards. This will be updated.
+	 * @param	h							The horizon. This will be updated.
+	 * @throw	StateException				The LMDP did not have a StatesMap states object.
+	 * @throw	ActionException				The LMDP did not have a ActionsMap actions object.
+	 * @throw	RewardException				The LMDP did not have a FactoredRewards (elements SASRewards) rewards object.
+	 */
+	void compile_model(LMDP *lmdp, StatesMap *&S, ActionsMap *&A, StateTransitions *&T,
+			FactoredRewards *&R, Horizon *&h);
+
+	/**
+	 * Check that a slack vector has one non-negative slack for each reward of the compiled model.
+	 * @param	delta				The slack vector.
+	 * @throw	RewardException		The slack vector was invalid.
+	 */
+	void check_slack(const std::vector<float> &delta) const;
+
+	/**
+	 * Check that every state of the compiled model is in a partition, since a state in none would
+	 * have no ordering, and so no action or values.
+	 * @param	P					The vector of partitions.
+	 * @throw	StateException		A state in a partition was not one of the states.
+	 * @throw	PolicyException		A state was not in any partition.
+	 */
+	void check_partitions(const std::vector<std::vector<State *> > &P) const;
+
+	/**
+	 * Check if the solve should stop, because it was asked to or the deadline passed.
+	 * @return	True if the solve should stop, false otherwise.
+	 */
+	bool should_stop() const;
+
+	/**
+	 * Record the largest residual of an outer iteration as the progress of the solve.
+	 * @param	difference	The residual of each reward within each partition.
+	 */
+	void record_residual(const std::vector<std::vector<double> > &difference);
+
+	/**
+	 * Prepare the telemetry of a solve.
+	 * @param	PIndices	The partitions over state indices of the solve.
+	 */
+	void start_telemetry(const std::vector<std::vector<unsigned int> > &PIndices);
+
+	/**
+	 * Remember the sweeps and the sets of actions of a reward within a partition for the telemetry of
+	 * the current outer iteration, if it is enabled. The caller must hold the partitionsMutex.
+	 * @param	Pj		The partition over state indices.
+	 * @param	i		The index of the reward.
+	 * @param	sweep	The number of sweeps of the reward over the partition.
+	 * @param	sets	The interned sets of actions.
+	 * @param	Ai		The set of actions for each state in the partition.
+	 */
+	void record_level(const std::vector<unsigned int> &Pj, unsigned int i, unsigned int sweep,
+			const ActionSets &sets, const std::vector<unsigned int> &Ai);
+
+	/**
+	 * Send the records of an outer iteration to the telemetry, if it is enabled.
+	 * @param	iteration				The outer iteration, starting at 1.
+	 * @param	difference				The residual of each reward within each partition.
+	 * @param	o						The vector of orderings.
+	 * @param	convergenceCriterion	The convergence criterion.
+	 * @param	time					The wall time since the start of the solve, in seconds.
+	 */
+	void record_iteration(unsigned int iteration, const std::vector<std::vector<double> > &difference,
+			const std::vector<std::vector<unsigned int> > &o, double convergenceCriterion, double time);
+
+	/**
+	 * Initialize the values and the policy of a solve from the initial values and policy, if any. This
+	 * requires the model to be compiled.
+	 * @param	pi		The index of the action of each state. This will be updated.
+	 */
+	void initialize_solution(std::vector<unsigned int> &pi);
+
+	/**
+	 * Create the policy of the last solve from the index of the action of each state.
+	 * @param	h		The horizon.
+	 * @return	The policy, with an action for each state in a partition.
+	 */
+	PolicyMap *create_policy(Horizon *h) const;
+
 	/**
 	 * Solve an infinite horizon LMDP using value iteration.
 	 * @param	S					The finite states.
@@ -103,95 +738,323 @@ protected:
 			std::vector<std::vector<unsigned int> > &o);
 
 	/**
-	 * Solve the infinite horizon MDP for a particular partition of the state space.
-	 * @param	S					The finite states.
-	 * @param	A					The finite actions.
-	 * @param	T					The finite state transition function.
-	 * @param	R					The factored state-action-state rewards.
+	 * Solve a finite horizon LMDP using lexicographic backward induction, with the states of each
+	 * step split over the threads. Each step counts as one sweep of every reward, and is reported
+	 * to the telemetry as an outer iteration.
 	 * @param	h					The horizon.
 	 * @param	delta				The slack vector.
-	 * @param	Pj					The z-partition over states.
+	 * @param	P					The vector of partitions.
+	 * @param	o					The vector of orderings, one for each partition. Every state must be
+	 * 								in a partition, as check_partitions ensures.
+	 * @return	Return the policy, indexed by step.
+	 */
+	TimeIndexedPolicy *solve_finite_horizon(Horizon *h, std::vector<float> &delta,
+			std::vector<std::vector<State *> > &P,
+			std::vector<std::vector<unsigned int> > &o);
+
+	/**
+	 * Solve the infinite horizon MDP for a particular partition of the state space.
+	 * @param	delta				The slack vector.
+	 * @param	Pj					The z-partition over state indices.
 	 * @param	oj					The z-array of orderings over each of the k rewards.
 	 * @param	VFixed				The fixed set of value functions from the previous outer step.
-	 * @param	V					The resultant value of the states. This is updated.
-	 * @param	policy				The policy for the states in the partition. This is updated.
+	 * @param	values				The resultant value of the states. This is updated.
+	 * @param	pi					The index of the action of each state. This is updated for the partition.
 	 * @param	maxDifference		The maximal difference for convergence checking. This is updated.
+	 * @param	threads				The pool of threads which split each sweep over the partition.
 	 * @throw	PolicyException		An error occurred computing the policy.
-	 * @return	Return the optimal policy.
 	 */
-	virtual void compute_partition(StatesMap *S, ActionsMap *A, StateTransitions *T,
-			FactoredRewards *R, Horizon *h, std::vector<float> &delta,
-			std::vector<State *> &Pj, std::vector<unsigned int> &oj,
-			std::vector<std::unordered_map<State *, double> > &VFixed,
-			std::vector<std::unordered_map<State *, double> > &V,
-			PolicyMap *policy, std::vector<double> &maxDifference);
+	virtual void compute_partition(std::vector<float> &delta,
+			std::vector<unsigned int> &Pj, std::vector<unsigned int> &oj,
+			std::vector<std::vector<double> > &VFixed,
+			std::vector<std::vector<double> > &values,
+			std::vector<unsigned int> &pi, std::vector<double> &maxDifference,
+			ThreadPool *threads);
+
+	/**
+	 * Get the buffers of a partition, which keep their memory between outer iterations. A partition
+	 * which is not part of the current solve gets buffers of its own.
+	 * @param	Pj			The partition over state indices.
+	 * @param	temporary	Owns the buffers of a partition which is not part of the current solve. This
+	 * 						may be updated.
+	 * @return	The buffers of the partition.
+	 */
+	LVIPartitionWorkspace *get_partition_workspace(const std::vector<unsigned int> &Pj,
+			std::unique_ptr<LVIPartitionWorkspace> &temporary);
+
+	/**
+	 * Copy the values from the previous outer step which the sweeps of a partition read, i.e., those of
+	 * its states and of the states on its boundary, rather than all of them.
+	 * @param	scratch		The buffers of the partition.
+	 * @param	Pj			The partition over state indices.
+	 * @param	VFixedi		The i-th value function from the previous outer step.
+	 * @param	Vi			The i-th value function as seen by the partition's sweeps. This will be updated.
+	 */
+	void copy_fixed_values(const LVIPartitionWorkspace &scratch, const std::vector<unsigned int> &Pj,
+			const std::vector<double> &VFixedi, std::vector<double> &Vi) const;
+
+	/**
+	 * Size the pools which solve the partitions concurrently. These are kept between solves, and only
+	 * started again if the number of partitions or of threads changes.
+	 * @param	numPartitions	The number of partitions.
+	 */
+	void reserve_partition_pools(unsigned int numPartitions);
+
+	/**
+	 * Compute one sweep of V_i over the states of a partition, using either a Jacobi or a
+	 * Gauss-Seidel update.
+	 * @param	sets		The interned sets of actions.
+	 * @param	Ai			The set of actions for each state in the partition.
+	 * @param	i			The index of the reward factor.
+	 * @param	Pj			The partition over state indices.
+	 * @param	Vi			The i-th value function over all states, as doubles or floats. This is updated
+	 * 						for the partition.
+	 * @param	ViNext		The scratch values for each state in the partition. This will be updated.
+	 * @param	pij			The index of the action which obtained each value. This will be updated.
+	 * @param	threads		The pool of threads which split a Jacobi sweep.
+	 * @param	sweep		The number of sweeps done so far for V_i, used by the visit order.
+	 * @param	Qi			Optionally, the Q-values of each state in the partition, parallel to its set of
+	 * 						actions and already sized to match. This will be updated.
+	 * @return	The maximal difference between the values before and after the sweep.
+	 */
+	template <typename Value>
+	double compute_sweep(const ActionSets &sets, const std::vector<unsigned int> &Ai, unsigned int i,
+			const std::vector<unsigned int> &Pj, std::vector<Value> &Vi,
+			std::vector<double> &ViNext, std::vector<unsigned int> &pij,
+			ThreadPool *threads, unsigned int sweep,
+			std::vector<std::vector<double> > *Qi = nullptr);
+
+	/**
+	 * Solve the remaining rewards of a partition together, once every state is left with a single action.
+	 * @param	level		The position in the ordering of the first remaining reward.
+	 * @param	scratch		The buffers of the partition. The sets of actions and values of the remaining
+	 * 						rewards will be updated.
+	 * @param	Pj			The partition over state indices.
+	 * @param	oj			The ordering over rewards.
+	 * @param	VFixed		The values of the states from the previous outer iteration.
+	 * @param	pi			The index of the action of each state. This will be updated for the partition.
+	 * @param	threads		The pool of threads which split a Jacobi sweep.
+	 */
+	void compute_fixed_levels(unsigned int level, LVIPartitionWorkspace &scratch,
+			const std::vector<unsigned int> &Pj, const std::vector<unsigned int> &oj,
+			const std::vector<std::vector<double> > &VFixed,
+			std::vector<unsigned int> &pi, ThreadPool *threads);
+
+	/**
+	 * Evaluate a policy for every reward until it converges, with all rewards backed up together.
+	 * @param	pi					The index of the action of each state.
+	 * @param	values				The values of the states, one array for each reward. This will be updated.
+	 * @param	threads				The pool of threads which split a Jacobi sweep.
+	 * @throw	PolicyException		A state had no action, which check_partitions rules out after a solve.
+	 */
+	void compute_policy_evaluation(const std::vector<unsigned int> &pi, std::vector<std::vector<double> > &values,
+			ThreadPool *threads);
+
+	/**
+	 * Do one sweep of a fixed policy over the states of a partition, backing up several rewards together
+	 * by walking the successors of each state once. This requires the interleaved rewards.
+	 * @param	rewards		The indices of the reward factors to back up.
+	 * @param	Pj			The partition over state indices.
+	 * @param	pij			The index of the action of each state in the partition.
+	 * @param	values		The values of the states, interleaved so that those of the r rewards backed up
+	 * 						of state s are at [s * r, (s + 1) * r). These are updated for the partition.
+	 * @param	VNext		The scratch values, with room for each reward of each state in the partition.
+	 * 						This will be updated.
+	 * @param	difference	The maximal difference of each reward backed up. This will be updated.
+	 * @param	threads		The pool of threads which split a Jacobi sweep.
+	 * @param	sweep		The number of sweeps done so far, used by the visit order.
+	 * @return	The maximal difference over all of the rewards backed up.
+	 */
+	double compute_fused_sweep(const std::vector<unsigned int> &rewards,
+			const std::vector<unsigned int> &Pj, const std::vector<unsigned int> &pij,
+			std::vector<double> &values, std::vector<double> &VNext,
+			std::vector<double> &difference, ThreadPool *threads, unsigned int sweep);
+
+	/**
+	 * Eliminate the actions of each state in a partition whose Q-values are, within an error, more
+	 * than eta_i below the best.
+	 * @param	sets	The interned sets of actions. The new sets are interned.
+	 * @param	Ai		The set of actions for each state in the partition. This will be updated.
+	 * @param	Qi		The Q-values of each state in the partition, parallel to its set of actions.
+	 * 					This will be updated to stay parallel.
+	 * @param	error	The error within which each Q-value is of the true one.
+	 * @param	etai	The slack eta_i.
+	 * @return	The number of actions eliminated.
+	 */
+	unsigned long long compute_A_eliminate(ActionSets &sets, std::vector<unsigned int> &Ai,
+			std::vector<std::vector<double> > &Qi, double error, double etai);
 
 	/**
 	 * Compute A_{i+1}^t given that the value function for i, V_i^t, has NOT yet converged.
-	 * @param	S 		The finite states.
+	 * @param	sets	The interned sets of actions. The new set is interned.
 	 * @param	Ai		The set of actions, which are likely pruned.
-	 * @param	T 		The finite state transition function.
-	 * @param	Ri 		The state-action-state rewards.
-	 * @param	h 		The horizon.
-	 * @param	s 		The current state being examined, i.e., V_i(s).
+	 * @param	i		The index of the reward factor.
+	 * @param	s 		The index of the current state being examined, i.e., V_i(s).
 	 * @param	Vi		The i-th value function.
 	 * @param	AiPlus1	The new set of actions for i + 1. This will be updated.
 	 */
-	void compute_A_argmax(StatesMap *S, std::vector<Action *> &Ai,
-			StateTransitions *T, SASRewards *Ri, Horizon *h,
-			State *s, std::unordered_map<State *, double> &Vi,
-			std::vector<Action *> &AiPlus1);
+	void compute_A_argmax(ActionSets &sets, unsigned int Ai, unsigned int i,
+			unsigned int s, const std::vector<double> &Vi,
+			unsigned int &AiPlus1);
 
 	/**
 	 * Compute A_{i+1}^t given that the value function for i, V_i^*, has already converged.
-	 * @param	S 		The finite states.
+	 * @param	sets	The interned sets of actions. The new set is interned.
 	 * @param	Ai		The set of actions, which are likely pruned.
-	 * @param	T 		The finite state transition function.
-	 * @param	Ri 		The state-action-state rewards.
-	 * @param	h 		The horizon.
-	 * @param	s 		The current state being examined, i.e., V_i(s).
+	 * @param	i		The index of the reward factor.
+	 * @param	s 		The index of the current state being examined, i.e., V_i(s).
 	 * @param	Vi		The i-th value function.
 	 * @param	deltai	The slack value for i in K.
 	 * @param	AiPlus1	The new set of actions for i + 1. This will be updated.
 	 */
-	void compute_A_delta(StatesMap *S, std::vector<Action *> &Ai,
-			StateTransitions *T, SASRewards *Ri, Horizon *h,
-			State *s, std::unordered_map<State *, double> &Vi,
+	void compute_A_delta(ActionSets &sets, unsigned int Ai, unsigned int i,
+			unsigned int s, const std::vector<double> &Vi,
 			float deltai,
-			std::vector<Action *> &AiPlus1);
+			unsigned int &AiPlus1);
+
+	/**
+	 * Compute A_{i+1}^t given that the value function for i, V_i^*, has already converged, computing
+	 * the values of Q_i(s, a) into a buffer which keeps its memory.
+	 * @param	sets	The interned sets of actions. The new set is interned.
+	 * @param	Ai		The set of actions, which are likely pruned.
+	 * @param	i		The index of the reward factor.
+	 * @param	s 		The index of the current state being examined, i.e., V_i(s).
+	 * @param	Vi		The i-th value function.
+	 * @param	deltai	The slack value for i in K.
+	 * @param	Qis		The buffer of the values of Q_i(s, a). This will be updated.
+	 * @param	AiPlus1	The new set of actions for i + 1. This will be updated.
+	 */
+	void compute_A_delta(ActionSets &sets, unsigned int Ai, unsigned int i,
+			unsigned int s, const std::vector<double> &Vi,
+			float deltai, std::vector<double> &Qis,
+			unsigned int &AiPlus1);
+
+	/**
+	 * Compute A_{i+1}^t from already computed values of Q_i(s, a) for a state.
+	 * @param	sets	The interned sets of actions. The new set is interned.
+	 * @param	Ai		The set of actions, which are likely pruned.
+	 * @param	Qis		The values of Q_i(s, a), in increasing order of the actions in Ai.
+	 * @param	deltai	The slack value for i in K.
+	 * @param	AiPlus1	The new set of actions for i + 1. This will be updated.
+	 */
+	void compute_A_delta(ActionSets &sets, unsigned int Ai,
+			const std::vector<double> &Qis, float deltai,
+			unsigned int &AiPlus1);
+
+	/**
+	 * Compute A_{i+1}^t from lower and upper bounds on Q_i(s, a) for a state, keeping each action which
+	 * may be within the slack of the best one.
+	 * @param	sets		The interned sets of actions. The new set is interned.
+	 * @param	Ai			The set of actions, which are likely pruned.
+	 * @param	QisLower	The lower bounds on Q_i(s, a), in increasing order of the actions in Ai.
+	 * @param	QisUpper	The upper bounds on Q_i(s, a), in increasing order of the actions in Ai.
+	 * @param	deltai		The slack value for i in K.
+	 * @param	AiPlus1		The new set of actions for i + 1. This will be updated.
+	 */
+	void compute_A_interval(ActionSets &sets, unsigned int Ai,
+			const std::vector<double> &QisLower, const std::vector<double> &QisUpper, float deltai,
+			unsigned int &AiPlus1);
+
+	/**
+	 * Compute the largest gap between the upper and lower bounds of a reward at the target states of
+	 * a partition, or at all of its states if it has no target states.
+	 * @param	Pj		The partition over state indices.
+	 * @param	lower	The lower bounds of all states.
+	 * @param	upper	The upper bounds of all states.
+	 * @return	The largest gap.
+	 */
+	double compute_gap(const std::vector<unsigned int> &Pj, const std::vector<double> &lower,
+			const std::vector<double> &upper) const;
+
+	/**
+	 * Check if the current solve maintains interval bounds, i.e., if they are enabled, the discount
+	 * factor is less than 1, and neither single precision nor over-relaxation is used. The derived
+	 * solvers which do not maintain the bounds override this.
+	 * @return	If the bounds are maintained.
+	 */
+	virtual bool is_interval() const;
+
+	/**
+	 * Seed the interval bounds of a solve, R_i^min / (1 - gamma) for the values and R_i^max / (1 - gamma)
+	 * for the upper bounds, and mark its target states.
+	 * @param	PIndices		The partitions over state indices.
+	 * @throw	StateException	A target state was not one of the states.
+	 */
+	void seed_interval_bounds(const std::vector<std::vector<unsigned int> > &PIndices);
+
+	/**
+	 * Get the memory depth of Anderson acceleration which applies to the current solve.
+	 * @return	The memory depth, or 0 if the sweeps are not accelerated.
+	 */
+	unsigned int get_anderson_active_depth() const;
+
+	/**
+	 * Record the latest sweep of V_i over a partition in the memory of Anderson acceleration, and
+	 * optionally extrapolate the values for the next sweep to start from into the memory.
+	 * @param	scratch		The buffers of the partition, whose values before the sweep are in andersonX.
+	 * @param	memory		The memory of the reward over the partition. This will be updated.
+	 * @param	Pj			The partition over state indices.
+	 * @param	Vi			The i-th value function over all states, after the sweep.
+	 * @param	extrapolate	If the values should be extrapolated.
+	 * @return	True if the values were extrapolated, false otherwise.
+	 */
+	bool compute_anderson(LVIPartitionWorkspace &scratch, LVIAndersonMemory &memory,
+			const std::vector<unsigned int> &Pj, const std::vector<double> &Vi, bool extrapolate);
 
 	/**
 	 * Compute V_i^{t+1} given that the value function for i, V_i^t.
-	 * @param	S 		The finite states.
+	 * @param	sets	The interned sets of actions.
 	 * @param	Ai		The set of actions, which are likely pruned.
-	 * @param	T 		The finite state transition function.
-	 * @param	Ri 		The state-action-state rewards.
-	 * @param	h 		The horizon.
-	 * @param	s 		The current state being examined, i.e., V_i(s).
-	 * @param	Vi		The i-th value function at time t.
-	 * @param	ViNext	The i-th value function at time t+1. This will be updated.
-	 * @param	a		The action taken to obtain the max value. This will be updated.
+	 * @param	i		The index of the reward factor.
+	 * @param	s 		The index of the current state being examined, i.e., V_i(s).
+	 * @param	Vi		The i-th value function at time t, as doubles or floats.
+	 * @param	ViNexts	The i-th value of state s at time t+1. This will be updated.
+	 * @param	a		The index of the action taken to obtain the max value. This will be updated.
+	 * @param	Qis		Optionally, the values of Q_i(s, a), in increasing order of the actions in Ai.
+	 * 					This will be updated.
 	 */
-	void compute_V(StatesMap *S, std::vector<Action *> &Ai,
-			StateTransitions *T, SASRewards *Ri, Horizon *h,
-			State *s, std::unordered_map<State *, double> &Vi,
-			std::unordered_map<State *, double> &ViNext, Action *&a);
+	template <typename Value>
+	void compute_V(const ActionSets &sets, unsigned int Ai, unsigned int i,
+			unsigned int s, const std::vector<Value> &Vi,
+			double &ViNexts, unsigned int &a, double *Qis = nullptr);
 
 	/**
 	 * Compute the value of Q_i(s, a) for some state and action.
-	 * @param	S					The finite set of states.
-	 * @param	T					The finite state transition function.
-	 * @param	Ri					The i-th state-action-state reward function.
-	 * @param	h					The horizon.
-	 * @param	s					The current state.
-	 * @param	a					The action taken at the current state.
-	 * @param	Vi					The i-th value function.
-	 * @throw	PolicyException		There was an undefined value of a state.
+	 * @param	i		The index of the reward factor.
+	 * @param	s		The index of the current state.
+	 * @param	a		The index of the action taken at the current state.
+	 * @param	Vi		The i-th value function.
+	 * @return	Returns the Q_i(s, a) value.
+	 */
+	double compute_Q(unsigned int i, unsigned int s, unsigned int a,
+			const std::vector<double> &Vi);
+
+	/**
+	 * Compute the value of Q_i(s, a) for some state and action from single-precision values,
+	 * probabilities, and rewards, accumulating in double.
+	 * @param	i		The index of the reward factor.
+	 * @param	s		The index of the current state.
+	 * @param	a		The index of the action taken at the current state.
+	 * @param	Vi		The i-th value function, as floats.
 	 * @return	Returns the Q_i(s, a) value.
 	 */
-	double compute_Q(StatesMap *S, StateTransitions *T, SASRewards *Ri,
-			Horizon *h, State *s, Action *a,
-			std::unordered_map<State *, double> &Vi);
+	double compute_Q(unsigned int i, unsigned int s, unsigned int a,
+			const std::vector<float> &Vi);
+
+	/**
+	 * The compiled, flat form of the LMDP being solved.
+	 */
+	CompiledLMDP model;
+
+	/**
+	 * The value of the states, one array for each reward, indexed by state index.
+	 */
+	std::vector<std::vector<double> > values;
+
+	/**
+	 * The index of the action of each state, or the number of actions for a state in no partition.
+	 */
+	std::vector<unsigned int> policyActions;
 
 	/**
 	 * The value of the states, one for each reward.
@@ -208,6 +1071,240 @@ protected:
 	 */
 	bool loopingVersion;
 
+	/**
+	 * The pool of threads which split each sweep over the states of a partition.
+	 */
+	ThreadPool *pool;
+
+	/**
+	 * If the partitions are solved concurrently within each outer iteration.
+	 */
+	bool concurrentPartitions;
+
+	/**
+	 * When solving the partitions concurrently, the share of the threads of each partition.
+	 */
+	std::vector<ThreadPool *> partitionPools;
+
+	/**
+	 * When solving the partitions concurrently, the pool which runs the partitions themselves.
+	 */
+	ThreadPool *partitionRunner;
+
+	/**
+	 * Guards the policy and the sweep and backup counts, which are shared by partitions that are solved concurrently.
+	 */
+	std::mutex partitionsMutex;
+
+	/**
+	 * If each sweep updates the values in place (Gauss-Seidel) instead of from the previous sweep (Jacobi).
+	 */
+	bool gaussSeidel;
+
+	/**
+	 * The relaxation factor of Gauss-Seidel sweeps.
+	 */
+	double relaxation;
+
+	/**
+	 * The order in which Gauss-Seidel sweeps visit the states of a partition.
+	 */
+	LVIVisitOrder visitOrder;
+
+	/**
+	 * If the slack pruning is fused with each reward's final sweep.
+	 */
+	bool fusedPruning;
+
+	/**
+	 * If the rewards whose actions are already fixed are backed up together.
+	 */
+	bool fusedBackups;
+
+	/**
+	 * If the final policy is evaluated for all rewards once the outer iterations are done.
+	 */
+	bool policyEvaluation;
+
+	/**
+	 * The initial values of the states, one for each reward, keyed by the hash value of each state.
+	 */
+	std::vector<std::unordered_map<unsigned int, double> > initialValues;
+
+	/**
+	 * The hash value of the initial action of the states, keyed by the hash value of each state.
+	 */
+	std::unordered_map<unsigned int, unsigned int> initialPolicy;
+
+	/**
+	 * The state of each hash value of the initial values and policy, or null for those loaded from a
+	 * file, which a state of the model must be, or read the same as, to be matched.
+	 */
+	std::unordered_map<unsigned int, State *> initialStates;
+
+	/**
+	 * If the next solve starts from the values of the last one, as within a slack sweep.
+	 */
+	bool resumeValues;
+
+	/**
+	 * If the solves were asked to stop.
+	 */
+	std::atomic<bool> stopRequested;
+
+	/**
+	 * The deadline of the solves, as ticks of the steady clock since its epoch, or the largest count
+	 * if there is none. The count is atomic, since the thread of an asynchronous solve reads it.
+	 */
+	std::atomic<std::chrono::steady_clock::rep> deadline;
+
+	/**
+	 * The largest residual of the latest outer iteration.
+	 */
+	std::atomic<double> residual;
+
+	/**
+	 * The discount factor of the current solve, which may be read from another thread while solving.
+	 */
+	std::atomic<double> discountFactor;
+
+	/**
+	 * If the last solve converged.
+	 */
+	std::atomic<bool> converged;
+
+	/**
+	 * The telemetry used when none is set.
+	 */
+	LVINullTelemetry nullTelemetry;
+
+	/**
+	 * The telemetry which receives the convergence of each outer iteration.
+	 */
+	LVITelemetry *telemetry;
+
+	/**
+	 * The index of each partition of the current solve, keyed by the partition.
+	 */
+	std::unordered_map<const std::vector<unsigned int> *, unsigned int> partitionIndices;
+
+	/**
+	 * The buffers reused by the outer iterations of each solve.
+	 */
+	LVIWorkspace workspace;
+
+	/**
+	 * The sweeps of each reward within each partition during the current outer iteration.
+	 */
+	std::vector<std::vector<unsigned int> > levelSweeps;
+
+	/**
+	 * The total size of the sets of actions of each reward within each partition during the current
+	 * outer iteration.
+	 */
+	std::vector<std::vector<unsigned long long> > levelActions;
+
+	/**
+	 * If actions are eliminated during the sweeps of each reward.
+	 */
+	bool actionElimination;
+
+	/**
+	 * The total number of actions eliminated during the last solve.
+	 */
+	unsigned long long eliminations;
+
+	/**
+	 * If the solves maintain lower and upper bounds on the values of each reward.
+	 */
+	bool intervalBounds;
+
+	/**
+	 * The states whose gap must close, or none for all of the states in the partitions.
+	 */
+	std::vector<State *> intervalTargets;
+
+	/**
+	 * If each state is a target of the current solve, by state index.
+	 */
+	std::vector<bool> intervalTargetStates;
+
+	/**
+	 * The upper bounds on the values of the states, one for each reward, indexed by state index. The
+	 * lower bounds are the values themselves.
+	 */
+	std::vector<std::vector<double> > valuesUpper;
+
+	/**
+	 * The lower bounds on the values of the states from the last solve with interval bounds.
+	 */
+	std::vector<std::unordered_map<State *, double> > VLower;
+
+	/**
+	 * The upper bounds on the values of the states from the last solve with interval bounds.
+	 */
+	std::vector<std::unordered_map<State *, double> > VUpper;
+
+	/**
+	 * The largest gap at the target states after the last solve with interval bounds.
+	 */
+	double intervalGap;
+
+	/**
+	 * If the gap at the target states closed in the last solve with interval bounds.
+	 */
+	bool intervalClosed;
+
+	/**
+	 * The memory depth of Anderson acceleration of the sweeps of each reward, or 0 for none.
+	 */
+	unsigned int andersonDepth;
+
+	/**
+	 * The number of extrapolated sweeps which were kept during the last solve.
+	 */
+	unsigned long long andersonAccepted;
+
+	/**
+	 * The number of extrapolated sweeps which were undone during the last solve.
+	 */
+	unsigned long long andersonRejected;
+
+	/**
+	 * The instruction set of the Bellman backup kernel.
+	 */
+	BellmanISA bellmanISA;
+
+	/**
+	 * The Bellman backup kernel used by compute_Q.
+	 */
+	BellmanKernel bellmanKernel;
+
+	/**
+	 * The single-precision Bellman backup kernel used by compute_Q.
+	 */
+	BellmanKernelFloat bellmanKernelSingle;
+
+	/**
+	 * If the sweeps store the values, probabilities, and rewards as floats.
+	 */
+	bool singlePrecision;
+
+	/**
+	 * The number of outer iterations of the last solve.
+	 */
+	unsigned int iterations;
+
+	/**
+	 * The total number of sweeps of the last solve, one for each reward.
+	 */
+	std::vector<unsigned int> sweeps;
+
+	/**
+	 * The total number of state backups of the last solve.
+	 */
+	unsigned long long backups;
+
 };
 
 
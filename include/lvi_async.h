@@ -0,0 +1,151 @@
+/**
+ *  The MIT License (MIT)
+ *
+ *  Copyright (c) 2014 Kyle Wray, University of Massachusetts
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy of
+ *  this software and associated documentation files (the "Software"), to deal in
+ *  the Software without restriction, including without limitation the rights to
+ *  use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ *  the Software, and to permit persons to whom the Software is furnished to do so,
+ *  subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ *  FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ *  COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ *  IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ *  CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+#ifndef LVI_ASYNC_H
+#define LVI_ASYNC_H
+
+
+#include "lvi.h"
+
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <exception>
+
+/**
+ * A handle to an LVI solve running on its own thread. The solve may be cancelled, or given a
+ * wall-clock time limit; either way, it returns the best policy found so far, and the error bound
+ * of the values tells how far from converged it was.
+ */
+class LVIAsyncSolve {
+public:
+	/**
+	 * Start solving an LMDP on a new thread. The solver and the LMDP must not be used elsewhere
+	 * until the solve is done.
+	 * @param	solver		The solver, of any kind of LVI.
+	 * @param	lmdp		The LMDP to solve.
+	 * @param	timeLimit	The wall-clock time limit from now, in seconds, or 0 for none.
+	 */
+	LVIAsyncSolve(LVI *solver, LMDP *lmdp, double timeLimit);
+
+	/**
+	 * The deconstructor for the LVIAsyncSolve class, which cancels the solve and waits for it.
+	 * A policy which was never taken with get is deleted.
+	 */
+	virtual ~LVIAsyncSolve();
+
+	/**
+	 * Ask the solve to stop as soon as every state has an action. This does not wait.
+	 */
+	void cancel();
+
+	/**
+	 * Check if the solve is done.
+	 * @return	True if the solve is done, false otherwise.
+	 */
+	bool is_done() const;
+
+	/**
+	 * Wait for the solve to be done.
+	 */
+	void wait();
+
+	/**
+	 * Wait for the solve to be done, for at most some time.
+	 * @param	seconds		The longest time to wait, in seconds.
+	 * @return	True if the solve is done, false otherwise.
+	 */
+	bool wait_for(double seconds);
+
+	/**
+	 * Wait for the solve to be done, and take its policy.
+	 * @throw	Any exception thrown by the solve.
+	 * @return	The policy, which the caller must delete, or nullptr if it was already taken.
+	 */
+	PolicyMap *get();
+
+	/**
+	 * Get the largest residual of the latest outer iteration, as the progress of the solve.
+	 * @return	The latest residual.
+	 */
+	double get_residual() const;
+
+	/**
+	 * Get the bound on the error of the values from the latest residual.
+	 * @return	The bound on the error of the values.
+	 */
+	double get_error_bound() const;
+
+	/**
+	 * Get if the solve converged, or was stopped early. This is only meaningful once it is done.
+	 * @return	True if the solve converged, false if it was stopped.
+	 */
+	bool get_converged() const;
+
+protected:
+	/**
+	 * Solve the LMDP, on the thread of the solve.
+	 * @param	lmdp	The LMDP to solve.
+	 */
+	void run(LMDP *lmdp);
+
+	/**
+	 * The solver.
+	 */
+	LVI *solver;
+
+	/**
+	 * The thread of the solve.
+	 */
+	std::thread thread;
+
+	/**
+	 * Guards the result of the solve.
+	 */
+	mutable std::mutex mutex;
+
+	/**
+	 * Notified when the solve is done.
+	 */
+	std::condition_variable finished;
+
+	/**
+	 * If the solve is done.
+	 */
+	bool done;
+
+	/**
+	 * The policy of the solve, until it is taken.
+	 */
+	PolicyMap *policy;
+
+	/**
+	 * The exception thrown by the solve, if any.
+	 */
+	std::exception_ptr error;
+
+};
+
+
+#endif // LVI_ASYNC_H
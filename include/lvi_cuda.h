@@ -79,11 +79,11 @@ protected:
 	 * @param	h					The horizon.
 	 * @param	delta				The slack vector.
 	 * @param	j					The index of the partition.
-	 * @param	Pj					The z-partition over states.
+	 * @param	Pj					The z-partition over state indices.
 	 * @param	oj					The z-array of orderings over each of the k rewards.
 	 * @param	VFixed				The fixed set of value functions from the previous outer step.
-	 * @param	V					The resultant value of the states. This is updated.
-	 * @param	policy				The policy for the states in the partition. This is updated.
+	 * @param	values				The resultant value of the states. This is updated.
+	 * @param	pi					The index of the action of each state. This is updated for the partition.
 	 * @param	maxDifference		The maximal difference for convergence checking. This is updated.
 	 * @throw	PolicyException		An error occurred computing the policy.
 	 * @return	Return the optimal policy.
@@ -91,10 +91,10 @@ protected:
 	virtual void compute_partition(StatesMap *S, ActionsMap *A, StateTransitions *T,
 			FactoredRewards *R, Horizon *h,  std::vector<float> &delta,
 			int j,
-			std::vector<State *> &Pj, std::vector<unsigned int> &oj,
-			std::vector<std::unordered_map<State *, double> > &VFixed,
-			std::vector<std::unordered_map<State *, double> > &V,
-			PolicyMap *policy, std::vector<double> &maxDifference);
+			std::vector<unsigned int> &Pj, std::vector<unsigned int> &oj,
+			std::vector<std::vector<double> > &VFixed,
+			std::vector<std::vector<double> > &values,
+			std::vector<unsigned int> &pi, std::vector<double> &maxDifference);
 
 	/**
 	 * Initialize the CUDA variables and transfer to the device.
@@ -124,6 +124,21 @@ protected:
 	 */
 	unsigned int **cudaPI;
 
+	/**
+	 * The device-side state index of each compiled state index.
+	 */
+	std::vector<unsigned int> cudaIndices;
+
+	/**
+	 * The host-side values of the states, in device-side order.
+	 */
+	float *cudaVi;
+
+	/**
+	 * The host-side available actions of each state in a partition.
+	 */
+	bool *cudaAStar;
+
 	/**
 	 * The device-side pointer to the memory location of state transitions.
 	 */
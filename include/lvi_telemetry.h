@@ -0,0 +1,211 @@
+/**
+ *  The MIT License (MIT)
+ *
+ *  Copyright (c) 2014 Kyle Wray, University of Massachusetts
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy of
+ *  this software and associated documentation files (the "Software"), to deal in
+ *  the Software without restriction, including without limitation the rights to
+ *  use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ *  the Software, and to permit persons to whom the Software is furnished to do so,
+ *  subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ *  FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ *  COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ *  IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ *  CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+#ifndef LVI_TELEMETRY_H
+#define LVI_TELEMETRY_H
+
+
+#include <vector>
+#include <string>
+
+/**
+ * The convergence of one reward within one partition over one outer iteration of LVI.
+ */
+struct LVITelemetryRecord {
+	/**
+	 * The outer iteration, starting at 1.
+	 */
+	unsigned int iteration;
+
+	/**
+	 * The index of the partition.
+	 */
+	unsigned int partition;
+
+	/**
+	 * The index of the reward.
+	 */
+	unsigned int reward;
+
+	/**
+	 * The position of the reward in the partition's ordering.
+	 */
+	unsigned int level;
+
+	/**
+	 * The maximal change in the reward's values over the partition's states during the iteration.
+	 */
+	double residual;
+
+	/**
+	 * If the residual was within the convergence criterion.
+	 */
+	bool converged;
+
+	/**
+	 * The number of sweeps over the partition for the reward during the iteration.
+	 */
+	unsigned int sweeps;
+
+	/**
+	 * The total size of the sets of actions available to the partition's states for the reward.
+	 */
+	unsigned long long actions;
+
+	/**
+	 * The wall time since the start of the solve at the end of the iteration, in seconds.
+	 */
+	double time;
+};
+
+/**
+ * An interface for receiving the convergence of LVI. Each outer iteration produces one record
+ * for each reward in each partition.
+ */
+class LVITelemetry {
+public:
+	/**
+	 * The deconstructor for the LVITelemetry class.
+	 */
+	virtual ~LVITelemetry();
+
+	/**
+	 * Check if records are wanted at all. If not, LVI does not gather them.
+	 * @return	True if records are wanted, false otherwise.
+	 */
+	virtual bool is_enabled() const = 0;
+
+	/**
+	 * Receive a record.
+	 * @param	record	The record.
+	 */
+	virtual void record(const LVITelemetryRecord &record) = 0;
+
+};
+
+/**
+ * Telemetry which wants no records. This is the default of LVI.
+ */
+class LVINullTelemetry : public LVITelemetry {
+public:
+	/**
+	 * The deconstructor for the LVINullTelemetry class.
+	 */
+	virtual ~LVINullTelemetry();
+
+	/**
+	 * Check if records are wanted at all.
+	 * @return	Always false.
+	 */
+	virtual bool is_enabled() const;
+
+	/**
+	 * Ignore a record.
+	 * @param	record	The record.
+	 */
+	virtual void record(const LVITelemetryRecord &record);
+
+};
+
+/**
+ * Telemetry which keeps the most recent records in a ring buffer allocated up front, and which
+ * exports them to CSV or JSON.
+ */
+class LVIRingTelemetry : public LVITelemetry {
+public:
+	/**
+	 * The constructor for the LVIRingTelemetry class.
+	 * @param	capacity	The maximal number of records kept; older records are overwritten.
+	 */
+	LVIRingTelemetry(unsigned int capacity);
+
+	/**
+	 * The deconstructor for the LVIRingTelemetry class.
+	 */
+	virtual ~LVIRingTelemetry();
+
+	/**
+	 * Check if records are wanted at all.
+	 * @return	Always true.
+	 */
+	virtual bool is_enabled() const;
+
+	/**
+	 * Keep a record, overwriting the oldest one if the buffer is full.
+	 * @param	record	The record.
+	 */
+	virtual void record(const LVITelemetryRecord &record);
+
+	/**
+	 * Remove all records.
+	 */
+	void clear();
+
+	/**
+	 * Get the number of records kept.
+	 * @return	The number of records kept.
+	 */
+	unsigned int get_num_records() const;
+
+	/**
+	 * Get a record, from oldest to newest.
+	 * @param	r	The index of the record, from 0 (the oldest) to get_num_records() - 1.
+	 * @return	The record.
+	 */
+	const LVITelemetryRecord &get_record(unsigned int r) const;
+
+	/**
+	 * Save the records to a CSV file, from oldest to newest, with a header line.
+	 * @param	filename	The name of the file to save.
+	 * @return	Returns true if an error arose, and false otherwise.
+	 */
+	bool save_csv(std::string filename) const;
+
+	/**
+	 * Save the records to a JSON file, as an array of objects from oldest to newest.
+	 * @param	filename	The name of the file to save.
+	 * @return	Returns true if an error arose, and false otherwise.
+	 */
+	bool save_json(std::string filename) const;
+
+protected:
+	/**
+	 * The records, of a fixed size.
+	 */
+	std::vector<LVITelemetryRecord> records;
+
+	/**
+	 * The index of the oldest record.
+	 */
+	unsigned int first;
+
+	/**
+	 * The number of records kept.
+	 */
+	unsigned int size;
+
+};
+
+
+#endif // LVI_TELEMETRY_H
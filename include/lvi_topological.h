@@ -0,0 +1,132 @@
+/**
+ *  The MIT License (MIT)
+ *
+ *  Copyright (c) 2014 Kyle Wray, University of Massachusetts
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy of
+ *  this software and associated documentation files (the "Software"), to deal in
+ *  the Software without restriction, including without limitation the rights to
+ *  use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ *  the Software, and to permit persons to whom the Software is furnished to do so,
+ *  subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ *  FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ *  COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ *  IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ *  CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+#ifndef LVI_TOPOLOGICAL_H
+#define LVI_TOPOLOGICAL_H
+
+
+#include "lvi.h"
+
+#include <unordered_map>
+
+/**
+ * Solve a Lexicographic Markov Decision Process (LMDP) with topological value iteration. The
+ * states of each partition are split into the strongly connected components (SCCs) of the
+ * transition graph restricted to the partition. Each reward's value function is then converged
+ * one SCC at a time, in reverse topological order, so that an SCC is only solved once all of
+ * the SCCs it can reach have been. Each reward's value function is converged within each outer
+ * step, as in the so-called 'loopingVersion'.
+ */
+class LVITopological : public LVI {
+public:
+	/**
+	 * The default constructor for the LVITopological class. The default tolerance is 0.001.
+	 */
+	LVITopological();
+
+	/**
+	 * A constructor for the LVITopological class which allows for the specification
+	 * of the convergence criterion (tolerance).
+	 * @param	tolerance		The tolerance which determines convergence of value iteration.
+	 */
+	LVITopological(double tolerance);
+
+	/**
+	 * The deconstructor for the LVITopological class.
+	 */
+	virtual ~LVITopological();
+
+protected:
+	/**
+	 * Solve an infinite horizon LMDP using topological value iteration.
+	 * @param	S					The finite states.
+	 * @param	A					The finite actions.
+	 * @param	T					The finite state transition function.
+	 * @param	R					The factored state-action-state rewards.
+	 * @param	h					The horizon.
+	 * @param	delta				The slack vector.
+	 * @param	P					The vector of partitions.
+	 * @param	o					The vector of orderings.
+	 * @throw	PolicyException		An error occurred computing the policy.
+	 * @return	Return the optimal policy.
+	 */
+	virtual PolicyMap *solve_infinite_horizon(StatesMap *S, ActionsMap *A,
+			StateTransitions *T, FactoredRewards *R, Horizon *h,
+			std::vector<float> &delta,
+			std::vector<std::vector<State *> > &P,
+			std::vector<std::vector<unsigned int> > &o);
+
+	/**
+	 * Solve the infinite horizon MDP for a particular partition of the state space, one SCC
+	 * at a time.
+	 * @param	delta				The slack vector.
+	 * @param	Pj					The z-partition over state indices.
+	 * @param	oj					The z-array of orderings over each of the k rewards.
+	 * @param	VFixed				The fixed set of value functions from the previous outer step.
+	 * @param	values				The resultant value of the states. This is updated.
+	 * @param	pi					The index of the action of each state. This is updated for the partition.
+	 * @param	maxDifference		The maximal difference for convergence checking. This is updated.
+	 * @param	threads				The pool of threads; unused, since the SCCs are solved in order.
+	 * @throw	PolicyException		An error occurred computing the policy.
+	 */
+	virtual void compute_partition(std::vector<float> &delta,
+			std::vector<unsigned int> &Pj, std::vector<unsigned int> &oj,
+			std::vector<std::vector<double> > &VFixed,
+			std::vector<std::vector<double> > &values,
+			std::vector<unsigned int> &pi, std::vector<double> &maxDifference,
+			ThreadPool *threads);
+
+	/**
+	 * Interval bounds are never maintained, since the sweeps of each SCC does not sweep the upper bounds.
+	 * @return	Always false.
+	 */
+	virtual bool is_interval() const;
+
+	/**
+	 * Compute the SCCs of the transition graph restricted to a partition, over all actions.
+	 * @param	Pj				The z-partition over state indices.
+	 * @param	components		The SCCs in reverse topological order, i.e., an SCC never has a
+	 * 							successor in a later SCC. Each is a list of positions in the
+	 * 							partition. This will be updated.
+	 * @param	cyclic			For each SCC, if it has more than one state or a self-loop. This
+	 * 							will be updated.
+	 */
+	void compute_components(const std::vector<unsigned int> &Pj,
+			std::vector<std::vector<unsigned int> > &components,
+			std::vector<bool> &cyclic);
+
+	/**
+	 * The SCCs of each partition of the current solve, keyed by the partition.
+	 */
+	std::unordered_map<const std::vector<unsigned int> *, std::vector<std::vector<unsigned int> > > partitionComponents;
+
+	/**
+	 * If each SCC of each partition of the current solve is cyclic, keyed by the partition.
+	 */
+	std::unordered_map<const std::vector<unsigned int> *, std::vector<bool> > partitionCyclic;
+
+};
+
+
+#endif // LVI_TOPOLOGICAL_H
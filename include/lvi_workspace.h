@@ -0,0 +1,360 @@
+/**
+ *  The MIT License (MIT)
+ *
+ *  Copyright (c) 2014 Kyle Wray, University of Massachusetts
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy of
+ *  this software and associated documentation files (the "Software"), to deal in
+ *  the Software without restriction, including without limitation the rights to
+ *  use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ *  the Software, and to permit persons to whom the Software is furnished to do so,
+ *  subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ *  FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ *  COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ *  IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ *  CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+#ifndef LVI_WORKSPACE_H
+#define LVI_WORKSPACE_H
+
+
+#include "compiled_lmdp.h"
+#include "action_sets.h"
+
+#include <vector>
+#include <utility>
+
+/**
+ * The memory of Anderson acceleration of the sweeps of one reward over one partition, which is kept
+ * between outer iterations while the reward's sets of actions do not change.
+ */
+struct LVIAndersonMemory {
+	/**
+	 * The default constructor for the LVIAndersonMemory struct.
+	 */
+	LVIAndersonMemory();
+
+	/**
+	 * Forget the sweeps in memory, keeping the buffers.
+	 */
+	void clear();
+
+	/**
+	 * The values of the states in the partition after the latest plain sweep.
+	 */
+	std::vector<double> G;
+
+	/**
+	 * The residuals of the states in the partition of the latest plain sweep.
+	 */
+	std::vector<double> F;
+
+	/**
+	 * The differences between the residuals of consecutive sweeps, one column of the partition's size
+	 * for each sweep in memory.
+	 */
+	std::vector<double> DF;
+
+	/**
+	 * The differences between the values after consecutive sweeps, parallel to the residuals.
+	 */
+	std::vector<double> DG;
+
+	/**
+	 * The inner products of the columns of the residual differences, a (depth * depth) matrix.
+	 */
+	std::vector<double> Gram;
+
+	/**
+	 * The number of columns in memory.
+	 */
+	unsigned int columns;
+
+	/**
+	 * The column which the next sweep overwrites.
+	 */
+	unsigned int next;
+
+	/**
+	 * If the residual and values of a previous plain sweep are stored.
+	 */
+	bool previous;
+
+	/**
+	 * The values extrapolated from the latest plain sweep, which the next sweep starts from.
+	 */
+	std::vector<double> extrapolation;
+
+	/**
+	 * The values of the states outside the partition which its sweeps read, as of the sweeps in memory.
+	 */
+	std::vector<double> boundary;
+
+	/**
+	 * If an extrapolation from the latest plain sweep is waiting for the next sweep.
+	 */
+	bool extrapolated;
+
+	/**
+	 * The residual of the latest kept sweep, which decides if the next extrapolation is kept.
+	 */
+	double residual;
+};
+
+/**
+ * The scratch buffers of one partition, which keep their memory between the outer iterations of
+ * a solve so that compute_partition does not allocate.
+ */
+struct LVIPartitionWorkspace {
+	/**
+	 * The constructor for the LVIPartitionWorkspace struct.
+	 * @param	numActions	The number of actions, m.
+	 */
+	LVIPartitionWorkspace(unsigned int numActions);
+
+	/**
+	 * Size the buffers for a partition of a compiled model. Buffers which are already large enough
+	 * keep their memory, and the sets of actions are cleared.
+	 * @param	model			The compiled model.
+	 * @param	Pj				The states in the partition.
+	 * @param	singlePrecision	If the single-precision values are needed.
+	 * @param	interval		If the upper bounds on the values are needed.
+	 * @param	andersonDepth	The memory depth of Anderson acceleration, or 0 if it is not used.
+	 * @return	The number of buffers which had to grow.
+	 */
+	unsigned long long reserve(const CompiledLMDP &model, const std::vector<unsigned int> &Pj,
+			bool singlePrecision, bool interval, unsigned int andersonDepth);
+
+	/**
+	 * The interned sets of actions.
+	 */
+	ActionSets sets;
+
+	/**
+	 * The position of each state of the model in the partition, or -1 if it is not in the partition.
+	 */
+	std::vector<int> position;
+
+	/**
+	 * The states outside the partition which its states may transition to, in increasing order. Its
+	 * sweeps only read the values of these and of its own states.
+	 */
+	std::vector<unsigned int> boundary;
+
+	/**
+	 * The values of all states, one array for each reward, as seen by the partition's sweeps.
+	 */
+	std::vector<std::vector<double> > VPrime;
+
+	/**
+	 * The set of actions of each reward for each state in the partition.
+	 */
+	std::vector<std::vector<unsigned int> > AStar;
+
+	/**
+	 * The values of the states in the partition after a sweep.
+	 */
+	std::vector<double> Vi;
+
+	/**
+	 * The single-precision values of all states for the current reward.
+	 */
+	std::vector<float> ViSingle;
+
+	/**
+	 * The index of the action which obtained each value.
+	 */
+	std::vector<unsigned int> pij;
+
+	/**
+	 * The index of the action of each state in the partition under the previous policy, for LPI.
+	 */
+	std::vector<unsigned int> previous;
+
+	/**
+	 * The bound on the residual of each state in the partition, for prioritized sweeping.
+	 */
+	std::vector<double> priority;
+
+	/**
+	 * The heap of the positions of the states in the partition keyed by their bounds, for prioritized
+	 * sweeping. Its memory is kept, so it only grows while it holds more entries than ever before.
+	 */
+	std::vector<std::pair<double, unsigned int> > queue;
+
+	/**
+	 * The Q-values of each state in the partition, each with room for every action.
+	 */
+	std::vector<std::vector<double> > Qi;
+
+	/**
+	 * The upper bounds on the values of all states for the current reward, as seen by the partition's sweeps.
+	 */
+	std::vector<double> ViUpper;
+
+	/**
+	 * The upper bounds on the Q-values of each state in the partition, each with room for every action.
+	 */
+	std::vector<std::vector<double> > QiUpper;
+
+	/**
+	 * With interval bounds or Anderson acceleration, the set of actions of each reward which its values
+	 * were last swept over, indexed by the position of each state in the partition.
+	 */
+	std::vector<std::vector<unsigned int> > ASwept;
+
+	/**
+	 * If the values of each reward were swept over the sets of actions in ASwept since the solve began,
+	 * or since its interval bounds were last seeded.
+	 */
+	std::vector<bool> swept;
+
+	/**
+	 * The values of the states in the partition before the latest sweep, for Anderson acceleration.
+	 */
+	std::vector<double> andersonX;
+
+	/**
+	 * The memory of Anderson acceleration of each reward.
+	 */
+	std::vector<LVIAndersonMemory> anderson;
+
+	/**
+	 * The least-squares system of the extrapolation, a (depth * (depth + 1)) augmented matrix.
+	 */
+	std::vector<double> andersonSystem;
+
+	/**
+	 * The indices of the rewards backed up together.
+	 */
+	std::vector<unsigned int> rewards;
+
+	/**
+	 * The values of the rewards backed up together, interleaved for each state so that a fused sweep
+	 * reads those of a successor together.
+	 */
+	std::vector<double> VInterleaved;
+
+	/**
+	 * The values of every reward of each state in the partition after a fused sweep.
+	 */
+	std::vector<double> VNext;
+
+	/**
+	 * The maximal difference of each reward during a fused sweep.
+	 */
+	std::vector<double> difference;
+};
+
+/**
+ * The buffers of one solve, allocated when the solve starts and reused by each of its outer
+ * iterations, so that the steady-state loop does not allocate. The buffers only grow, so that
+ * solving the same model again allocates nothing either.
+ */
+class LVIWorkspace {
+public:
+	/**
+	 * The default constructor for the LVIWorkspace class.
+	 */
+	LVIWorkspace();
+
+	/**
+	 * The deconstructor for the LVIWorkspace class.
+	 */
+	virtual ~LVIWorkspace();
+
+	/**
+	 * Size the buffers for a compiled model and its partitions.
+	 * @param	model			The compiled model.
+	 * @param	P				The partitions over state indices.
+	 * @param	singlePrecision	If the single-precision values are needed.
+	 * @param	interval		If the upper bounds on the values are needed.
+	 * @param	andersonDepth	The memory depth of Anderson acceleration, or 0 if it is not used.
+	 */
+	void reserve(const CompiledLMDP &model, const std::vector<std::vector<unsigned int> > &P,
+			bool singlePrecision, bool interval, unsigned int andersonDepth);
+
+	/**
+	 * Free all of the buffers.
+	 */
+	void clear();
+
+	/**
+	 * Get the values of the states from the previous outer iteration, one array for each reward.
+	 * These are swapped with the current values at the start of each outer iteration.
+	 * @return	The values from the previous outer iteration.
+	 */
+	std::vector<std::vector<double> > &get_fixed_values();
+
+	/**
+	 * Get the upper bounds on the values of the states from the previous outer iteration, one array
+	 * for each reward. These are empty unless the upper bounds were reserved.
+	 * @return	The upper bounds from the previous outer iteration.
+	 */
+	std::vector<std::vector<double> > &get_fixed_upper_values();
+
+	/**
+	 * Get the maximal difference of each reward within each partition during an outer iteration.
+	 * @return	The differences, indexed by partition and then reward.
+	 */
+	std::vector<std::vector<double> > &get_differences();
+
+	/**
+	 * Get the number of partitions which have buffers.
+	 * @return	The number of partitions.
+	 */
+	unsigned int get_num_partitions() const;
+
+	/**
+	 * Get the buffers of a partition.
+	 * @param	j	The index of the partition.
+	 * @return	The buffers of the partition.
+	 */
+	LVIPartitionWorkspace *get_partition(unsigned int j);
+
+	/**
+	 * Get the number of times the buffers grew so far: each buffer which had to grow, and each new
+	 * set of actions which was interned. Once a solve has seen all of its sets of actions, this stops
+	 * increasing. This only counts the workspace's own buffers, not every heap allocation of a solve.
+	 * @return	The number of buffer growths.
+	 */
+	unsigned long long get_num_growths() const;
+
+protected:
+	/**
+	 * The buffers of each partition.
+	 */
+	std::vector<LVIPartitionWorkspace *> partitions;
+
+	/**
+	 * The values of the states from the previous outer iteration.
+	 */
+	std::vector<std::vector<double> > fixedValues;
+
+	/**
+	 * The upper bounds on the values of the states from the previous outer iteration.
+	 */
+	std::vector<std::vector<double> > fixedUpperValues;
+
+	/**
+	 * The maximal difference of each reward within each partition.
+	 */
+	std::vector<std::vector<double> > differences;
+
+	/**
+	 * The number of buffer growths counted so far, other than the sets of actions still interned.
+	 */
+	unsigned long long growths;
+
+};
+
+
+#endif // LVI_WORKSPACE_H
@@ -0,0 +1,503 @@
+/**
+ *  The MIT License (MIT)
+ *
+ *  Copyright (c) 2014 Kyle Wray, University of Massachusetts
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy of
+ *  this software and associated documentation files (the "Software"), to deal in
+ *  the Software without restriction, including without limitation the rights to
+ *  use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ *  the Software, and to permit persons to whom the Software is furnished to do so,
+ *  subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ *  FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ *  COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ *  IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ *  CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+#ifndef POLICY_EVALUATOR_H
+#define POLICY_EVALUATOR_H
+
+
+#include "lmdp.h"
+#include "compiled_lmdp.h"
+#include "thread_pool.h"
+
+#include "../../librbr/librbr/include/core/policy/policy_map.h"
+
+#include <vector>
+#include <unordered_map>
+#include <utility>
+
+/**
+ * The method which solves for the values of a policy.
+ */
+enum PolicyEvaluationMethod {
+	POLICY_EVALUATION_SWEEPS,
+	POLICY_EVALUATION_BICGSTAB,
+	POLICY_EVALUATION_GMRES
+};
+
+/**
+ * The preconditioner of the Krylov policy evaluation methods.
+ */
+enum PolicyEvaluationPreconditioner {
+	POLICY_PRECONDITIONER_NONE,
+	POLICY_PRECONDITIONER_JACOBI,
+	POLICY_PRECONDITIONER_ILU0
+};
+
+/**
+ * The vectors of one Krylov solve, which keep their memory between solves.
+ */
+struct PolicyEvaluatorKrylov {
+	/**
+	 * The vectors of BiCGSTAB, each over the states.
+	 */
+	std::vector<double> r, rHat, p, pHat, v, sHat, t;
+
+	/**
+	 * The work vectors of GMRES, each over the states.
+	 */
+	std::vector<double> w, z;
+
+	/**
+	 * The orthonormal basis of the Krylov subspace of GMRES, one vector over the states for each
+	 * iteration before a restart, and one more.
+	 */
+	std::vector<std::vector<double> > basis;
+
+	/**
+	 * The Hessenberg matrix of GMRES, column by column.
+	 */
+	std::vector<std::vector<double> > H;
+
+	/**
+	 * The Givens rotations, the rotated right-hand side, and the coefficients of GMRES.
+	 */
+	std::vector<double> cs, sn, g, y;
+};
+
+/**
+ * Evaluate a fixed policy of a Lexicographic Markov Decision Process (LMDP) for all of its k
+ * rewards at once. The LMDP is compiled once; each policy then only selects the row of its action
+ * at every state, and the k value functions are found by parallel Jacobi sweeps over those rows.
+ * The reward weights are not used, so one compiled LMDP may evaluate the policies of any weighting.
+ *
+ * Alternatively, the values may be found by solving the sparse linear system (I - gamma T_pi) V_i = R_i
+ * with a preconditioned Krylov method, one right-hand side for each reward, in parallel over the
+ * rewards. This stops once the residual R_i + gamma T_pi V_i - V_i, which is exactly the change a
+ * sweep would make, is within the same convergence criterion as the sweeps.
+ */
+class PolicyEvaluator {
+public:
+	/**
+	 * The default constructor for the PolicyEvaluator class. The default tolerance is 0.001.
+	 */
+	PolicyEvaluator();
+
+	/**
+	 * A constructor for the PolicyEvaluator class which allows for the specification of the
+	 * convergence criterion (tolerance) and the number of threads.
+	 * @param	tolerance		The tolerance which determines convergence of the evaluation.
+	 * @param	numThreads		The number of threads used by each sweep, at least 1.
+	 */
+	PolicyEvaluator(double tolerance, unsigned int numThreads);
+
+	/**
+	 * The deconstructor for the PolicyEvaluator class.
+	 */
+	virtual ~PolicyEvaluator();
+
+	/**
+	 * Compile an LMDP for evaluation. This only needs to be called again if the LMDP's states,
+	 * actions, state transitions, or rewards change.
+	 * @param	lmdp					The LMDP whose policies will be evaluated.
+	 * @throw	StateException			The LMDP did not have a StatesMap states object.
+	 * @throw	ActionException			The LMDP did not have a ActionsMap actions object.
+	 * @throw	RewardException			The LMDP did not have a FactoredRewards rewards object of SASRewards.
+	 * @throw	CoreException			The LMDP had a finite horizon, or a discount factor of at least 1.
+	 */
+	void compile(LMDP *lmdp);
+
+	/**
+	 * Evaluate a policy of the compiled LMDP for each of its rewards.
+	 * @param	policy				The policy, which must define an action for every state.
+	 * @param	V					The values of the policy, one for each reward. This will be updated.
+	 * @throw	CoreException		No LMDP was compiled.
+	 * @throw	PolicyException		The policy did not define an action for a state.
+	 * @throw	ActionException		The policy's action was not one of the LMDP's actions.
+	 */
+	void evaluate(PolicyMap *policy, std::vector<std::unordered_map<State *, double> > &V);
+
+	/**
+	 * Evaluate a policy of an LMDP for each of its rewards, compiling the LMDP first if it is not
+	 * the one which was last compiled.
+	 * @param	lmdp				The LMDP.
+	 * @param	policy				The policy, which must define an action for every state.
+	 * @param	V					The values of the policy, one for each reward. This will be updated.
+	 * @throw	CoreException		The LMDP had a finite horizon, or a discount factor of at least 1.
+	 * @throw	PolicyException		The policy did not define an action for a state.
+	 */
+	void evaluate(LMDP *lmdp, PolicyMap *policy, std::vector<std::unordered_map<State *, double> > &V);
+
+	/**
+	 * Solve for the values of a policy for one reward over the states of a partition of a compiled
+	 * LMDP, with the values of all other states held fixed, as the sparse linear system
+	 * (I - gamma T_pi) V_i = R_i + gamma T_pi V_i^fixed over the partition. This uses GMRES if it is
+	 * the method, and BiCGSTAB otherwise, with the preconditioner, and does not need compile.
+	 * @param	lmdp					The compiled LMDP.
+	 * @param	i						The reward index.
+	 * @param	Pj						The partition over state indices.
+	 * @param	pij						The action of the policy at each state, indexed by its position in
+	 * 									the partition.
+	 * @param	Vi						The values of all states for the reward. Those of the partition are the
+	 * 									initial solution, and are updated only if the solve converged.
+	 * @param	convergenceCriterion	The largest residual at which to stop.
+	 * @return	True if the residual converged within the largest number of iterations, and false otherwise.
+	 */
+	bool evaluate_partition(const CompiledLMDP &lmdp, unsigned int i,
+			const std::vector<unsigned int> &Pj, const std::vector<unsigned int> &pij,
+			std::vector<double> &Vi, double convergenceCriterion);
+
+	/**
+	 * Get the values of the last evaluation, one for each reward, indexed by state index.
+	 * @return	The values of the last evaluation.
+	 */
+	const std::vector<std::vector<double> > &get_values() const;
+
+	/**
+	 * Get the compiled LMDP.
+	 * @return	The compiled LMDP.
+	 */
+	const CompiledLMDP &get_model() const;
+
+	/**
+	 * Set the tolerance which determines convergence of the evaluation.
+	 * @param	tolerance	The tolerance.
+	 */
+	void set_tolerance(double tolerance);
+
+	/**
+	 * Get the tolerance which determines convergence of the evaluation.
+	 * @return	The tolerance.
+	 */
+	double get_tolerance() const;
+
+	/**
+	 * Set the number of threads used by each sweep. Each sweep is a Jacobi update, so the
+	 * result is identical for any number of threads. The default is 1.
+	 * @param	numThreads		The number of threads, at least 1.
+	 */
+	void set_num_threads(unsigned int numThreads);
+
+	/**
+	 * Get the number of threads used by each sweep.
+	 * @return	The number of threads.
+	 */
+	unsigned int get_num_threads() const;
+
+	/**
+	 * Set the method which solves for the values of a policy. The default is sweeps.
+	 * @param	method	The method.
+	 */
+	void set_method(PolicyEvaluationMethod method);
+
+	/**
+	 * Get the method which solves for the values of a policy.
+	 * @return	The method.
+	 */
+	PolicyEvaluationMethod get_method() const;
+
+	/**
+	 * Set the preconditioner of the Krylov methods. The default is ILU(0).
+	 * @param	preconditioner	The preconditioner.
+	 */
+	void set_preconditioner(PolicyEvaluationPreconditioner preconditioner);
+
+	/**
+	 * Get the preconditioner of the Krylov methods.
+	 * @return	The preconditioner.
+	 */
+	PolicyEvaluationPreconditioner get_preconditioner() const;
+
+	/**
+	 * Set the number of iterations after which GMRES restarts. The default is 30.
+	 * @param	restart		The number of iterations, at least 1.
+	 */
+	void set_gmres_restart(unsigned int restart);
+
+	/**
+	 * Get the number of iterations after which GMRES restarts.
+	 * @return	The number of iterations.
+	 */
+	unsigned int get_gmres_restart() const;
+
+	/**
+	 * Set the largest number of iterations of the Krylov methods for each reward, and of the sweeps.
+	 * A reward which does not converge within them is finished with at most as many sweeps. The
+	 * default is 1000.
+	 * @param	iterations	The largest number of iterations.
+	 */
+	void set_max_iterations(unsigned int iterations);
+
+	/**
+	 * Get the largest number of iterations of the Krylov methods for each reward, and of the sweeps.
+	 * @return	The largest number of iterations.
+	 */
+	unsigned int get_max_iterations() const;
+
+	/**
+	 * Get the number of sweeps taken by the last evaluation, or for the Krylov methods, the most
+	 * iterations taken for any reward plus any sweeps which finished it.
+	 * @return	The number of sweeps.
+	 */
+	unsigned int get_num_sweeps() const;
+
+	/**
+	 * Get if the last evaluation converged, or stopped at the largest number of iterations instead.
+	 * @return	True if the last evaluation converged, and false otherwise.
+	 */
+	bool get_converged() const;
+
+protected:
+	/**
+	 * Restrict the compiled LMDP to the rows of the actions taken by a policy.
+	 * @param	policy				The policy.
+	 * @throw	PolicyException		The policy did not define an action for a state.
+	 * @throw	ActionException		The policy's action was not one of the LMDP's actions.
+	 */
+	void restrict_to_policy(PolicyMap *policy);
+
+	/**
+	 * Perform one Jacobi sweep over all states for all rewards, from values into valuesNext.
+	 * @return	The largest absolute change in value over all states and rewards.
+	 */
+	double compute_sweep();
+
+	/**
+	 * Iterate sweeps from the current values until they converge, or for at most the largest number
+	 * of iterations.
+	 * @param	convergenceCriterion	The largest change in value at which to stop.
+	 * @return	The number of sweeps.
+	 */
+	unsigned int compute_sweeps(double convergenceCriterion);
+
+	/**
+	 * Build the sparse matrix (I - gamma T_pi) of the policy, with sorted columns, and the
+	 * expected reward of each state for each reward, then factor the preconditioner.
+	 */
+	void compute_system();
+
+	/**
+	 * Sort and merge the entries of matrixRow, and append them to the matrix as row s.
+	 * @param	s	The index of the row, whose diagonal entry is recorded.
+	 */
+	void append_row(unsigned int s);
+
+	/**
+	 * Compute the preconditioner of the matrix.
+	 */
+	void compute_preconditioner();
+
+	/**
+	 * Compute y = (I - gamma T_pi) x.
+	 * @param	x	The vector to multiply.
+	 * @param	y	The product. This will be updated.
+	 */
+	void compute_product(const std::vector<double> &x, std::vector<double> &y) const;
+
+	/**
+	 * Compute the residual r = b - (I - gamma T_pi) x.
+	 * @param	b	The right-hand side.
+	 * @param	x	The current solution.
+	 * @param	r	The residual. This will be updated.
+	 * @return	The largest absolute value of the residual, or infinity if any of it is not finite.
+	 */
+	double compute_residual(const std::vector<double> &b, const std::vector<double> &x,
+			std::vector<double> &r) const;
+
+	/**
+	 * Apply the preconditioner, solving M z = r.
+	 * @param	r	The vector to precondition.
+	 * @param	z	The preconditioned vector. This will be updated.
+	 */
+	void compute_preconditioned(const std::vector<double> &r, std::vector<double> &z) const;
+
+	/**
+	 * Solve for the values of one reward with right-preconditioned BiCGSTAB. This gives up, returning
+	 * false, if the method breaks down with a zero or non-finite divisor.
+	 * @param	b						The right-hand side.
+	 * @param	x						The initial and final solution. This will be updated.
+	 * @param	convergenceCriterion	The largest residual at which to stop.
+	 * @param	iterations				The number of iterations taken. This will be updated.
+	 * @param	krylov					The vectors of the solve. This will be updated.
+	 * @return	True if the residual converged, and false otherwise.
+	 */
+	bool compute_bicgstab(const std::vector<double> &b, std::vector<double> &x,
+			double convergenceCriterion, unsigned int &iterations, PolicyEvaluatorKrylov &krylov) const;
+
+	/**
+	 * Solve for the values of one reward with right-preconditioned, restarted GMRES.
+	 * @param	b						The right-hand side.
+	 * @param	x						The initial and final solution. This will be updated.
+	 * @param	convergenceCriterion	The largest residual at which to stop.
+	 * @param	iterations				The number of iterations taken. This will be updated.
+	 * @param	krylov					The vectors of the solve. This will be updated.
+	 * @return	True if the residual converged, and false otherwise.
+	 */
+	bool compute_gmres(const std::vector<double> &b, std::vector<double> &x,
+			double convergenceCriterion, unsigned int &iterations, PolicyEvaluatorKrylov &krylov) const;
+
+	/**
+	 * The tolerance convergence criterion.
+	 */
+	double epsilon;
+
+	/**
+	 * The pool of threads which perform each sweep.
+	 */
+	ThreadPool *pool;
+
+	/**
+	 * The compiled LMDP.
+	 */
+	CompiledLMDP model;
+
+	/**
+	 * The LMDP which was last compiled, or nullptr if none was.
+	 */
+	LMDP *compiled;
+
+	/**
+	 * The row offsets of the policy's successors, an (n + 1) array.
+	 */
+	std::vector<unsigned int> policyRows;
+
+	/**
+	 * The successor state indices of the policy's action at each state.
+	 */
+	std::vector<unsigned int> policySuccessors;
+
+	/**
+	 * The state transition probabilities, parallel to the policy's successors.
+	 */
+	std::vector<double> policyProbabilities;
+
+	/**
+	 * The k expected rewards of the policy's action at each state, interleaved.
+	 */
+	std::vector<double> policyRewards;
+
+	/**
+	 * The values of all k rewards of each state, interleaved, as of the last sweep.
+	 */
+	std::vector<double> values;
+
+	/**
+	 * The values being computed by the current sweep, swapped with values after it.
+	 */
+	std::vector<double> valuesNext;
+
+	/**
+	 * The values of the last evaluation, one for each reward, indexed by state index.
+	 */
+	std::vector<std::vector<double> > result;
+
+	/**
+	 * The row offsets of the policy's matrix (I - gamma T_pi), an (n + 1) array.
+	 */
+	std::vector<unsigned int> matrixRows;
+
+	/**
+	 * The column of each entry of the matrix, sorted within each row.
+	 */
+	std::vector<unsigned int> matrixColumns;
+
+	/**
+	 * The value of each entry of the matrix.
+	 */
+	std::vector<double> matrixValues;
+
+	/**
+	 * The position of the diagonal entry of each row of the matrix.
+	 */
+	std::vector<unsigned int> matrixDiagonal;
+
+	/**
+	 * The expected reward of each state under the policy, one array for each reward.
+	 */
+	std::vector<std::vector<double> > expectedRewards;
+
+	/**
+	 * The entries of the matrix row being built, as pairs of column and value.
+	 */
+	std::vector<std::pair<unsigned int, double> > matrixRow;
+
+	/**
+	 * The position of each state in the partition of the last partition solve, or the partition's size.
+	 */
+	std::vector<unsigned int> partitionPositions;
+
+	/**
+	 * The values of the states in the partition of the last partition solve.
+	 */
+	std::vector<double> partitionValues;
+
+	/**
+	 * The preconditioner: the inverse diagonal for Jacobi, or the L and U factors in the matrix's
+	 * sparsity pattern for ILU(0).
+	 */
+	std::vector<double> preconditionerValues;
+
+	/**
+	 * The position of each column of the row being factored by ILU(0), or -1 if it is not in the row.
+	 */
+	std::vector<int> preconditionerPositions;
+
+	/**
+	 * The vectors of the Krylov solves, one for each thread.
+	 */
+	std::vector<PolicyEvaluatorKrylov> krylov;
+
+	/**
+	 * The method which solves for the values of a policy.
+	 */
+	PolicyEvaluationMethod method;
+
+	/**
+	 * The preconditioner of the Krylov methods.
+	 */
+	PolicyEvaluationPreconditioner preconditioner;
+
+	/**
+	 * The number of iterations after which GMRES restarts.
+	 */
+	unsigned int gmresRestart;
+
+	/**
+	 * The largest number of iterations of the Krylov methods for each reward.
+	 */
+	unsigned int maxIterations;
+
+	/**
+	 * The number of sweeps taken by the last evaluation.
+	 */
+	unsigned int sweeps;
+
+	/**
+	 * If the last evaluation converged.
+	 */
+	bool converged;
+
+};
+
+
+#endif // POLICY_EVALUATOR_H
@@ -0,0 +1,167 @@
+/**
+ *  The MIT License (MIT)
+ *
+ *  Copyright (c) 2014 Kyle Wray, University of Massachusetts
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy of
+ *  this software and associated documentation files (the "Software"), to deal in
+ *  the Software without restriction, including without limitation the rights to
+ *  use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ *  the Software, and to permit persons to whom the Software is furnished to do so,
+ *  subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ *  FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ *  COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ *  IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ *  CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+#ifndef THREAD_POOL_H
+#define THREAD_POOL_H
+
+
+#include <vector>
+#include <functional>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <exception>
+
+/**
+ * A fixed-size pool of worker threads which splits a range of indices into contiguous
+ * chunks, one for each worker, and runs a task over each chunk in parallel.
+ */
+class ThreadPool {
+public:
+	/**
+	 * The constructor for the ThreadPool class. The calling thread always acts as the
+	 * first worker, so numThreads - 1 threads are started.
+	 * @param	numThreads	The number of workers, at least 1.
+	 */
+	ThreadPool(unsigned int numThreads);
+
+	/**
+	 * The deconstructor for the ThreadPool class, which joins all of the threads.
+	 */
+	virtual ~ThreadPool();
+
+	/**
+	 * Run a task over the range [0, count), split into one contiguous chunk for each worker.
+	 * This blocks until every chunk has completed. Only one run may be active at a time. If
+	 * any chunk throws, the first exception is rethrown here once every chunk has completed.
+	 * @param	count	The number of indices in the range.
+	 * @param	task	The task, taking the worker's index and its [begin, end) chunk.
+	 */
+	void run(unsigned int count,
+			const std::function<void (unsigned int, unsigned int, unsigned int)> &task);
+
+	/**
+	 * Run a task over the range [0, count), as above. The task is wrapped by reference, so that
+	 * running a lambda with many captures does not allocate.
+	 * @param	count	The number of indices in the range.
+	 * @param	task	The task, taking the worker's index and its [begin, end) chunk.
+	 */
+	template <typename Task>
+	void run(unsigned int count, const Task &task)
+	{
+		run(count, std::function<void (unsigned int, unsigned int, unsigned int)>(std::cref(task)));
+	}
+
+	/**
+	 * Get the scratch values of a worker, which a task may use to keep its partial results. They
+	 * persist between runs, so that they are only allocated when they first grow.
+	 * @param	worker	The index of the worker.
+	 * @return	The scratch values of the worker.
+	 */
+	std::vector<double> &get_scratch(unsigned int worker);
+
+	/**
+	 * Get the number of workers, including the calling thread.
+	 * @return	The number of workers.
+	 */
+	unsigned int get_num_threads() const;
+
+private:
+	/**
+	 * The loop executed by each of the started threads.
+	 * @param	worker	The index of the worker, from 1 to numThreads - 1.
+	 */
+	void work(unsigned int worker);
+
+	/**
+	 * Run the chunk of the current task assigned to a worker, keeping the first exception
+	 * thrown by any chunk.
+	 * @param	worker	The index of the worker.
+	 */
+	void run_chunk(unsigned int worker);
+
+	/**
+	 * The number of workers, including the calling thread.
+	 */
+	unsigned int numThreads;
+
+	/**
+	 * The started threads.
+	 */
+	std::vector<std::thread> threads;
+
+	/**
+	 * The scratch values of each worker.
+	 */
+	std::vector<std::vector<double> > scratch;
+
+	/**
+	 * The mutex protecting the task state below.
+	 */
+	std::mutex mutex;
+
+	/**
+	 * Signals the threads that a new task (or shutdown) is available.
+	 */
+	std::condition_variable started;
+
+	/**
+	 * Signals the calling thread that all the threads have finished their chunks.
+	 */
+	std::condition_variable finished;
+
+	/**
+	 * The current task.
+	 */
+	const std::function<void (unsigned int, unsigned int, unsigned int)> *task;
+
+	/**
+	 * The number of indices in the current task's range.
+	 */
+	unsigned int count;
+
+	/**
+	 * Incremented for each new task, so that threads run each task exactly once.
+	 */
+	unsigned long generation;
+
+	/**
+	 * The number of threads which have not yet finished the current task.
+	 */
+	unsigned int remaining;
+
+	/**
+	 * If the threads should exit.
+	 */
+	bool stopping;
+
+	/**
+	 * The first exception thrown by a chunk of the current task, if any.
+	 */
+	std::exception_ptr error;
+
+};
+
+
+#endif // THREAD_POOL_H
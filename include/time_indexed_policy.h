@@ -0,0 +1,154 @@
+/**
+ *  The MIT License (MIT)
+ *
+ *  Copyright (c) 2014 Kyle Wray, University of Massachusetts
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy of
+ *  this software and associated documentation files (the "Software"), to deal in
+ *  the Software without restriction, including without limitation the rights to
+ *  use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ *  the Software, and to permit persons to whom the Software is furnished to do so,
+ *  subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ *  FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ *  COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ *  IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ *  CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+#ifndef TIME_INDEXED_POLICY_H
+#define TIME_INDEXED_POLICY_H
+
+
+#include "../../librbr/librbr/include/core/states/state.h"
+#include "../../librbr/librbr/include/core/actions/action.h"
+
+#include <vector>
+#include <unordered_map>
+
+/**
+ * A compact non-stationary policy over a finite horizon of H steps. Rather than an action for every
+ * state at every step, it stores for each state only the steps at which its action changes, i.e.,
+ * step 0 and each step whose action differs from the step before it. These change points are kept
+ * in compressed sparse row (CSR) form, sorted by step within each state, so the memory is O(n) plus
+ * the number of changes, and finding the action of a state at a step is a binary search.
+ */
+class TimeIndexedPolicy {
+public:
+	/**
+	 * The constructor for the TimeIndexedPolicy class.
+	 * @param	horizon		The number of steps, H.
+	 * @param	states		The states, in index order.
+	 * @param	actions		The actions, in index order.
+	 */
+	TimeIndexedPolicy(unsigned int horizon, const std::vector<State *> &states,
+			const std::vector<Action *> &actions);
+
+	/**
+	 * The deconstructor for the TimeIndexedPolicy class.
+	 */
+	virtual ~TimeIndexedPolicy();
+
+	/**
+	 * Record the actions of every state at a step. This must be called once for each step, in
+	 * backward order from H - 1 to 0, as backward induction computes them. Only the actions which
+	 * differ from those of the step after are kept, and the policy is complete once step 0 is recorded.
+	 * @param	t					The step.
+	 * @param	stepActions			The index of the action of each state at the step.
+	 * @throw	PolicyException		The steps were not recorded in backward order.
+	 */
+	void record(unsigned int t, const std::vector<unsigned int> &stepActions);
+
+	/**
+	 * Get the action of a state at a step.
+	 * @param	t					The step, from 0 to H - 1.
+	 * @param	state				The state.
+	 * @throw	PolicyException		The policy was not complete, the step was beyond the horizon,
+	 * 								or the state was not one of the states.
+	 * @return	The action.
+	 */
+	Action *get(unsigned int t, State *state) const;
+
+	/**
+	 * Get the index of the action of a state at a step.
+	 * @param	t					The step, from 0 to H - 1.
+	 * @param	s					The index of the state.
+	 * @throw	PolicyException		The policy was not complete, or the step was beyond the horizon.
+	 * @return	The index of the action.
+	 */
+	unsigned int get_action_index(unsigned int t, unsigned int s) const;
+
+	/**
+	 * Get the number of steps.
+	 * @return	The horizon, H.
+	 */
+	unsigned int get_horizon() const;
+
+	/**
+	 * Get the number of change points stored over all states, including step 0 of each state.
+	 * @return	The number of change points.
+	 */
+	unsigned int get_num_changes() const;
+
+protected:
+	/**
+	 * The number of steps.
+	 */
+	unsigned int horizon;
+
+	/**
+	 * The states, in index order.
+	 */
+	std::vector<State *> states;
+
+	/**
+	 * A mapping from each state to its index.
+	 */
+	std::unordered_map<State *, unsigned int> stateIndices;
+
+	/**
+	 * The actions, in index order.
+	 */
+	std::vector<Action *> actions;
+
+	/**
+	 * The row offsets of the change points, an (n + 1) array. The change points of state s are
+	 * found at [rows[s], rows[s + 1]). This is empty until the policy is complete.
+	 */
+	std::vector<unsigned int> rows;
+
+	/**
+	 * The step of each change point.
+	 */
+	std::vector<unsigned int> steps;
+
+	/**
+	 * The index of the action taken from each change point onward.
+	 */
+	std::vector<unsigned int> stepActions;
+
+	/**
+	 * The actions of the last step recorded.
+	 */
+	std::vector<unsigned int> next;
+
+	/**
+	 * The last step recorded, or H if none was.
+	 */
+	unsigned int nextStep;
+
+	/**
+	 * The change points recorded so far, as (state, step, action) in decreasing order of step.
+	 */
+	std::vector<unsigned int> pending;
+
+};
+
+
+#endif // TIME_INDEXED_POLICY_H
@@ -65,12 +65,13 @@ __global__ void lvi_bellman_update_v1(unsigned int n, unsigned int z, unsigned i
 			continue;
 		}
 
-		// Compute Q(s, a) for this action.
+		// Compute Q(s, a) for this action, from its expected reward.
 		Qsa = 0.0f;
 		for (int sp = 0; sp < n; sp++) {
 			k = Pj[s] * m * n + a * n + sp;
-			Qsa += T[k] * (Ri[k] + gamma * Vi[sp]);
+			Qsa += T[k] * Vi[sp];
 		}
+		Qsa = Ri[Pj[s] * m + a] + gamma * Qsa;
 
 		if (a == 0 || Qsa > ViPrime[Pj[s]]) {
 			ViPrime[Pj[s]] = Qsa;
@@ -109,12 +110,13 @@ __global__ void lvi_bellman_update_v2(unsigned int n, unsigned int z, unsigned i
 			continue;
 		}
 
-		// Compute Q(s, a) for this action.
+		// Compute Q(s, a) for this action, from its expected reward.
 		Qsa = 0.0f;
 		for (int sp = 0; sp < n; sp++) {
 			k = Pj[s] * m * n + a * n + sp;
-			Qsa += T[k] * (Ri[k] + gamma * Vi[sp]);
+			Qsa += T[k] * Vi[sp];
 		}
+		Qsa = Ri[Pj[s] * m + a] + gamma * Qsa;
 
 		if (a == 0 || Qsa > ViPrime[Pj[s]]) {
 			ViPrime[Pj[s]] = Qsa;
@@ -155,14 +157,14 @@ int lvi_initialize_rewards(unsigned int n, unsigned int m, const float *R, float
 	}
 
 	// Allocate the memory on the device.
-	if (cudaMalloc(&d_R, n * m * n * sizeof(float)) != cudaSuccess) {
+	if (cudaMalloc(&d_R, n * m * sizeof(float)) != cudaSuccess) {
 		fprintf(stderr, "Error[lvi_initialize_rewards]: %s",
 				"Failed to allocate device-side memory for the rewards.");
 		return -3;
 	}
 
 	// Copy the data from the host to the device.
-	if (cudaMemcpy(d_R, R, n * m * n * sizeof(float), cudaMemcpyHostToDevice) != cudaSuccess) {
+	if (cudaMemcpy(d_R, R, n * m * sizeof(float), cudaMemcpyHostToDevice) != cudaSuccess) {
 		fprintf(stderr, "Error[lvi_initialize_rewards]: %s",
 				"Failed to copy memory from host to device for the rewards.");
 		return -3;
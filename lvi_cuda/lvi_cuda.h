@@ -38,7 +38,7 @@
  * 						is available at that state or not.
  * @param	d_T			A mapping of state-action-state triples (n-m-n array) to a
  * 						transition probability. (Device-side pointer.)
- * @param	d_Ri			A mapping of state-action-state triples (n-m-n array) to a reward.
+ * @param	d_Ri			A mapping of state-action pairs (n-m array) to an expected reward.
  * 						(Device-side pointer.)
  * @param	d_Pj		The j-th partition, an array of z states. It is these states that will
  * 						be updated. (Device-side pointer.)
@@ -81,8 +81,8 @@ int lvi_initialize_state_transitions(unsigned int n, unsigned int m, const float
  * Initialize CUDA by transferring all of the constant MDP model information to the device.
  * @param	n			The number of states.
  * @param	m			The number of actions, in total, that are possible.
- * @param	R			A mapping of state-action-state triples (n-m-n array) to a reward.
- * @param	d_R			A mapping of state-action-state triples (n-m-n array) to a reward.
+ * @param	R			A mapping of state-action pairs (n-m array) to an expected reward.
+ * @param	d_R			A mapping of state-action pairs (n-m array) to an expected reward.
  * 						(Device-side pointer.)
  * @return	Returns 0 upon success; -1 if invalid arguments were passed; -3 if an error with
  * 			the CUDA functions arose.
@@ -122,7 +122,7 @@ int lvi_get_policy(unsigned int z, const unsigned int *d_pi, unsigned int *pi);
  * @param	d_T			A mapping of state-action-state triples (n-m-n array) to a
  * 						transition probability. (Device-side pointer.)
  * @param	k			The number of reward factors.
- * @param	d_R			A mapping of state-action-state triples (n-m-n array) to a reward.
+ * @param	d_R			A mapping of state-action pairs (n-m array) to an expected reward.
  * 						(Device-side pointer.)
  * @param	ell			The number of partitions.
  * @param	d_P			The j partitions, an array of z states. (Device-side pointer.)
@@ -0,0 +1,130 @@
+/**
+ *  The MIT License (MIT)
+ *
+ *  Copyright (c) 2014 Kyle Wray, University of Massachusetts
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy of
+ *  this software and associated documentation files (the "Software"), to deal in
+ *  the Software without restriction, including without limitation the rights to
+ *  use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ *  the Software, and to permit persons to whom the Software is furnished to do so,
+ *  subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ *  FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ *  COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ *  IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ *  CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+#include "../include/action_sets.h"
+
+#include <algorithm>
+
+ActionSets::ActionSets(unsigned int numActions)
+{
+	m = numActions;
+	words = std::max(1u, (m + 63) / 64);
+	scratch.resize(words);
+
+	clear();
+}
+
+ActionSets::~ActionSets()
+{ }
+
+void ActionSets::clear()
+{
+	masks.clear();
+	sizes.clear();
+	lookup.clear();
+
+	// The set of all actions is always first.
+	std::vector<uint64_t> full(words, 0);
+	for (unsigned int a = 0; a < m; a++) {
+		full[a / 64] |= (uint64_t)1 << (a % 64);
+	}
+	intern(full.data());
+}
+
+unsigned int ActionSets::intern(const uint64_t *mask)
+{
+	std::size_t hash = compute_hash(mask);
+
+	auto range = lookup.equal_range(hash);
+	for (auto it = range.first; it != range.second; it++) {
+		if (std::equal(mask, mask + words, masks.data() + (std::size_t)it->second * words)) {
+			return it->second;
+		}
+	}
+
+	unsigned int set = (unsigned int)sizes.size();
+
+	unsigned int size = 0;
+	for (unsigned int w = 0; w < words; w++) {
+		size += __builtin_popcountll(mask[w]);
+	}
+
+	masks.insert(masks.end(), mask, mask + words);
+	sizes.push_back(size);
+	lookup.insert(std::make_pair(hash, set));
+
+	return set;
+}
+
+const uint64_t *ActionSets::get(unsigned int set) const
+{
+	return masks.data() + (std::size_t)set * words;
+}
+
+uint64_t *ActionSets::copy(unsigned int set)
+{
+	std::copy(get(set), get(set) + words, scratch.begin());
+	return scratch.data();
+}
+
+unsigned int ActionSets::get_size(unsigned int set) const
+{
+	return sizes[set];
+}
+
+bool ActionSets::contains(unsigned int set, unsigned int a) const
+{
+	return (masks[(std::size_t)set * words + a / 64] >> (a % 64)) & 1;
+}
+
+unsigned int ActionSets::get_full() const
+{
+	return 0;
+}
+
+unsigned int ActionSets::get_num_sets() const
+{
+	return (unsigned int)sizes.size();
+}
+
+unsigned int ActionSets::get_num_actions() const
+{
+	return m;
+}
+
+unsigned int ActionSets::get_num_words() const
+{
+	return words;
+}
+
+std::size_t ActionSets::compute_hash(const uint64_t *mask) const
+{
+	// FNV-1a over the words.
+	uint64_t hash = 14695981039346656037ULL;
+	for (unsigned int w = 0; w < words; w++) {
+		hash ^= mask[w];
+		hash *= 1099511628211ULL;
+	}
+	return (std::size_t)hash;
+}
@@ -0,0 +1,259 @@
+/**
+ *  The MIT License (MIT)
+ *
+ *  Copyright (c) 2014 Kyle Wray, University of Massachusetts
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy of
+ *  this software and associated documentation files (the "Software"), to deal in
+ *  the Software without restriction, including without limitation the rights to
+ *  use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ *  the Software, and to permit persons to whom the Software is furnished to do so,
+ *  subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ *  FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ *  COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ *  IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ *  CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+#include "../include/bellman_kernels.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define BELLMAN_X86
+#endif
+
+static double bellman_backup_scalar(const unsigned int *successors, const double *T,
+		const double *V, unsigned int begin, unsigned int end)
+{
+	double Q = 0.0;
+	for (unsigned int t = begin; t < end; t++) {
+		Q += T[t] * V[successors[t]];
+	}
+	return Q;
+}
+
+static double bellman_backup_float_scalar(const unsigned int *successors, const float *T,
+		const float *V, unsigned int begin, unsigned int end)
+{
+	double Q = 0.0;
+	for (unsigned int t = begin; t < end; t++) {
+		Q += (double)T[t] * (double)V[successors[t]];
+	}
+	return Q;
+}
+
+#ifdef BELLMAN_X86
+
+// SSE4.2 has no gather, so two values at a time are loaded individually.
+
+__attribute__((target("sse4.2")))
+static double bellman_backup_sse42(const unsigned int *successors, const double *T,
+		const double *V, unsigned int begin, unsigned int end)
+{
+	__m128d sum = _mm_setzero_pd();
+
+	unsigned int t = begin;
+	for (; t + 2 <= end; t += 2) {
+		__m128d Vs = _mm_set_pd(V[successors[t + 1]], V[successors[t]]);
+		__m128d Ts = _mm_loadu_pd(T + t);
+		sum = _mm_add_pd(sum, _mm_mul_pd(Ts, Vs));
+	}
+
+	double Q = _mm_cvtsd_f64(_mm_add_sd(sum, _mm_unpackhi_pd(sum, sum)));
+	return Q + bellman_backup_scalar(successors, T, V, t, end);
+}
+
+__attribute__((target("sse4.2")))
+static double bellman_backup_float_sse42(const unsigned int *successors, const float *T,
+		const float *V, unsigned int begin, unsigned int end)
+{
+	__m128d sum = _mm_setzero_pd();
+
+	unsigned int t = begin;
+	for (; t + 2 <= end; t += 2) {
+		__m128d Vs = _mm_set_pd(V[successors[t + 1]], V[successors[t]]);
+		__m128d Ts = _mm_set_pd(T[t + 1], T[t]);
+		sum = _mm_add_pd(sum, _mm_mul_pd(Ts, Vs));
+	}
+
+	double Q = _mm_cvtsd_f64(_mm_add_sd(sum, _mm_unpackhi_pd(sum, sum)));
+	return Q + bellman_backup_float_scalar(successors, T, V, t, end);
+}
+
+// AVX2 gathers four values at a time at the successor indices.
+
+__attribute__((target("avx2,fma")))
+static double bellman_reduce_avx2(__m256d sum)
+{
+	__m128d half = _mm_add_pd(_mm256_castpd256_pd128(sum), _mm256_extractf128_pd(sum, 1));
+	return _mm_cvtsd_f64(_mm_add_sd(half, _mm_unpackhi_pd(half, half)));
+}
+
+__attribute__((target("avx2,fma")))
+static double bellman_backup_avx2(const unsigned int *successors, const double *T,
+		const double *V, unsigned int begin, unsigned int end)
+{
+	__m256d sum = _mm256_setzero_pd();
+	__m256d all = _mm256_castsi256_pd(_mm256_set1_epi64x(-1));
+
+	unsigned int t = begin;
+	for (; t + 4 <= end; t += 4) {
+		__m128i indices = _mm_loadu_si128((const __m128i *)(successors + t));
+		__m256d Vs = _mm256_mask_i32gather_pd(_mm256_setzero_pd(), V, indices, all, 8);
+		__m256d Ts = _mm256_loadu_pd(T + t);
+		sum = _mm256_fmadd_pd(Ts, Vs, sum);
+	}
+
+	return bellman_reduce_avx2(sum) + bellman_backup_scalar(successors, T, V, t, end);
+}
+
+__attribute__((target("avx2,fma")))
+static double bellman_backup_float_avx2(const unsigned int *successors, const float *T,
+		const float *V, unsigned int begin, unsigned int end)
+{
+	__m256d sum = _mm256_setzero_pd();
+	__m256d all = _mm256_castsi256_pd(_mm256_set1_epi64x(-1));
+
+	unsigned int t = begin;
+	for (; t + 4 <= end; t += 4) {
+		__m128i indices = _mm_loadu_si128((const __m128i *)(successors + t));
+		__m256d Vs = _mm256_cvtps_pd(_mm_mask_i32gather_ps(_mm_setzero_ps(), V, indices, _mm256_castps256_ps128(_mm256_castpd_ps(all)), 4));
+		__m256d Ts = _mm256_cvtps_pd(_mm_loadu_ps(T + t));
+		sum = _mm256_fmadd_pd(Ts, Vs, sum);
+	}
+
+	return bellman_reduce_avx2(sum) + bellman_backup_float_scalar(successors, T, V, t, end);
+}
+
+// AVX-512 gathers eight values at a time at the successor indices. The masked intrinsics are used
+// throughout, since the unmasked ones leave their unused source undefined.
+
+__attribute__((target("avx2,fma,avx512f")))
+static double bellman_reduce_avx512(__m512d sum)
+{
+	__m256d half = _mm256_add_pd(_mm512_maskz_extractf64x4_pd(0xF, sum, 0), _mm512_maskz_extractf64x4_pd(0xF, sum, 1));
+	return bellman_reduce_avx2(half);
+}
+
+__attribute__((target("avx2,fma,avx512f")))
+static double bellman_backup_avx512(const unsigned int *successors, const double *T,
+		const double *V, unsigned int begin, unsigned int end)
+{
+	__m512d sum = _mm512_setzero_pd();
+
+	unsigned int t = begin;
+	for (; t + 8 <= end; t += 8) {
+		__m256i indices = _mm256_loadu_si256((const __m256i *)(successors + t));
+		__m512d Vs = _mm512_mask_i32gather_pd(_mm512_setzero_pd(), 0xFF, indices, V, 8);
+		__m512d Ts = _mm512_loadu_pd(T + t);
+		sum = _mm512_fmadd_pd(Ts, Vs, sum);
+	}
+
+	// Rows are often shorter than eight, so the remainder still uses the four-wide kernel.
+	return bellman_reduce_avx512(sum) + bellman_backup_avx2(successors, T, V, t, end);
+}
+
+__attribute__((target("avx2,fma,avx512f")))
+static double bellman_backup_float_avx512(const unsigned int *successors, const float *T,
+		const float *V, unsigned int begin, unsigned int end)
+{
+	__m512d sum = _mm512_setzero_pd();
+	__m256 all = _mm256_castsi256_ps(_mm256_set1_epi32(-1));
+
+	unsigned int t = begin;
+	for (; t + 8 <= end; t += 8) {
+		__m256i indices = _mm256_loadu_si256((const __m256i *)(successors + t));
+		__m512d Vs = _mm512_maskz_cvtps_pd(0xFF, _mm256_mask_i32gather_ps(_mm256_setzero_ps(), V, indices, all, 4));
+		__m512d Ts = _mm512_maskz_cvtps_pd(0xFF, _mm256_loadu_ps(T + t));
+		sum = _mm512_fmadd_pd(Ts, Vs, sum);
+	}
+
+	return bellman_reduce_avx512(sum) + bellman_backup_float_avx2(successors, T, V, t, end);
+}
+
+#endif // BELLMAN_X86
+
+BellmanISA bellman_detect_isa()
+{
+#ifdef BELLMAN_X86
+	__builtin_cpu_init();
+
+	// The AVX-512 kernels finish their rows with the AVX2 kernels.
+	if (__builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma")) {
+		return BELLMAN_ISA_AVX512;
+	}
+	if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma")) {
+		return BELLMAN_ISA_AVX2;
+	}
+	if (__builtin_cpu_supports("sse4.2")) {
+		return BELLMAN_ISA_SSE42;
+	}
+#endif
+
+	return BELLMAN_ISA_SCALAR;
+}
+
+const char *bellman_isa_name(BellmanISA isa)
+{
+	switch (isa) {
+	case BELLMAN_ISA_SSE42:
+		return "SSE4.2";
+	case BELLMAN_ISA_AVX2:
+		return "AVX2";
+	case BELLMAN_ISA_AVX512:
+		return "AVX-512";
+	default:
+		return "scalar";
+	}
+}
+
+BellmanKernel bellman_select_kernel(BellmanISA &isa)
+{
+	BellmanISA supported = bellman_detect_isa();
+	if (isa > supported) {
+		isa = supported;
+	}
+
+	switch (isa) {
+#ifdef BELLMAN_X86
+	case BELLMAN_ISA_SSE42:
+		return bellman_backup_sse42;
+	case BELLMAN_ISA_AVX2:
+		return bellman_backup_avx2;
+	case BELLMAN_ISA_AVX512:
+		return bellman_backup_avx512;
+#endif
+	default:
+		isa = BELLMAN_ISA_SCALAR;
+		return bellman_backup_scalar;
+	}
+}
+
+BellmanKernelFloat bellman_select_kernel_float(BellmanISA &isa)
+{
+	BellmanISA supported = bellman_detect_isa();
+	if (isa > supported) {
+		isa = supported;
+	}
+
+	switch (isa) {
+#ifdef BELLMAN_X86
+	case BELLMAN_ISA_SSE42:
+		return bellman_backup_float_sse42;
+	case BELLMAN_ISA_AVX2:
+		return bellman_backup_float_avx2;
+	case BELLMAN_ISA_AVX512:
+		return bellman_backup_float_avx512;
+#endif
+	default:
+		isa = BELLMAN_ISA_SCALAR;
+		return bellman_backup_float_scalar;
+	}
+}
@@ -0,0 +1,334 @@
+/**
+ *  The MIT License (MIT)
+ *
+ *  Copyright (c) 2014 Kyle Wray, University of Massachusetts
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy of
+ *  this software and associated documentation files (the "Software"), to deal in
+ *  the Software without restriction, including without limitation the rights to
+ *  use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ *  the Software, and to permit persons to whom the Software is furnished to do so,
+ *  subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ *  FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ *  COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ *  IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ *  CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+#include "../include/compiled_lmdp.h"
+
+#include "../../librbr/librbr/include/core/rewards/sas_rewards.h"
+
+#include "../../librbr/librbr/include/core/states/state_exception.h"
+#include "../../librbr/librbr/include/core/actions/action_exception.h"
+#include "../../librbr/librbr/include/core/state_transitions/state_transition_exception.h"
+#include "../../librbr/librbr/include/core/rewards/reward_exception.h"
+
+#include <algorithm>
+
+CompiledLMDP::CompiledLMDP()
+{
+	n = 0;
+	m = 0;
+	k = 0;
+	gamma = 0.0;
+}
+
+CompiledLMDP::~CompiledLMDP()
+{ }
+
+void CompiledLMDP::compile(StatesMap *S, ActionsMap *A, StateTransitions *T, FactoredRewards *R, Horizon *h)
+{
+	n = S->get_num_states();
+	m = A->get_num_actions();
+	k = R->get_num_rewards();
+	gamma = h->get_discount_factor();
+
+	// Number the states and actions in the order they are iterated.
+	states.clear();
+	states.reserve(n);
+	stateIndices.clear();
+	stateIndices.reserve(n);
+
+	for (auto state : *S) {
+		State *s = resolve(state);
+		stateIndices[s] = (unsigned int)states.size();
+		states.push_back(s);
+	}
+
+	actions.clear();
+	actions.reserve(m);
+	actionIndices.clear();
+	actionIndices.reserve(m);
+
+	for (auto action : *A) {
+		Action *a = resolve(action);
+		actionIndices[a] = (unsigned int)actions.size();
+		actions.push_back(a);
+	}
+
+	// Ensure that each of the rewards is a state-action-state reward.
+	std::vector<SASRewards *> factors;
+	for (int i = 0; i < (int)k; i++) {
+		SASRewards *Ri = dynamic_cast<SASRewards *>(R->get(i));
+		if (Ri == nullptr) {
+			throw RewardException();
+		}
+		factors.push_back(Ri);
+	}
+
+	rows.clear();
+	rows.reserve(n * m + 1);
+	successors.clear();
+	probabilities.clear();
+
+	expectedRewards.clear();
+	expectedRewards.resize(k, std::vector<double>((size_t)n * m, 0.0));
+
+	probabilitiesSingle.clear();
+	expectedRewardsSingle.clear();
+	expectedRewardsInterleaved.clear();
+
+	// Walk the successors of each state-action pair exactly once. Successors with zero probability
+	// contribute nothing to a Bellman update, so they are not stored. The rewards of the successors
+	// are only needed for their expectation, so they are accumulated instead.
+	for (int s = 0; s < (int)n; s++) {
+		for (int a = 0; a < (int)m; a++) {
+			unsigned int row = s * m + a;
+			rows.push_back((unsigned int)successors.size());
+
+			for (State *sPrime : T->successors(S, states[s], actions[a])) {
+				double p = T->get(states[s], actions[a], sPrime);
+				if (p == 0.0) {
+					continue;
+				}
+
+				std::unordered_map<State *, unsigned int>::const_iterator sPrimeIterator = stateIndices.find(sPrime);
+				if (sPrimeIterator == stateIndices.end()) {
+					throw StateTransitionException();
+				}
+
+				successors.push_back(sPrimeIterator->second);
+				probabilities.push_back(p);
+
+				for (int i = 0; i < (int)k; i++) {
+					expectedRewards[i][row] += p * factors[i]->get(states[s], actions[a], sPrime);
+				}
+			}
+		}
+	}
+	rows.push_back((unsigned int)successors.size());
+
+	// The predecessors are only compiled for the solvers which ask for them.
+	predecessorRows.clear();
+	predecessors.clear();
+	predecessorProbabilities.clear();
+
+	Rmin.clear();
+	Rmax.clear();
+	for (int i = 0; i < (int)k; i++) {
+		Rmin.push_back(factors[i]->get_min());
+		Rmax.push_back(factors[i]->get_max());
+	}
+}
+
+void CompiledLMDP::compile_single_precision()
+{
+	probabilitiesSingle.assign(probabilities.begin(), probabilities.end());
+
+	expectedRewardsSingle.resize(k);
+	for (int i = 0; i < (int)k; i++) {
+		expectedRewardsSingle[i].assign(expectedRewards[i].begin(), expectedRewards[i].end());
+	}
+}
+
+void CompiledLMDP::compile_interleaved_rewards()
+{
+	expectedRewardsInterleaved.resize((size_t)n * m * k);
+
+	for (unsigned int row = 0; row < n * m; row++) {
+		for (int i = 0; i < (int)k; i++) {
+			expectedRewardsInterleaved[(size_t)row * k + i] = expectedRewards[i][row];
+		}
+	}
+}
+
+void CompiledLMDP::compile_predecessors()
+{
+	if (!predecessorRows.empty()) {
+		return;
+	}
+
+	// For each state s', find the maximal probability of reaching it from each state s, over all actions.
+	std::vector<std::unordered_map<unsigned int, double> > reverse(n);
+	for (int s = 0; s < (int)n; s++) {
+		for (unsigned int t = rows[s * m]; t < rows[(s + 1) * m]; t++) {
+			double &p = reverse[successors[t]][s];
+			p = std::max(p, probabilities[t]);
+		}
+	}
+
+	predecessorRows.clear();
+	predecessorRows.reserve(n + 1);
+	predecessors.clear();
+	predecessors.reserve(successors.size());
+	predecessorProbabilities.clear();
+	predecessorProbabilities.reserve(successors.size());
+
+	for (int sPrime = 0; sPrime < (int)n; sPrime++) {
+		predecessorRows.push_back((unsigned int)predecessors.size());
+
+		// Store the predecessors in index order, so that the result does not depend on hashing.
+		std::vector<std::pair<unsigned int, double> > sorted(reverse[sPrime].begin(), reverse[sPrime].end());
+		std::sort(sorted.begin(), sorted.end());
+
+		for (const std::pair<unsigned int, double> &predecessor : sorted) {
+			predecessors.push_back(predecessor.first);
+			predecessorProbabilities.push_back(predecessor.second);
+		}
+	}
+	predecessorRows.push_back((unsigned int)predecessors.size());
+}
+
+void CompiledLMDP::convert_partitions(const std::vector<std::vector<State *> > &P,
+		std::vector<std::vector<unsigned int> > &result) const
+{
+	result.clear();
+	result.resize(P.size());
+
+	for (int j = 0; j < (int)P.size(); j++) {
+		result[j].reserve(P[j].size());
+		for (State *s : P[j]) {
+			result[j].push_back(get_state_index(s));
+		}
+	}
+}
+
+void CompiledLMDP::convert_values(const std::vector<std::vector<double> > &values,
+		std::vector<std::unordered_map<State *, double> > &result) const
+{
+	result.clear();
+	result.resize(values.size());
+
+	for (int i = 0; i < (int)values.size(); i++) {
+		result[i].reserve(n);
+		for (int s = 0; s < (int)n; s++) {
+			result[i][states[s]] = values[i][s];
+		}
+	}
+}
+
+unsigned int CompiledLMDP::get_num_states() const
+{
+	return n;
+}
+
+unsigned int CompiledLMDP::get_num_actions() const
+{
+	return m;
+}
+
+unsigned int CompiledLMDP::get_num_rewards() const
+{
+	return k;
+}
+
+double CompiledLMDP::get_discount_factor() const
+{
+	return gamma;
+}
+
+State *CompiledLMDP::get_state(unsigned int s) const
+{
+	return states[s];
+}
+
+unsigned int CompiledLMDP::get_state_index(State *state) const
+{
+	std::unordered_map<State *, unsigned int>::const_iterator stateIterator = stateIndices.find(state);
+	if (stateIterator == stateIndices.end()) {
+		throw StateException();
+	}
+	return stateIterator->second;
+}
+
+Action *CompiledLMDP::get_action(unsigned int a) const
+{
+	return actions[a];
+}
+
+unsigned int CompiledLMDP::get_action_index(Action *action) const
+{
+	std::unordered_map<Action *, unsigned int>::const_iterator actionIterator = actionIndices.find(action);
+	if (actionIterator == actionIndices.end()) {
+		throw ActionException();
+	}
+	return actionIterator->second;
+}
+
+const std::vector<unsigned int> &CompiledLMDP::get_rows() const
+{
+	return rows;
+}
+
+const std::vector<unsigned int> &CompiledLMDP::get_successors() const
+{
+	return successors;
+}
+
+const std::vector<double> &CompiledLMDP::get_probabilities() const
+{
+	return probabilities;
+}
+
+const std::vector<double> &CompiledLMDP::get_expected_rewards(unsigned int i) const
+{
+	return expectedRewards[i];
+}
+
+const std::vector<float> &CompiledLMDP::get_probabilities_single() const
+{
+	return probabilitiesSingle;
+}
+
+const std::vector<float> &CompiledLMDP::get_expected_rewards_single(unsigned int i) const
+{
+	return expectedRewardsSingle[i];
+}
+
+const std::vector<double> &CompiledLMDP::get_expected_rewards_interleaved() const
+{
+	return expectedRewardsInterleaved;
+}
+
+const std::vector<unsigned int> &CompiledLMDP::get_predecessor_rows() const
+{
+	return predecessorRows;
+}
+
+const std::vector<unsigned int> &CompiledLMDP::get_predecessors() const
+{
+	return predecessors;
+}
+
+const std::vector<double> &CompiledLMDP::get_predecessor_probabilities() const
+{
+	return predecessorProbabilities;
+}
+
+double CompiledLMDP::get_min(unsigned int i) const
+{
+	return Rmin[i];
+}
+
+double CompiledLMDP::get_max(unsigned int i) const
+{
+	return Rmax[i];
+}
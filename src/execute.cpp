@@ -27,9 +27,10 @@
 
 #include "../include/lvi.h"
 #include "../include/lvi_cuda.h"
+#include "../include/lpi.h"
+#include "../include/policy_evaluator.h"
 
 #include "../../librbr/librbr/include/mdp/mdp_value_iteration.h"
-#include "../../librbr/librbr/include/mdp/mdp_utilities.h"
 
 #include "../../losm/losm/include/losm_exception.h"
 
@@ -46,16 +47,30 @@
 
 #include <iostream>
 #include <unordered_map>
+#include <string>
 
 #include <chrono>
+#include <thread>
 
 int main(int argc, char *argv[])
 {
 	bool losmVersion = true;
 	bool viWeightCheck = true;
 	bool cudaVersion = true;
+	bool lpiVersion = false;
 	bool printGrid = false;
 
+	// An optional '--lpi' argument, anywhere on the command line, solves with LPI instead of LVI.
+	int remaining = 0;
+	for (int i = 0; i < argc; i++) {
+		if (i > 0 && std::string(argv[i]) == "--lpi") {
+			lpiVersion = true;
+		} else {
+			argv[remaining++] = argv[i];
+		}
+	}
+	argc = remaining;
+
 	//* Export the raw LMDP file.
 	LOSMMDP losmMDPForRawFile(argv[1], argv[2], argv[3], argv[6], argv[7]);
 	RawFile rawFile;
@@ -66,7 +81,7 @@ int main(int argc, char *argv[])
 	if (losmVersion) {
 		// Ensure the correct number of arguments.
 		if (argc != 9) {
-			std::cerr << "Please specify nodes, edges, and landmarks data files, as well as the initial and goal nodes' UIDs, plus the policy output file." << std::endl;
+			std::cerr << "Please specify nodes, edges, and landmarks data files, as well as the initial and goal nodes' UIDs, plus the policy output file (and optionally '--lpi')." << std::endl;
 			return -1;
 		}
 
@@ -87,8 +102,12 @@ int main(int argc, char *argv[])
 		// Solve the LOSM MDP using LVI.
 		PolicyMap *policy = nullptr;
 
-		//* Execute either the CUDA version or the CPU version of LVI.
-		if (cudaVersion) {
+		//* Execute either LPI, the CUDA version, or the CPU version of LVI.
+		if (lpiVersion) {
+			LPI solver(0.0001, 0);
+			policy = solver.solve(losmMDP);
+			losmMDP->save_policy(policy, argv[8], solver.get_V());
+		} else if (cudaVersion) {
 			LVICuda solver(0.0001);
 			policy = solver.solve(losmMDP);
 			losmMDP->save_policy(policy, argv[8], solver.get_V());
@@ -116,15 +135,11 @@ int main(int argc, char *argv[])
 
 		std::vector<std::unordered_map<State *, double> > V;
 
+		// Compile the LMDP once for all of the policy evaluations below; the reward weights do not affect it.
+		PolicyEvaluator evaluator(0.0001, std::thread::hardware_concurrency());
+
 		if (viWeightCheck) {
-			compute_V_pi(dynamic_cast<StatesMap *>(losmMDP->get_states()),
-							dynamic_cast<ActionsMap *>(losmMDP->get_actions()),
-							losmMDP->get_state_transitions(),
-							dynamic_cast<FactoredRewards *>(losmMDP->get_rewards()),
-							losmMDP->get_horizon(),
-							0.0001,
-							policy,
-							V);
+			evaluator.evaluate(losmMDP, policy, V);
 
 			// Saving it with this V means the actual value of the policy: V^\pi, versus V^\eta ('solver.get_V()').
 			losmMDP->save_policy(policy, argv[8], V);
@@ -154,14 +169,7 @@ int main(int argc, char *argv[])
 				MDPValueIteration viSolver(0.0001);
 				PolicyMap *viPolicy = viSolver.solve(losmMDP);
 
-				compute_V_pi(dynamic_cast<StatesMap *>(losmMDP->get_states()),
-							dynamic_cast<ActionsMap *>(losmMDP->get_actions()),
-							losmMDP->get_state_transitions(),
-							dynamic_cast<FactoredRewards *>(losmMDP->get_rewards()),
-							losmMDP->get_horizon(),
-							0.0001,
-							viPolicy,
-							V);
+				evaluator.evaluate(losmMDP, viPolicy, V);
 
 				std::cout << "Weight: [" << weight << ", " << oneMinusWeight << "]: ";
 				std::cout << V.at(0).at(initialState) << ", ";
@@ -189,7 +197,10 @@ int main(int argc, char *argv[])
 
 		PolicyMap *policy = nullptr;
 
-		if (cudaVersion) {
+		if (lpiVersion) {
+			LPI solver(0.0001, 0);
+			policy = solver.solve(gridLMDP);
+		} else if (cudaVersion) {
 			LVICuda solver(0.0001);
 			policy = solver.solve(gridLMDP);
 		} else {
@@ -203,15 +214,11 @@ int main(int argc, char *argv[])
 
 		std::vector<std::unordered_map<State *, double> > V;
 
+		// Compile the LMDP once for all of the policy evaluations below; the reward weights do not affect it.
+		PolicyEvaluator evaluator(0.0001, std::thread::hardware_concurrency());
+
 		if (viWeightCheck) {
-			compute_V_pi(dynamic_cast<StatesMap *>(gridLMDP->get_states()),
-							dynamic_cast<ActionsMap *>(gridLMDP->get_actions()),
-							gridLMDP->get_state_transitions(),
-							dynamic_cast<FactoredRewards *>(gridLMDP->get_rewards()),
-							gridLMDP->get_horizon(),
-							0.0001,
-							policy,
-							V);
+			evaluator.evaluate(gridLMDP, policy, V);
 
 			// Output the initial state's value for this policy.
 			std::cout << "Initial State Value for LVI: ";
@@ -236,14 +243,7 @@ int main(int argc, char *argv[])
 				MDPValueIteration viSolver(0.0001);
 				PolicyMap *viPolicy = viSolver.solve(gridLMDP);
 
-				compute_V_pi(dynamic_cast<StatesMap *>(gridLMDP->get_states()),
-							dynamic_cast<ActionsMap *>(gridLMDP->get_actions()),
-							gridLMDP->get_state_transitions(),
-							dynamic_cast<FactoredRewards *>(gridLMDP->get_rewards()),
-							gridLMDP->get_horizon(),
-							0.0001,
-							viPolicy,
-							V);
+				evaluator.evaluate(gridLMDP, viPolicy, V);
 
 				std::cout << "Weight: [" << weight << ", " << (1.0 - weight) << "]: ";
 				std::cout << V.at(0).at(initialState) << ", ";
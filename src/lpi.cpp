@@ -0,0 +1,283 @@
+/**
+ *  The MIT License (MIT)
+ *
+ *  Copyright (c) 2014 Kyle Wray, University of Massachusetts
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy of
+ *  this software and associated documentation files (the "Software"), to deal in
+ *  the Software without restriction, including without limitation the rights to
+ *  use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ *  the Software, and to permit persons to whom the Software is furnished to do so,
+ *  subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ *  FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ *  COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ *  IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ *  CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+#include "../include/lpi.h"
+
+#include <cmath>
+#include <algorithm>
+#include <memory>
+
+LPI::LPI() : LVI()
+{
+	loopingVersion = true;
+	evaluationSteps = 0;
+	improvements = 0;
+	evaluationIterations = 0;
+}
+
+LPI::LPI(double tolerance, unsigned int steps) : LVI(tolerance, true)
+{
+	evaluationSteps = steps;
+	improvements = 0;
+	evaluationIterations = 0;
+}
+
+LPI::~LPI()
+{
+	for (PolicyEvaluator *evaluator : evaluators) {
+		delete evaluator;
+	}
+}
+
+void LPI::set_evaluation_steps(unsigned int steps)
+{
+	evaluationSteps = steps;
+}
+
+unsigned int LPI::get_evaluation_steps() const
+{
+	return evaluationSteps;
+}
+
+unsigned int LPI::get_num_improvements() const
+{
+	return improvements;
+}
+
+unsigned long long LPI::get_num_evaluation_iterations() const
+{
+	return evaluationIterations;
+}
+
+PolicyMap *LPI::solve_infinite_horizon(StatesMap *S, ActionsMap *A,
+		StateTransitions *T, FactoredRewards *R, Horizon *h,
+		std::vector<float> &delta,
+		std::vector<std::vector<State *> > &P,
+		std::vector<std::vector<unsigned int> > &o)
+{
+	improvements = 0;
+	evaluationIterations = 0;
+
+	// Each partition gets its own evaluator, which keeps its buffers between outer iterations.
+	while (evaluators.size() < P.size()) {
+		evaluators.push_back(new PolicyEvaluator());
+	}
+
+	return LVI::solve_infinite_horizon(S, A, T, R, h, delta, P, o);
+}
+
+bool LPI::is_interval() const
+{
+	return false;
+}
+
+void LPI::compute_partition(std::vector<float> &delta,
+		std::vector<unsigned int> &Pj, std::vector<unsigned int> &oj,
+		std::vector<std::vector<double> > &VFixed,
+		std::vector<std::vector<double> > &values,
+		std::vector<unsigned int> &pi, std::vector<double> &maxDifference,
+		ThreadPool *threads)
+{
+	unsigned int k = model.get_num_rewards();
+	double gamma = model.get_discount_factor();
+
+	// The buffers of this partition keep their memory between outer iterations.
+	std::unique_ptr<LVIPartitionWorkspace> temporary;
+	LVIPartitionWorkspace *scratch = get_partition_workspace(Pj, temporary);
+
+	// The value of the states, one for each reward.
+	std::vector<std::vector<double> > &VPrime = scratch->VPrime;
+
+	// Compute the convergence criterion which follows from the proof of convergence.
+	double convergenceCriterion = epsilon * std::max(0.1, (1.0 - gamma) / gamma);
+
+	// The sets of actions, interned so that states with the same set of actions share it.
+	ActionSets &sets = scratch->sets;
+
+	// Remember the set of actions available to each of the value functions, indexed by the position of
+	// each state in the partition. This will be computed at the end of each step. The initial set of
+	// actions for i = 1 is all of them.
+	std::vector<std::vector<unsigned int> > &AStar = scratch->AStar;
+	for (int i = 0; i < (int)k; i++) {
+		std::fill(AStar[i].begin(), AStar[i].end(), sets.get_full());
+	}
+
+	// Exact policy evaluation stops at a residual which keeps the values within the convergence criterion
+	// of the policy's. A partition which is not part of the current solve gets an evaluator of its own.
+	double residualCriterion = (1.0 - gamma) * convergenceCriterion;
+
+	std::unique_ptr<PolicyEvaluator> temporaryEvaluator;
+	PolicyEvaluator *evaluator = nullptr;
+	if (evaluationSteps == 0) {
+		std::unordered_map<const std::vector<unsigned int> *, unsigned int>::const_iterator j = partitionIndices.find(&Pj);
+		if (j != partitionIndices.end() && j->second < evaluators.size()) {
+			evaluator = evaluators[j->second];
+		} else {
+			temporaryEvaluator.reset(new PolicyEvaluator());
+			evaluator = temporaryEvaluator.get();
+		}
+	}
+
+	// The scratch values for a sweep, the policy's actions, and the actions of the previous policy,
+	// indexed by the position of each state in the partition.
+	std::vector<double> &Vi = scratch->Vi;
+	std::vector<unsigned int> &pij = scratch->pij;
+	std::vector<unsigned int> &previous = scratch->previous;
+
+	// For each of the value functions, we will compute the actions set.
+	for (int i = 0; i < (int)k; i++) {
+		// Setup V[i] with the values from the previous outer step which the sweeps read.
+		copy_fixed_values(*scratch, Pj, VFixed[oj[i]], VPrime[oj[i]]);
+
+		unsigned int sweep = 0;
+		unsigned int improvement = 0;
+		unsigned long long iterations = 0;
+
+		// The initial policy is greedy with respect to the previous outer step's values.
+		double difference = compute_sweep(sets, AStar[oj[i]], oj[i], Pj, VPrime[oj[i]], Vi, pij, threads, sweep);
+		sweep++;
+
+		while (difference > convergenceCriterion && !should_stop()) {
+			// Evaluate the policy, either exactly or with a fixed number of sweeps. Should the linear solve
+			// not converge, sweeps finish the evaluation from the current values.
+			bool solved = false;
+			if (evaluationSteps == 0) {
+				solved = evaluator->evaluate_partition(model, oj[i], Pj, pij, VPrime[oj[i]], residualCriterion);
+				iterations += evaluator->get_num_sweeps();
+			}
+
+			double evaluationDifference = convergenceCriterion + 1.0;
+			for (unsigned int step = 0;
+					(evaluationSteps == 0 && !solved && evaluationDifference > residualCriterion) || step < evaluationSteps;
+					step++) {
+				evaluationDifference = compute_evaluation_sweep(oj[i], Pj, pij, VPrime[oj[i]], Vi, threads, sweep);
+				sweep++;
+			}
+
+			// Improve the policy greedily over the actions within slack. This is also a Bellman backup,
+			// so its difference bounds the distance to the optimal values.
+			previous = pij;
+			difference = compute_sweep(sets, AStar[oj[i]], oj[i], Pj, VPrime[oj[i]], Vi, pij, threads, sweep);
+			sweep++;
+			improvement++;
+
+			// With exact evaluation, an unchanged policy is optimal up to the tolerance.
+			if (evaluationSteps == 0 && pij == previous) {
+				break;
+			}
+		}
+
+		// Store the action taken as part of the policy. The partitions are disjoint, so only recording
+		// the sweeps needs the lock.
+		for (int s = 0; s < (int)Pj.size(); s++) {
+			pi[Pj[s]] = pij[s];
+		}
+
+		{
+			std::lock_guard<std::mutex> lock(partitionsMutex);
+			sweeps[oj[i]] += sweep;
+			backups += (unsigned long long)sweep * Pj.size();
+			improvements += improvement;
+			evaluationIterations += iterations;
+			record_level(Pj, oj[i], sweep, sets, AStar[oj[i]]);
+		}
+
+		// After everything, we can finally compute the set of actions ***for i + 1*** with the delta slack.
+		if (i != (int)k - 1) {
+			for (int s = 0; s < (int)Pj.size(); s++) {
+				// Use the delta function to compute the final set of AStar[i + 1].
+				compute_A_delta(sets, AStar[oj[i]][s], oj[i], Pj[s], VPrime[oj[i]], delta[oj[i]], scratch->Qi[s], AStar[oj[i + 1]][s]);
+			}
+		}
+
+		// Copy the final results for these states.
+		for (unsigned int s : Pj) {
+			values[oj[i]][s] = VPrime[oj[i]][s];
+		}
+	}
+
+	// Update the maximum difference found over all partitions after the subset
+	// of states have had PI executed. This does not follow the ordering.
+	for (int i = 0; i < (int)k; i++) {
+		for (unsigned int s : Pj) {
+			if (std::fabs(VPrime[i][s] - VFixed[i][s]) > maxDifference[i]) {
+				maxDifference[i] = std::fabs(VPrime[i][s] - VFixed[i][s]);
+			}
+		}
+	}
+}
+
+double LPI::compute_evaluation_sweep(unsigned int i, const std::vector<unsigned int> &Pj,
+		const std::vector<unsigned int> &pij, std::vector<double> &Vi,
+		std::vector<double> &ViNext, ThreadPool *threads, unsigned int sweep)
+{
+	double difference = 0.0;
+
+	if (!gaussSeidel) {
+		// Each thread keeps its maximal difference in its scratch, so that no buffer is allocated per sweep.
+		threads->run(Pj.size(), [&](unsigned int worker, unsigned int begin, unsigned int end) {
+			double workerDifference = 0.0;
+
+			for (unsigned int s = begin; s < end; s++) {
+				ViNext[s] = compute_Q(i, Pj[s], pij[s], Vi);
+
+				if (std::fabs(Vi[Pj[s]] - ViNext[s]) > workerDifference) {
+					workerDifference = std::fabs(Vi[Pj[s]] - ViNext[s]);
+				}
+			}
+
+			threads->get_scratch(worker).assign(1, workerDifference);
+		});
+
+		for (unsigned int worker = 0; worker < threads->get_num_threads(); worker++) {
+			difference = std::max(difference, threads->get_scratch(worker)[0]);
+		}
+
+		for (int s = 0; s < (int)Pj.size(); s++) {
+			Vi[Pj[s]] = ViNext[s];
+		}
+	} else {
+		bool backward = (visitOrder == LVI_VISIT_BACKWARD ||
+				(visitOrder == LVI_VISIT_ALTERNATING && sweep % 2 == 1));
+
+		// Update the values in place, in the visit order, with over-relaxation if requested.
+		for (int q = 0; q < (int)Pj.size(); q++) {
+			int s = backward ? (int)Pj.size() - 1 - q : q;
+
+			double Vis = compute_Q(i, Pj[s], pij[s], Vi);
+
+			if (relaxation != 1.0) {
+				Vis = Vi[Pj[s]] + relaxation * (Vis - Vi[Pj[s]]);
+			}
+
+			if (std::fabs(Vi[Pj[s]] - Vis) > difference) {
+				difference = std::fabs(Vi[Pj[s]] - Vis);
+			}
+
+			Vi[Pj[s]] = Vis;
+		}
+	}
+
+	return difference;
+}
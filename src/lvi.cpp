@@ -47,511 +47,2453 @@
 #include <math.h>
 #include <vector>
 #include <unordered_map>
+#include <unordered_set>
 #include <algorithm>
 
 #include <chrono>
+#include <thread>
+#include <fstream>
+#include <sstream>
+#include <limits>
+#include <memory>
 
 LVI::LVI()
 {
 	epsilon = 0.001;
 	loopingVersion = false;
+	pool = new ThreadPool(1);
+	concurrentPartitions = false;
+	partitionRunner = nullptr;
+	gaussSeidel = false;
+	relaxation = 1.0;
+	visitOrder = LVI_VISIT_FORWARD;
+	fusedPruning = false;
+	fusedBackups = false;
+	policyEvaluation = false;
+	resumeValues = false;
+	telemetry = &nullTelemetry;
+	stopRequested = false;
+	deadline = std::numeric_limits<std::chrono::steady_clock::rep>::max();
+	residual = std::numeric_limits<double>::max();
+	discountFactor = 0.0;
+	converged = false;
+	actionElimination = false;
+	eliminations = 0;
+	intervalBounds = false;
+	intervalGap = std::numeric_limits<double>::max();
+	intervalClosed = false;
+	andersonDepth = 0;
+	andersonAccepted = 0;
+	andersonRejected = 0;
+	bellmanISA = BELLMAN_ISA_SCALAR;
+	bellmanKernel = bellman_select_kernel(bellmanISA);
+	bellmanKernelSingle = bellman_select_kernel_float(bellmanISA);
+	singlePrecision = false;
+	iterations = 0;
+	backups = 0;
 }
 
 LVI::LVI(double tolerance, bool enableLooping)
 {
 	epsilon = tolerance;
 	loopingVersion = enableLooping;
+	pool = new ThreadPool(1);
+	concurrentPartitions = false;
+	partitionRunner = nullptr;
+	gaussSeidel = false;
+	relaxation = 1.0;
+	visitOrder = LVI_VISIT_FORWARD;
+	fusedPruning = false;
+	fusedBackups = false;
+	policyEvaluation = false;
+	resumeValues = false;
+	telemetry = &nullTelemetry;
+	stopRequested = false;
+	deadline = std::numeric_limits<std::chrono::steady_clock::rep>::max();
+	residual = std::numeric_limits<double>::max();
+	discountFactor = 0.0;
+	converged = false;
+	actionElimination = false;
+	eliminations = 0;
+	intervalBounds = false;
+	intervalGap = std::numeric_limits<double>::max();
+	intervalClosed = false;
+	andersonDepth = 0;
+	andersonAccepted = 0;
+	andersonRejected = 0;
+	bellmanISA = BELLMAN_ISA_SCALAR;
+	bellmanKernel = bellman_select_kernel(bellmanISA);
+	bellmanKernelSingle = bellman_select_kernel_float(bellmanISA);
+	singlePrecision = false;
+	iterations = 0;
+	backups = 0;
 }
 
 LVI::~LVI()
-{ }
+{
+	delete pool;
+
+	for (ThreadPool *partitionPool : partitionPools) {
+		delete partitionPool;
+	}
+	delete partitionRunner;
+}
+
+PolicyMap *LVI::solve(LMDP *lmdp)
+{
+	// Handle the trivial case.
+	if (lmdp == nullptr) {
+		return nullptr;
+	}
+
+	StatesMap *S = nullptr;
+	ActionsMap *A = nullptr;
+	StateTransitions *T = nullptr;
+	FactoredRewards *R = nullptr;
+	Horizon *h = nullptr;
+
+	compile_model(lmdp, S, A, T, R, h);
+	if (h->is_finite()) {
+		throw CoreException();
+	}
+
+	// Handle the other trivial cases in which the slack variables or the partitions were incorrectly defined.
+	check_slack(lmdp->get_slack());
+	check_partitions(lmdp->get_partitions());
+
+	return solve_infinite_horizon(S, A, T, R, h,
+			lmdp->get_slack(), lmdp->get_partitions(), lmdp->get_orderings());
+}
+
+TimeIndexedPolicy *LVI::solve_finite(LMDP *lmdp)
+{
+	// Handle the trivial case.
+	if (lmdp == nullptr) {
+		return nullptr;
+	}
+
+	StatesMap *S = nullptr;
+	ActionsMap *A = nullptr;
+	StateTransitions *T = nullptr;
+	FactoredRewards *R = nullptr;
+	Horizon *h = nullptr;
+
+	compile_model(lmdp, S, A, T, R, h);
+	if (!h->is_finite()) {
+		throw CoreException();
+	}
+
+	check_slack(lmdp->get_slack());
+	check_partitions(lmdp->get_partitions());
+
+	return solve_finite_horizon(h, lmdp->get_slack(), lmdp->get_partitions(), lmdp->get_orderings());
+}
+
+std::vector<PolicyMap *> LVI::solve_slack_sweep(LMDP *lmdp,
+		const std::vector<std::vector<float> > &slacks,
+		std::vector<std::vector<std::unordered_map<State *, double> > > &sweepV)
+{
+	std::vector<PolicyMap *> policies;
+	sweepV.clear();
+
+	// Handle the trivial case.
+	if (lmdp == nullptr) {
+		return policies;
+	}
+
+	StatesMap *S = nullptr;
+	ActionsMap *A = nullptr;
+	StateTransitions *T = nullptr;
+	FactoredRewards *R = nullptr;
+	Horizon *h = nullptr;
+
+	// The model is compiled once for the entire batch.
+	compile_model(lmdp, S, A, T, R, h);
+	if (h->is_finite()) {
+		throw CoreException();
+	}
+
+	// Check every slack vector before solving any of them.
+	for (const std::vector<float> &delta : slacks) {
+		check_slack(delta);
+	}
+	check_partitions(lmdp->get_partitions());
+
+	// Each slack vector starts from the values of the previous one. The first reward in each ordering
+	// does not depend on the slack at all, so its values are already converged, and the others only
+	// change as much as the slack between neighbouring vectors does.
+	resumeValues = false;
+
+	for (const std::vector<float> &slack : slacks) {
+		std::vector<float> delta = slack;
+
+		// Whatever is thrown, the policies built so far are freed and the next solve starts afresh.
+		PolicyMap *policy = nullptr;
+		try {
+			policy = solve_infinite_horizon(S, A, T, R, h,
+					delta, lmdp->get_partitions(), lmdp->get_orderings());
+			policies.push_back(policy);
+			policy = nullptr;
+
+			sweepV.push_back(V);
+		} catch (...) {
+			resumeValues = false;
+			delete policy;
+			for (PolicyMap *solved : policies) {
+				delete solved;
+			}
+			sweepV.clear();
+			throw;
+		}
+
+		resumeValues = true;
+	}
+
+	resumeValues = false;
+
+	return policies;
+}
+
+std::vector<std::unordered_map<State *, double> > &LVI::get_V()
+{
+	return V;
+}
+
+const std::vector<unsigned int> &LVI::get_policy_actions() const
+{
+	return policyActions;
+}
+
+void LVI::set_num_threads(unsigned int numThreads)
+{
+	delete pool;
+	pool = new ThreadPool(std::max(1u, numThreads));
+}
+
+unsigned int LVI::get_num_threads() const
+{
+	return pool->get_num_threads();
+}
+
+void LVI::set_concurrent_partitions(bool concurrent)
+{
+	concurrentPartitions = concurrent;
+}
+
+bool LVI::get_concurrent_partitions() const
+{
+	return concurrentPartitions;
+}
+
+void LVI::set_gauss_seidel(bool enable, double omega)
+{
+	gaussSeidel = enable;
+	relaxation = std::max(0.01, std::min(1.99, omega));
+}
+
+bool LVI::get_gauss_seidel() const
+{
+	return gaussSeidel;
+}
+
+double LVI::get_relaxation() const
+{
+	return relaxation;
+}
+
+void LVI::set_visit_order(LVIVisitOrder order)
+{
+	visitOrder = order;
+}
+
+LVIVisitOrder LVI::get_visit_order() const
+{
+	return visitOrder;
+}
+
+void LVI::set_fused_pruning(bool enable)
+{
+	fusedPruning = enable;
+}
+
+bool LVI::get_fused_pruning() const
+{
+	return fusedPruning;
+}
+
+void LVI::set_fused_backups(bool enable)
+{
+	fusedBackups = enable;
+}
+
+bool LVI::get_fused_backups() const
+{
+	return fusedBackups;
+}
+
+void LVI::set_policy_evaluation(bool enable)
+{
+	policyEvaluation = enable;
+}
+
+bool LVI::get_policy_evaluation() const
+{
+	return policyEvaluation;
+}
+
+void LVI::set_action_elimination(bool enable)
+{
+	actionElimination = enable;
+}
+
+bool LVI::get_action_elimination() const
+{
+	return actionElimination;
+}
+
+unsigned long long LVI::get_num_eliminated() const
+{
+	return eliminations;
+}
+
+void LVI::set_interval_bounds(bool enable, const std::vector<State *> &targets)
+{
+	intervalBounds = enable;
+	intervalTargets = targets;
+}
+
+bool LVI::get_interval_bounds() const
+{
+	return intervalBounds;
+}
+
+std::vector<std::unordered_map<State *, double> > &LVI::get_V_lower()
+{
+	return VLower;
+}
+
+std::vector<std::unordered_map<State *, double> > &LVI::get_V_upper()
+{
+	return VUpper;
+}
+
+double LVI::get_interval_gap() const
+{
+	return intervalGap;
+}
+
+bool LVI::get_interval_closed() const
+{
+	return intervalClosed;
+}
+
+void LVI::set_anderson_depth(unsigned int depth)
+{
+	andersonDepth = depth;
+}
+
+unsigned int LVI::get_anderson_depth() const
+{
+	return andersonDepth;
+}
+
+unsigned long long LVI::get_num_anderson_accepted() const
+{
+	return andersonAccepted;
+}
+
+unsigned long long LVI::get_num_anderson_rejected() const
+{
+	return andersonRejected;
+}
+
+void LVI::set_bellman_isa(BellmanISA isa)
+{
+	bellmanISA = isa;
+	bellmanKernel = bellman_select_kernel(bellmanISA);
+	bellmanKernelSingle = bellman_select_kernel_float(bellmanISA);
+}
+
+BellmanISA LVI::get_bellman_isa() const
+{
+	return bellmanISA;
+}
+
+void LVI::set_single_precision(bool enable)
+{
+	singlePrecision = enable;
+}
+
+bool LVI::get_single_precision() const
+{
+	return singlePrecision;
+}
+
+LVIPrecisionReport LVI::compare_precision(LMDP *lmdp)
+{
+	LVIPrecisionReport report;
+	report.policyDifferences = 0;
+
+	bool enabled = singlePrecision;
+
+	// Solve with double precision first, and keep its values and policy as the reference.
+	singlePrecision = false;
+	PolicyMap *reference = nullptr;
+	try {
+		reference = solve(lmdp);
+	} catch (...) {
+		singlePrecision = enabled;
+		throw;
+	}
+	if (reference == nullptr) {
+		singlePrecision = enabled;
+		return report;
+	}
+	std::vector<std::vector<double> > referenceValues = values;
+	std::vector<unsigned int> referenceActions = policyActions;
+
+	singlePrecision = true;
+	PolicyMap *policy = nullptr;
+	try {
+		policy = solve(lmdp);
+	} catch (...) {
+		singlePrecision = enabled;
+		delete reference;
+		throw;
+	}
+	singlePrecision = enabled;
+
+	for (int i = 0; i < (int)values.size(); i++) {
+		double maxError = 0.0;
+		double sumError = 0.0;
+
+		for (int s = 0; s < (int)values[i].size(); s++) {
+			double error = std::fabs(values[i][s] - referenceValues[i][s]);
+			maxError = std::max(maxError, error);
+			sumError += error;
+		}
+
+		report.maxError.push_back(maxError);
+		report.meanError.push_back(values[i].empty() ? 0.0 : sumError / (double)values[i].size());
+	}
+
+	// The actions are compared by index, since a state in no partition has no action in either policy.
+	for (int s = 0; s < (int)policyActions.size(); s++) {
+		if (policyActions[s] != referenceActions[s]) {
+			report.policyDifferences++;
+		}
+	}
+
+	delete reference;
+	delete policy;
+
+	return report;
+}
+
+LVIAccelerationReport LVI::compare_acceleration(LMDP *lmdp)
+{
+	LVIAccelerationReport report;
+	report.plainIterations = 0;
+	report.acceleratedIterations = 0;
+	report.accepted = 0;
+	report.rejected = 0;
+	report.policyDifferences = 0;
+
+	unsigned int depth = andersonDepth;
+
+	// Solve without acceleration first, and keep its values, actions, and sweeps as the reference.
+	andersonDepth = 0;
+	PolicyMap *reference = nullptr;
+	try {
+		reference = solve(lmdp);
+	} catch (...) {
+		andersonDepth = depth;
+		throw;
+	}
+	andersonDepth = depth;
+	if (reference == nullptr) {
+		return report;
+	}
+	delete reference;
+
+	std::vector<std::vector<double> > referenceValues = values;
+	std::vector<unsigned int> referenceActions = policyActions;
+	report.plainSweeps = sweeps;
+	report.plainIterations = iterations;
+
+	// Should the accelerated solve fail, the values and actions are left as those of the reference.
+	PolicyMap *policy = nullptr;
+	try {
+		policy = solve(lmdp);
+	} catch (...) {
+		values = referenceValues;
+		policyActions = referenceActions;
+		throw;
+	}
+	if (policy == nullptr) {
+		return report;
+	}
+	delete policy;
+
+	report.acceleratedSweeps = sweeps;
+	report.acceleratedIterations = iterations;
+	report.accepted = andersonAccepted;
+	report.rejected = andersonRejected;
+
+	for (int i = 0; i < (int)values.size(); i++) {
+		double maxDifference = 0.0;
+		for (int s = 0; s < (int)values[i].size(); s++) {
+			maxDifference = std::max(maxDifference, std::fabs(values[i][s] - referenceValues[i][s]));
+		}
+		report.maxDifference.push_back(maxDifference);
+	}
+
+	for (int s = 0; s < (int)policyActions.size(); s++) {
+		if (policyActions[s] != referenceActions[s]) {
+			report.policyDifferences++;
+		}
+	}
+
+	return report;
+}
+
+const LVIWorkspace &LVI::get_workspace() const
+{
+	return workspace;
+}
+
+unsigned int LVI::get_num_iterations() const
+{
+	return iterations;
+}
+
+const std::vector<unsigned int> &LVI::get_num_sweeps() const
+{
+	return sweeps;
+}
+
+unsigned long long LVI::get_num_backups() const
+{
+	return backups;
+}
+
+void LVI::compile_model(LMDP *lmdp, StatesMap *&S, ActionsMap *&A, StateTransitions *&T,
+		FactoredRewards *&R, Horizon *&h)
+{
+	// Attempt to convert the states object into FiniteStates.
+	S = dynamic_cast<StatesMap *>(lmdp->get_states());
+	if (S == nullptr) {
+		throw StateException();
+	}
+
+	// Attempt to convert the actions object into FiniteActions.
+	A = dynamic_cast<ActionsMap *>(lmdp->get_actions());
+	if (A == nullptr) {
+		throw ActionException();
+	}
+
+	// Note: All forms of StateTransitions objects are valid here, since they all require get.
+	T = lmdp->get_state_transitions();
+
+	// Attempt to convert the rewards object into FactoredRewards. Also, ensure that the
+	// type of each element is SASRewards.
+	R = dynamic_cast<FactoredRewards *>(lmdp->get_rewards());
+	if (R == nullptr) {
+		throw RewardException();
+	}
+
+	// Obtain the horizon; the caller checks that it suits its form of value iteration.
+//	Initial *s0 = lmdp->get_initial_state();
+	h = lmdp->get_horizon();
+
+	// The discount factor is kept apart from the model, so that get_error_bound may read it while the
+	// model is being compiled on another thread.
+	discountFactor = h->get_discount_factor();
+
+	// Compile the LMDP into its flat form once; the solvers run entirely on this representation. This
+	// also ensures that the type of each reward is SASRewards.
+	model.compile(S, A, T, R, h);
+	if (singlePrecision) {
+		model.compile_single_precision();
+	}
+	if (fusedBackups || policyEvaluation) {
+		model.compile_interleaved_rewards();
+	}
+}
+
+void LVI::check_slack(const std::vector<float> &delta) const
+{
+	if (delta.size() != model.get_num_rewards()) {
+		throw RewardException();
+	}
+	for (int i = 0; i < (int)delta.size(); i++) {
+		if (delta.at(i) < 0.0) {
+			throw RewardException();
+		}
+	}
+}
+
+void LVI::check_partitions(const std::vector<std::vector<State *> > &P) const
+{
+	std::vector<std::vector<unsigned int> > PIndices;
+	model.convert_partitions(P, PIndices);
+
+	std::vector<bool> covered(model.get_num_states(), false);
+	for (const std::vector<unsigned int> &Pj : PIndices) {
+		for (unsigned int s : Pj) {
+			covered[s] = true;
+		}
+	}
+
+	if (std::find(covered.begin(), covered.end(), false) != covered.end()) {
+		throw PolicyException();
+	}
+}
+
+void LVI::request_stop()
+{
+	stopRequested = true;
+}
+
+void LVI::clear_stop()
+{
+	stopRequested = false;
+}
+
+void LVI::set_deadline(std::chrono::steady_clock::time_point time)
+{
+	deadline = time.time_since_epoch().count();
+}
+
+void LVI::clear_deadline()
+{
+	deadline = std::numeric_limits<std::chrono::steady_clock::rep>::max();
+}
+
+double LVI::get_residual() const
+{
+	return residual;
+}
+
+double LVI::get_error_bound() const
+{
+	double gamma = discountFactor;
+	double r = residual;
+
+	if (r == std::numeric_limits<double>::max() || gamma >= 1.0) {
+		return std::numeric_limits<double>::max();
+	}
+
+	return r * gamma / (1.0 - gamma);
+}
+
+bool LVI::get_converged() const
+{
+	return converged;
+}
+
+bool LVI::should_stop() const
+{
+	return stopRequested || std::chrono::steady_clock::now().time_since_epoch().count() >= deadline;
+}
+
+void LVI::record_residual(const std::vector<std::vector<double> > &difference)
+{
+	double r = 0.0;
+	for (const std::vector<double> &differencej : difference) {
+		for (double d : differencej) {
+			r = std::max(r, d);
+		}
+	}
+	residual = r;
+}
+
+void LVI::set_telemetry(LVITelemetry *sink)
+{
+	if (sink == nullptr) {
+		telemetry = &nullTelemetry;
+	} else {
+		telemetry = sink;
+	}
+}
+
+LVITelemetry *LVI::get_telemetry() const
+{
+	return telemetry;
+}
+
+void LVI::start_telemetry(const std::vector<std::vector<unsigned int> > &PIndices)
+{
+	partitionIndices.clear();
+	levelSweeps.clear();
+	levelActions.clear();
+
+	// The partitions are also used to find their buffers in the workspace.
+	for (int j = 0; j < (int)PIndices.size(); j++) {
+		partitionIndices[&PIndices[j]] = j;
+	}
+
+	if (!telemetry->is_enabled()) {
+		return;
+	}
+
+	levelSweeps.resize(PIndices.size(), std::vector<unsigned int>(model.get_num_rewards(), 0));
+	levelActions.resize(PIndices.size(), std::vector<unsigned long long>(model.get_num_rewards(), 0));
+}
+
+void LVI::record_level(const std::vector<unsigned int> &Pj, unsigned int i, unsigned int sweep,
+		const ActionSets &sets, const std::vector<unsigned int> &Ai)
+{
+	if (!telemetry->is_enabled()) {
+		return;
+	}
+
+	std::unordered_map<const std::vector<unsigned int> *, unsigned int>::const_iterator j = partitionIndices.find(&Pj);
+	if (j == partitionIndices.end()) {
+		return;
+	}
+
+	unsigned long long actions = 0;
+	for (unsigned int set : Ai) {
+		actions += sets.get_size(set);
+	}
+
+	levelSweeps[j->second][i] += sweep;
+	levelActions[j->second][i] = actions;
+}
+
+void LVI::record_iteration(unsigned int iteration, const std::vector<std::vector<double> > &difference,
+		const std::vector<std::vector<unsigned int> > &o, double convergenceCriterion, double time)
+{
+	if (!telemetry->is_enabled()) {
+		return;
+	}
+
+	for (int j = 0; j < (int)difference.size(); j++) {
+		for (int level = 0; level < (int)o[j].size(); level++) {
+			unsigned int i = o[j][level];
+
+			LVITelemetryRecord record;
+			record.iteration = iteration;
+			record.partition = j;
+			record.reward = i;
+			record.level = level;
+			record.residual = difference[j][i];
+			record.converged = (difference[j][i] <= convergenceCriterion);
+			record.sweeps = levelSweeps[j][i];
+			record.actions = levelActions[j][i];
+			record.time = time;
+
+			telemetry->record(record);
+
+			levelSweeps[j][i] = 0;
+			levelActions[j][i] = 0;
+		}
+	}
+}
+
+void LVI::set_initial_values(const std::vector<std::unordered_map<State *, double> > &V0)
+{
+	initialValues.clear();
+	initialValues.resize(V0.size());
+
+	// Different states with the same hash value cannot be told apart later, so none of them get a value.
+	std::unordered_map<unsigned int, State *> states;
+	std::unordered_set<unsigned int> collided;
+
+	for (int i = 0; i < (int)V0.size(); i++) {
+		for (const std::pair<State * const, double> &Vis : V0[i]) {
+			unsigned int hash = Vis.first->hash_value();
+			if (states.insert(std::make_pair(hash, Vis.first)).first->second != Vis.first) {
+				collided.insert(hash);
+			}
+			initialValues[i][hash] = Vis.second;
+		}
+	}
+
+	for (unsigned int hash : collided) {
+		for (std::unordered_map<unsigned int, double> &initialValuesi : initialValues) {
+			initialValuesi.erase(hash);
+		}
+	}
+
+	for (const std::pair<const unsigned int, State *> &state : states) {
+		initialStates[state.first] = state.second;
+	}
+}
+
+void LVI::set_initial_policy(StatesMap *S, PolicyMap *pi0)
+{
+	initialPolicy.clear();
+
+	// As with the values, different states with the same hash value get no action.
+	std::unordered_map<unsigned int, State *> states;
+	std::unordered_set<unsigned int> collided;
+
+	for (auto state : *S) {
+		State *s = resolve(state);
+
+		// States without an action in the policy are simply skipped.
+		try {
+			initialPolicy[s->hash_value()] = pi0->get(s)->hash_value();
+			if (states.insert(std::make_pair(s->hash_value(), s)).first->second != s) {
+				collided.insert(s->hash_value());
+			}
+		} catch (PolicyException &err) { }
+	}
+
+	for (unsigned int hash : collided) {
+		initialPolicy.erase(hash);
+	}
+
+	for (const std::pair<const unsigned int, State *> &state : states) {
+		initialStates[state.first] = state.second;
+	}
+}
+
+void LVI::clear_initial_solution()
+{
+	initialValues.clear();
+	initialPolicy.clear();
+	initialStates.clear();
+}
+
+bool LVI::save_solution(std::string filename, PolicyMap *policy) const
+{
+	std::ofstream file(filename);
+	if (!file.is_open()) {
+		return true;
+	}
+
+	// Write enough digits that the values are read back exactly.
+	file.precision(std::numeric_limits<double>::max_digits10);
+
+	for (int s = 0; s < (int)model.get_num_states(); s++) {
+		State *state = model.get_state(s);
+
+		file << state->hash_value() << ",";
+		try {
+			file << policy->get(state)->hash_value();
+		} catch (PolicyException &err) {
+			file.close();
+			return true;
+		}
+
+		for (int i = 0; i < (int)values.size(); i++) {
+			file << "," << values[i][s];
+		}
+		file << std::endl;
+	}
+
+	file.close();
+
+	return false;
+}
+
+bool LVI::load_solution(std::string filename)
+{
+	std::ifstream file(filename);
+	if (!file.is_open()) {
+		return true;
+	}
+
+	std::vector<std::unordered_map<unsigned int, double> > loadedValues;
+	std::unordered_map<unsigned int, unsigned int> loadedPolicy;
+	std::unordered_map<unsigned int, State *> loadedStates;
+	std::unordered_set<unsigned int> collided;
+
+	std::string line;
+	while (std::getline(file, line)) {
+		if (line.empty()) {
+			continue;
+		}
+
+		std::stringstream stream(line);
+		std::string item;
+		std::vector<std::string> items;
+		while (std::getline(stream, item, ',')) {
+			items.push_back(item);
+		}
+
+		// Every line must have the state, the action, and the same number of values.
+		if (items.size() < 2 || (!loadedPolicy.empty() && items.size() - 2 != loadedValues.size())) {
+			file.close();
+			return true;
+		}
+		loadedValues.resize(items.size() - 2);
+
+		try {
+			unsigned int stateHash = (unsigned int)std::stoul(items[0]);
+			if (loadedPolicy.count(stateHash) > 0) {
+				collided.insert(stateHash);
+			}
+			loadedPolicy[stateHash] = (unsigned int)std::stoul(items[1]);
+			for (int i = 0; i < (int)loadedValues.size(); i++) {
+				loadedValues[i][stateHash] = std::stod(items[i + 2]);
+			}
+		} catch (std::exception &err) {
+			file.close();
+			return true;
+		}
+	}
+
+	file.close();
+
+	// The file only holds hash values, so the states are not known; a hash value on several lines
+	// belongs to several states, which cannot be told apart.
+	for (unsigned int hash : collided) {
+		loadedPolicy.erase(hash);
+		for (std::unordered_map<unsigned int, double> &loadedValuesi : loadedValues) {
+			loadedValuesi.erase(hash);
+		}
+	}
+	for (const std::pair<const unsigned int, unsigned int> &action : loadedPolicy) {
+		loadedStates[action.first] = nullptr;
+	}
+
+	initialValues = loadedValues;
+	initialPolicy = loadedPolicy;
+	initialStates = loadedStates;
+
+	return false;
+}
+
+void LVI::initialize_solution(std::vector<unsigned int> &pi)
+{
+	unsigned int n = model.get_num_states();
+	unsigned int m = model.get_num_actions();
+	unsigned int k = model.get_num_rewards();
+
+	// Values for a different number of rewards cannot be used.
+	bool hasValues = (initialValues.size() == k);
+
+	if (!hasValues && initialPolicy.empty()) {
+		return;
+	}
+
+	// A state is matched by its hash value only if no other state of the model shares it, and the
+	// initial state is the same one, or one which reads the same. Those loaded from a file are only
+	// known by their hash value.
+	std::unordered_map<unsigned int, unsigned int> hashCounts;
+	for (int s = 0; s < (int)n; s++) {
+		hashCounts[model.get_state(s)->hash_value()]++;
+	}
+
+	std::vector<bool> matched(n, false);
+	for (int s = 0; s < (int)n; s++) {
+		State *state = model.get_state(s);
+		unsigned int hash = state->hash_value();
+
+		std::unordered_map<unsigned int, State *>::const_iterator initialState = initialStates.find(hash);
+		if (hashCounts[hash] == 1 && initialState != initialStates.end()) {
+			matched[s] = (initialState->second == nullptr || initialState->second == state ||
+					initialState->second->to_string() == state->to_string());
+		}
+	}
+
+	if (hasValues) {
+		for (int i = 0; i < (int)k; i++) {
+			for (int s = 0; s < (int)n; s++) {
+				if (!matched[s]) {
+					continue;
+				}
+
+				std::unordered_map<unsigned int, double>::const_iterator Vis = initialValues[i].find(model.get_state(s)->hash_value());
+				if (Vis != initialValues[i].end()) {
+					values[i][s] = Vis->second;
+				}
+			}
+		}
+	}
+
+	if (initialPolicy.empty()) {
+		return;
+	}
+
+	// Find the index of the initial action of each state, or m if it has none. Actions which share a
+	// hash value are ambiguous, so they are never the initial action.
+	std::unordered_map<unsigned int, unsigned int> actionIndices;
+	for (int a = 0; a < (int)m; a++) {
+		unsigned int hash = model.get_action(a)->hash_value();
+		if (!actionIndices.insert(std::make_pair(hash, a)).second) {
+			actionIndices[hash] = m;
+		}
+	}
+
+	for (int s = 0; s < (int)n; s++) {
+		if (!matched[s]) {
+			continue;
+		}
+
+		std::unordered_map<unsigned int, unsigned int>::const_iterator a = initialPolicy.find(model.get_state(s)->hash_value());
+		if (a != initialPolicy.end() && actionIndices.count(a->second) > 0) {
+			pi[s] = actionIndices[a->second];
+		}
+	}
+
+	if (hasValues) {
+		return;
+	}
+
+	// Without initial values, start from the values of the initial policy for each reward. States
+	// without an initial action keep their value of 0. The values are only a start, so the sweeps
+	// are bounded, e.g., for a policy which never reaches an absorbing state without discounting.
+	double gamma = model.get_discount_factor();
+	double convergenceCriterion = epsilon * std::max(0.1, (1.0 - gamma) / gamma);
+
+	for (int i = 0; i < (int)k; i++) {
+		double difference = convergenceCriterion + 1.0;
+		unsigned int sweep = 0;
+
+		while (difference > convergenceCriterion && sweep < LVI_MAX_INITIAL_SWEEPS && !should_stop()) {
+			difference = 0.0;
+
+			for (int s = 0; s < (int)n; s++) {
+				if (pi[s] == m) {
+					continue;
+				}
+
+				double Vis = compute_Q(i, s, pi[s], values[i]);
+				if (std::fabs(Vis - values[i][s]) > difference) {
+					difference = std::fabs(Vis - values[i][s]);
+				}
+				values[i][s] = Vis;
+				backups++;
+			}
+
+			sweep++;
+			sweeps[i]++;
+		}
+	}
+}
+
+PolicyMap *LVI::create_policy(Horizon *h) const
+{
+	PolicyMap *policy = new PolicyMap(h);
+
+	for (int s = 0; s < (int)policyActions.size(); s++) {
+		if (policyActions[s] < model.get_num_actions()) {
+			policy->set(model.get_state(s), model.get_action(policyActions[s]));
+		}
+	}
+
+	return policy;
+}
+
+TimeIndexedPolicy *LVI::solve_finite_horizon(Horizon *h, std::vector<float> &delta,
+		std::vector<std::vector<State *> > &P,
+		std::vector<std::vector<unsigned int> > &o)
+{
+	unsigned int n = model.get_num_states();
+	unsigned int m = model.get_num_actions();
+	unsigned int k = model.get_num_rewards();
+	unsigned int H = h->get_horizon();
+	double gamma = model.get_discount_factor();
+
+	// Each state is backed up with the ordering of its partition; check_partitions ensured every state has one.
+	std::vector<std::vector<unsigned int> > PIndices;
+	model.convert_partitions(P, PIndices);
+
+	std::vector<unsigned int> statePartitions(n, 0);
+	for (int j = 0; j < (int)PIndices.size(); j++) {
+		for (unsigned int s : PIndices[j]) {
+			statePartitions[s] = j;
+		}
+	}
+
+	// Losing eta_i at every step loses at most sum_t gamma^t eta_i = delta_i over the horizon.
+	double steps = H;
+	if (gamma < 1.0) {
+		steps = (1.0 - std::pow(gamma, (double)H)) / (1.0 - gamma);
+	}
+
+	std::vector<double> eta(k);
+	for (int i = 0; i < (int)k; i++) {
+		eta[i] = delta[i] / steps;
+	}
+
+	std::vector<State *> states(n);
+	for (int s = 0; s < (int)n; s++) {
+		states[s] = model.get_state(s);
+	}
+
+	std::vector<Action *> actions(m);
+	for (int a = 0; a < (int)m; a++) {
+		actions[a] = model.get_action(a);
+	}
+
+	TimeIndexedPolicy *policy = new TimeIndexedPolicy(H, states, actions);
+
+	// The values of step t are computed from those of step t + 1, and then take their place.
+	std::vector<std::vector<double> > valuesStep(k, std::vector<double>(n, 0.0));
+	std::vector<std::vector<double> > valuesNext(k, std::vector<double>(n, 0.0));
+	std::vector<unsigned int> stepActions(n, 0);
+
+	// The candidate actions of each worker, and their Q-values, reused by every state.
+	unsigned int numThreads = pool->get_num_threads();
+	std::vector<std::vector<unsigned int> > candidates(numThreads, std::vector<unsigned int>(m));
+	std::vector<std::vector<double> > Q(numThreads, std::vector<double>(m));
+
+	// With telemetry, each worker also keeps the change of the values over the step and the number of
+	// actions left for each reward of each partition, as one outer iteration does.
+	start_telemetry(PIndices);
+	bool recording = telemetry->is_enabled();
+	std::vector<std::vector<double> > difference(P.size(), std::vector<double>(k, 0.0));
+	std::vector<std::vector<double> > workerDifference;
+	std::vector<std::vector<unsigned long long> > workerActions;
+	if (recording) {
+		workerDifference.resize(numThreads, std::vector<double>(P.size() * k));
+		workerActions.resize(numThreads, std::vector<unsigned long long>(P.size() * k));
+	}
+
+	iterations = 0;
+	sweeps.assign(k, 0);
+	backups = 0;
+
+	auto start = std::chrono::high_resolution_clock::now();
+
+	for (int t = (int)H - 1; t >= 0; t--) {
+		for (int worker = 0; worker < (int)workerDifference.size(); worker++) {
+			std::fill(workerDifference[worker].begin(), workerDifference[worker].end(), 0.0);
+			std::fill(workerActions[worker].begin(), workerActions[worker].end(), 0);
+		}
+
+		pool->run(n, [&](unsigned int worker, unsigned int begin, unsigned int end) {
+			std::vector<unsigned int> &As = candidates[worker];
+			std::vector<double> &Qs = Q[worker];
+
+			for (unsigned int s = begin; s < end; s++) {
+				unsigned int j = statePartitions[s];
+				const std::vector<unsigned int> &os = o[j];
+
+				unsigned int count = m;
+				for (unsigned int a = 0; a < m; a++) {
+					As[a] = a;
+				}
+
+				for (unsigned int q = 0; q < k; q++) {
+					unsigned int i = os[q];
+
+					double best = std::numeric_limits<double>::lowest();
+					for (unsigned int c = 0; c < count; c++) {
+						Qs[c] = compute_Q(i, s, As[c], valuesNext[i]);
+						best = std::max(best, Qs[c]);
+					}
+					valuesStep[i][s] = best;
+
+					if (recording) {
+						double &d = workerDifference[worker][j * k + i];
+						d = std::max(d, std::fabs(best - valuesNext[i][s]));
+						workerActions[worker][j * k + i] += count;
+					}
+
+					// The last reward picks the first best action; the others keep those within the slack.
+					if (q == k - 1) {
+						unsigned int c = 0;
+						while (Qs[c] != best) {
+							c++;
+						}
+						stepActions[s] = As[c];
+					} else {
+						unsigned int kept = 0;
+						for (unsigned int c = 0; c < count; c++) {
+							if (best - Qs[c] < eta[i] + std::numeric_limits<double>::epsilon() * 10.0) {
+								As[kept++] = As[c];
+							}
+						}
+						count = kept;
+					}
+				}
+			}
+		});
+
+		policy->record(t, stepActions);
+		std::swap(valuesStep, valuesNext);
+
+		iterations++;
+		for (int i = 0; i < (int)k; i++) {
+			sweeps[i]++;
+		}
+		backups += (unsigned long long)n * k;
+
+		// Each step is one sweep of every reward, so it is reported as an outer iteration.
+		if (recording) {
+			for (int j = 0; j < (int)P.size(); j++) {
+				for (int i = 0; i < (int)k; i++) {
+					difference[j][i] = 0.0;
+					levelSweeps[j][i] = 1;
+					levelActions[j][i] = 0;
+					for (int worker = 0; worker < (int)numThreads; worker++) {
+						difference[j][i] = std::max(difference[j][i], workerDifference[worker][j * k + i]);
+						levelActions[j][i] += workerActions[worker][j * k + i];
+					}
+				}
+			}
+
+			record_iteration(iterations, difference, o, 0.0,
+					std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - start).count());
+		}
+	}
+
+	// After the last swap, the values of step 0 are the next values; they are kept as the values of
+	// the solver, like those of the infinite horizon.
+	values = valuesNext;
+	model.convert_values(values, V);
+	policyActions = stepActions;
+
+	return policy;
+}
+
+PolicyMap *LVI::solve_infinite_horizon(StatesMap * /* S */, ActionsMap * /* A */,
+		StateTransitions * /* T */, FactoredRewards *R, Horizon *h,
+		std::vector<float> &delta,
+		std::vector<std::vector<State *> > &P,
+		std::vector<std::vector<unsigned int> > &o)
+{
+	// The partitions over state indices.
+	std::vector<std::vector<unsigned int> > PIndices;
+	model.convert_partitions(P, PIndices);
+
+	// The actions are kept as indices while solving, and only become a policy at the end.
+	policyActions.assign(model.get_num_states(), model.get_num_actions());
+
+	// Reset the iteration counts and the progress.
+	residual = std::numeric_limits<double>::max();
+	converged = false;
+	iterations = 0;
+	eliminations = 0;
+	andersonAccepted = 0;
+	andersonRejected = 0;
+	backups = 0;
+	sweeps.clear();
+	sweeps.resize(R->get_num_rewards(), 0);
+
+	// The value of the states, one for each reward, defaulted to 0.0 or to the initial solution.
+	// When resuming within a slack sweep, keep the values of the previous slack vector instead.
+	if (!resumeValues) {
+		values.clear();
+		values.resize(R->get_num_rewards(), std::vector<double>(model.get_num_states(), 0.0));
+		initialize_solution(policyActions);
+	}
+
+	// With interval bounds, the values are the lower bounds, and both bounds start from those which hold
+	// for any policy. The bounds of a previous slack vector do not hold for this one, so they always restart.
+	bool interval = is_interval();
+	if (interval) {
+		seed_interval_bounds(PIndices);
+	}
+
+	// All of the buffers of the outer loop are allocated here, once, and reused by every iteration.
+	workspace.reserve(model, PIndices, singlePrecision, interval, get_anderson_active_depth());
+
+	// We will want to remember the previous fixed values of states, too.
+	std::vector<std::vector<double> > &VFixed = workspace.get_fixed_values();
+	std::vector<std::vector<double> > &VFixedUpper = workspace.get_fixed_upper_values();
+
+	// Every partition rewrites all of its states during an iteration, so if the partitions cover every
+	// state, the previous values are swapped in rather than copied.
+	unsigned int covered = 0;
+	for (const std::vector<unsigned int> &Pj : PIndices) {
+		covered += (unsigned int)Pj.size();
+	}
+	bool swapValues = (covered == model.get_num_states());
+
+	// Compute the convergence criterion.
+	double convergenceCriterion = epsilon * std::max(0.1, (1.0 - h->get_discount_factor()) / h->get_discount_factor());
+	bool done = false;
+
+	std::vector<std::vector<double> > &difference = workspace.get_differences();
+
+	// The gap of the interval bounds at the target states after the previous outer iteration.
+	double previousGap = std::numeric_limits<double>::max();
+	intervalGap = std::numeric_limits<double>::max();
+	intervalClosed = false;
+
+	// When solving the partitions concurrently, each one gets its own share of the threads, and one more
+	// pool runs the partitions themselves, so that no threads are started within the loop.
+	bool concurrent = (concurrentPartitions && P.size() > 1);
+	if (concurrent) {
+		reserve_partition_pools((unsigned int)P.size());
+	}
+
+	// After setting up everything, begin timing.
+	auto start = std::chrono::high_resolution_clock::now();
+
+	// The telemetry is gathered per partition, so it must know which partition is which.
+	start_telemetry(PIndices);
+
+	// Iterate the outer loop until the convergence criterion is satisfied.
+	int counter = 1;
+//	while (counter < 30) {
+	while (!done) {
+		// Update VFixed to the previous value of V.
+		if (swapValues) {
+			std::swap(VFixed, values);
+			if (interval) {
+				std::swap(VFixedUpper, valuesUpper);
+			}
+		} else {
+			for (int i = 0; i < (int)R->get_num_rewards(); i++) {
+				VFixed[i] = values[i];
+				if (interval) {
+					VFixedUpper[i] = valuesUpper[i];
+				}
+			}
+		}
+
+		done = true;
+
+		// Reset the difference for *all* of the variables.
+		for (int j = 0; j < (int)P.size(); j++) {
+			for (int i = 0; i < (int)R->get_num_rewards(); i++) {
+				difference[j][i] = 0.0;
+			}
+		}
+
+		// For each of the partitions, run value iteration. Each time, copy the resulting value functions.
+		if (!concurrent) {
+			for (int j = 0; j < (int)P.size(); j++) {
+				compute_partition(delta, PIndices[j], o[j], VFixed, values, policyActions, difference[j], pool);
+			}
+		} else {
+			// Each partition only reads VFixed and writes its own states of values, so they may all run at
+			// once. Each worker of the runner gets exactly one partition; the calling thread solves the first.
+			partitionRunner->run(P.size(), [&](unsigned int /* worker */, unsigned int begin, unsigned int end) {
+				for (unsigned int j = begin; j < end; j++) {
+					compute_partition(delta, PIndices[j], o[j], VFixed, values, policyActions, difference[j], partitionPools[j]);
+				}
+			});
+		}
+
+		// Check for convergence.
+		for (int j = 0; j < (int)P.size(); j++) {
+			for (int i = 0; i < (int)R->get_num_rewards(); i++) {
+				if (difference[j][i] > convergenceCriterion) {
+					done = false;
+				}
+			}
+		}
+
+		// With interval bounds, the gap at the target states decides instead. Should it stop shrinking
+		// before it closes, the usual criterion still ends the solve, so that it cannot run forever.
+		if (interval) {
+			intervalGap = 0.0;
+			for (int i = 0; i < (int)R->get_num_rewards(); i++) {
+				for (int s = 0; s < (int)model.get_num_states(); s++) {
+					if (intervalTargetStates[s]) {
+						intervalGap = std::max(intervalGap, valuesUpper[i][s] - values[i][s]);
+					}
+				}
+			}
+
+			intervalClosed = (intervalGap <= epsilon);
+			done = (intervalClosed || (done && intervalGap >= previousGap));
+			previousGap = intervalGap;
+		}
+
+		// Report the convergence of this iteration.
+		record_iteration(counter, difference, o, convergenceCriterion,
+				std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - start).count());
+
+		record_residual(difference);
+		converged = done;
+
+		counter++;
+
+		// Once asked to stop, keep the policy of this complete iteration.
+		if (should_stop()) {
+			break;
+		}
+	}
+
+	iterations = counter - 1;
+
+	// Keep the bounds keyed by state, before the values may be replaced by those of the final policy.
+	if (interval) {
+		model.convert_values(values, VLower);
+		model.convert_values(valuesUpper, VUpper);
+	}
+
+	// Evaluate the final policy, so that the values are exactly those of the policy returned.
+	if (policyEvaluation) {
+		compute_policy_evaluation(policyActions, values, pool);
+	}
+
+	// Provide the values keyed by state for the callers of get_V.
+	model.convert_values(values, V);
+
+	return create_policy(h);
+}
+
+LVIPartitionWorkspace *LVI::get_partition_workspace(const std::vector<unsigned int> &Pj,
+		std::unique_ptr<LVIPartitionWorkspace> &temporary)
+{
+	std::unordered_map<const std::vector<unsigned int> *, unsigned int>::const_iterator j = partitionIndices.find(&Pj);
+	if (j != partitionIndices.end() && j->second < workspace.get_num_partitions()) {
+		return workspace.get_partition(j->second);
+	}
+
+	temporary.reset(new LVIPartitionWorkspace(model.get_num_actions()));
+	temporary->reserve(model, Pj, singlePrecision, is_interval(), get_anderson_active_depth());
+	return temporary.get();
+}
+
+void LVI::copy_fixed_values(const LVIPartitionWorkspace &scratch, const std::vector<unsigned int> &Pj,
+		const std::vector<double> &VFixedi, std::vector<double> &Vi) const
+{
+	for (unsigned int s : Pj) {
+		Vi[s] = VFixedi[s];
+	}
+	for (unsigned int s : scratch.boundary) {
+		Vi[s] = VFixedi[s];
+	}
+}
+
+void LVI::reserve_partition_pools(unsigned int numPartitions)
+{
+	unsigned int share = std::max(1u, pool->get_num_threads() / numPartitions);
+
+	bool keep = (partitionPools.size() == numPartitions && partitionRunner != nullptr &&
+			partitionRunner->get_num_threads() == numPartitions);
+	for (ThreadPool *partitionPool : partitionPools) {
+		keep = keep && (partitionPool->get_num_threads() == share);
+	}
+	if (keep) {
+		return;
+	}
+
+	for (ThreadPool *partitionPool : partitionPools) {
+		delete partitionPool;
+	}
+	partitionPools.clear();
+	delete partitionRunner;
+	partitionRunner = nullptr;
+
+	for (unsigned int j = 0; j < numPartitions; j++) {
+		partitionPools.push_back(new ThreadPool(share));
+	}
+	partitionRunner = new ThreadPool(numPartitions);
+}
+
+void LVI::compute_partition(std::vector<float> &delta,
+		std::vector<unsigned int> &Pj, std::vector<unsigned int> &oj,
+		std::vector<std::vector<double> > &VFixed,
+		std::vector<std::vector<double> > &values,
+		std::vector<unsigned int> &pi, std::vector<double> &maxDifference,
+		ThreadPool *threads)
+{
+	unsigned int k = model.get_num_rewards();
+	double gamma = model.get_discount_factor();
+	bool interval = is_interval();
+	bool anderson = (get_anderson_active_depth() > 0);
+
+	// The buffers of this partition keep their memory between outer iterations.
+	std::unique_ptr<LVIPartitionWorkspace> temporary;
+	LVIPartitionWorkspace *scratch = get_partition_workspace(Pj, temporary);
+
+	// The value of the states, one for each reward. With interval bounds, these are the lower bounds.
+	std::vector<std::vector<double> > &VPrime = scratch->VPrime;
+
+	// The upper bounds on the values of the states for the current reward, and on its Q-values.
+	std::vector<double> &ViUpper = scratch->ViUpper;
+	std::vector<std::vector<double> > &QiUpper = scratch->QiUpper;
+
+	// Compute the convergence criterion which follows from the proof of convergence.
+	double convergenceCriterion = epsilon * std::max(0.1, (1.0 - gamma) / gamma);
+
+	// The sets of actions, interned so that states with the same set of actions share it.
+	ActionSets &sets = scratch->sets;
+
+	// Remember the set of actions available to each of the value functions, indexed by the position of
+	// each state in the partition. This will be computed at the end of each step. The initial set of
+	// actions for i = 1 is all of them.
+	std::vector<std::vector<unsigned int> > &AStar = scratch->AStar;
+	for (int i = 0; i < (int)k; i++) {
+		std::fill(AStar[i].begin(), AStar[i].end(), sets.get_full());
+	}
+
+	// The values of the states in the partition after a sweep, and the actions which obtained them,
+	// indexed by their position in the partition.
+	std::vector<double> &Vi = scratch->Vi;
+	std::vector<unsigned int> &pij = scratch->pij;
+
+	// The Q-values of each state in the partition from the latest sweep, parallel to its set of actions.
+	std::vector<std::vector<double> > &Qi = scratch->Qi;
+
+	// For each of the value functions, we will compute the actions set.
+	for (int i = 0; i < (int)k; i++) {
+		// Once every state is left with a single action, the remaining rewards only evaluate that policy,
+		// so they are solved together.
+		if (fusedBackups && !singlePrecision && !interval && i < (int)k - 1) {
+			bool fixed = true;
+			for (unsigned int Ais : AStar[oj[i]]) {
+				if (sets.get_size(Ais) != 1) {
+					fixed = false;
+					break;
+				}
+			}
+
+			if (fixed) {
+				compute_fixed_levels(i, *scratch, Pj, oj, VFixed, pi, threads);
+
+				// The values no longer follow from the sweeps in memory, so these are forgotten.
+				for (int iRemaining = i; iRemaining < (int)k; iRemaining++) {
+					for (unsigned int s : Pj) {
+						values[oj[iRemaining]][s] = VPrime[oj[iRemaining]][s];
+					}
+					if (anderson) {
+						scratch->anderson[oj[iRemaining]].clear();
+					}
+				}
+				break;
+			}
+		}
+
+		// Setup V[i] with the values from the previous outer step which the sweeps read.
+		copy_fixed_values(*scratch, Pj, VFixed[oj[i]], VPrime[oj[i]]);
+		if (interval) {
+			copy_fixed_values(*scratch, Pj, workspace.get_fixed_upper_values()[oj[i]], ViUpper);
+		}
+
+		// Check if the slack of the previous rewards changed the actions of any state since V_i was last
+		// swept over the partition, in an earlier outer iteration.
+		bool changed = false;
+		if (interval || anderson) {
+			for (int s = 0; s < (int)Pj.size(); s++) {
+				if (scratch->swept[oj[i]] && scratch->ASwept[oj[i]][s] != AStar[oj[i]][s]) {
+					changed = true;
+				}
+				scratch->ASwept[oj[i]][s] = AStar[oj[i]][s];
+			}
+			scratch->swept[oj[i]] = true;
+		}
+
+		// With interval bounds, the bounds of V_i only hold for the actions they were swept over, e.g., a
+		// lower bound over more actions need not hold over fewer, so they are seeded again.
+		if (interval && changed) {
+			for (unsigned int s : Pj) {
+				VPrime[oj[i]][s] = model.get_min(oj[i]) / (1.0 - gamma);
+				ViUpper[s] = model.get_max(oj[i]) / (1.0 - gamma);
+			}
+		}
+
+		// Actions may only be eliminated if the sweeps are a contraction, i.e., without over-relaxation.
+		bool eliminate = (actionElimination && !interval && !(gaussSeidel && relaxation != 1.0));
+
+		// The slack within which actions are kept for the next reward; the last reward keeps only the best.
+		double etai = 0.0;
+		if (i != (int)k - 1) {
+			etai = (1.0 - gamma) * delta[oj[i]];
+		}
+
+		// The Q-values are only needed to prune the actions for the next reward, or to eliminate actions.
+		std::vector<std::vector<double> > *QiSweep = nullptr;
+		if (i != (int)k - 1 || eliminate) {
+			for (int s = 0; s < (int)Pj.size(); s++) {
+				Qi[s].resize(sets.get_size(AStar[oj[i]][s]));
+			}
+			QiSweep = &Qi;
+		}
+
+		std::vector<std::vector<double> > *QiUpperSweep = nullptr;
+		if (interval && i != (int)k - 1) {
+			for (int s = 0; s < (int)Pj.size(); s++) {
+				QiUpper[s].resize(sets.get_size(AStar[oj[i]][s]));
+			}
+			QiUpperSweep = &QiUpper;
+		}
+
+		// In single precision, the sweeps read and write a float copy of V_i, which is widened back once
+		// they are done.
+		std::vector<float> &ViSingle = scratch->ViSingle;
+		if (singlePrecision) {
+			for (unsigned int s : Pj) {
+				ViSingle[s] = (float)VPrime[oj[i]][s];
+			}
+			for (unsigned int s : scratch->boundary) {
+				ViSingle[s] = (float)VPrime[oj[i]][s];
+			}
+		}
+
+		double difference = convergenceCriterion + 1.0;
+		double previousDifference = std::numeric_limits<double>::max();
+		unsigned long long eliminated = 0;
+
+		// With interval bounds, the largest change of the upper bounds, and the gap at the target states.
+		double upperDifference = 0.0;
+		double gap = 0.0;
+
+		// With Anderson acceleration, each reward keeps its memory between outer iterations, so that it
+		// also extrapolates the single sweep of each iteration without the looping version. The sweeps
+		// in memory are of another map once the actions or the values outside the partition change, and
+		// are not those of the partition's values once these change, so then it starts empty.
+		unsigned long long accepted = 0;
+		unsigned long long rejected = 0;
+		LVIAndersonMemory *memory = nullptr;
+		if (anderson) {
+			memory = &scratch->anderson[oj[i]];
+
+			bool settled = !changed;
+			for (int b = 0; settled && memory->previous && b < (int)scratch->boundary.size(); b++) {
+				settled = (memory->boundary[b] == VPrime[oj[i]][scratch->boundary[b]]);
+			}
+			for (int s = 0; settled && memory->previous && s < (int)Pj.size(); s++) {
+				settled = (memory->G[s] == VPrime[oj[i]][Pj[s]]);
+			}
+			if (!settled) {
+				memory->clear();
+			}
+
+			for (int b = 0; b < (int)scratch->boundary.size(); b++) {
+				memory->boundary[b] = VPrime[oj[i]][scratch->boundary[b]];
+			}
+		}
+
+		// For this V_i, converge until you reach within epsilon of V_i^*.
+		unsigned int sweep = 0;
+		do {
+			// Start from the values extrapolated after the previous sweep, if any.
+			bool extrapolated = false;
+			if (anderson) {
+				extrapolated = memory->extrapolated;
+				for (int s = 0; s < (int)Pj.size(); s++) {
+					if (extrapolated) {
+						VPrime[oj[i]][Pj[s]] = memory->extrapolation[s];
+					}
+					scratch->andersonX[s] = VPrime[oj[i]][Pj[s]];
+				}
+			}
+
+			// For all the states, compute V_i(s). The upper bounds are swept first, so that the actions are
+			// those of the lower bounds.
+			if (singlePrecision) {
+				difference = compute_sweep(sets, AStar[oj[i]], oj[i], Pj, ViSingle, Vi, pij, threads, sweep, QiSweep);
+			} else {
+				if (interval) {
+					upperDifference = compute_sweep(sets, AStar[oj[i]], oj[i], Pj, ViUpper, Vi, pij, threads, sweep, QiUpperSweep);
+				}
+				difference = compute_sweep(sets, AStar[oj[i]], oj[i], Pj, VPrime[oj[i]], Vi, pij, threads, sweep, QiSweep);
+			}
+			sweep++;
+
+			// If the extrapolated values have a larger residual than the sweep they were extrapolated from,
+			// undo them, restart the memory, and sweep that sweep's values again, so that the values, the
+			// actions, and the Q-values are all of the same plain sweep. Then extrapolate the values the next
+			// sweep starts from, unless this one has already converged.
+			if (anderson) {
+				if (extrapolated && difference > memory->residual && difference > convergenceCriterion) {
+					for (int s = 0; s < (int)Pj.size(); s++) {
+						VPrime[oj[i]][Pj[s]] = memory->G[s];
+						scratch->andersonX[s] = memory->G[s];
+					}
+					memory->clear();
+					rejected++;
+
+					difference = compute_sweep(sets, AStar[oj[i]], oj[i], Pj, VPrime[oj[i]], Vi, pij, threads, sweep, QiSweep);
+					sweep++;
+				} else if (extrapolated) {
+					accepted++;
+				}
 
-PolicyMap *LVI::solve(LMDP *lmdp)
-{
-	// Handle the trivial case.
-	if (lmdp == nullptr) {
-		return nullptr;
-	}
+				memory->extrapolated = compute_anderson(*scratch, *memory, Pj, VPrime[oj[i]], difference > convergenceCriterion);
+				memory->residual = difference;
 
-	// Attempt to convert the states object into FiniteStates.
-	StatesMap *S = dynamic_cast<StatesMap *>(lmdp->get_states());
-	if (S == nullptr) {
-		throw StateException();
-	}
+				// The values are no longer the sweep of the previous values, so only this residual bounds them.
+				previousDifference = std::numeric_limits<double>::max();
+			}
 
-	// Attempt to convert the actions object into FiniteActions.
-	ActionsMap *A = dynamic_cast<ActionsMap *>(lmdp->get_actions());
-	if (A == nullptr) {
-		throw ActionException();
-	}
+			// The values this sweep's Q-values were computed from are within gamma / (1 - gamma) times the
+			// previous residual of V_i^*, and within 1 / (1 - gamma) times this residual, so each Q-value is
+			// within gamma times the smaller of the two of Q_i^*.
+			if (eliminate) {
+				double error = gamma / (1.0 - gamma) * std::min(gamma * previousDifference, difference);
+				eliminated += compute_A_eliminate(sets, AStar[oj[i]], Qi, error, etai);
+			}
+			if (!anderson) {
+				previousDifference = difference;
+			}
 
-	// Note: All forms of StateTransitions objects are valid here, since they all require get.
-	StateTransitions *T = lmdp->get_state_transitions();
+			// With interval bounds, the sweeps stop once the gap at the target states has closed, or once
+			// neither bound changes any more, e.g., since the gap depends on other partitions.
+			if (interval) {
+				gap = compute_gap(Pj, VPrime[oj[i]], ViUpper);
+			}
+		} while (loopingVersion && (interval ?
+					(gap > epsilon && std::max(difference, upperDifference) > convergenceCriterion) :
+					difference > convergenceCriterion)
+				&& !should_stop());
+
+		// Store the actions of the final sweep. The partitions are disjoint, so this needs no lock.
+		for (int s = 0; s < (int)Pj.size(); s++) {
+			pi[Pj[s]] = pij[s];
+		}
 
-	// Attempt to convert the rewards object into FactoredRewards. Also, ensure that the
-	// type of each element is SASRewards.
-	FactoredRewards *R = dynamic_cast<FactoredRewards *>(lmdp->get_rewards());
-	if (R == nullptr) {
-		throw RewardException();
-	}
-	/*
-	for (int i = 0; i < R->get_num_rewards(); i++) {
-		SASRewards *Ri = dynamic_cast<SASRewards *>(R->get(oj[i]));
-		if (Ri == nullptr) {
-			throw RewardException();
+		if (singlePrecision) {
+			for (unsigned int s : Pj) {
+				VPrime[oj[i]][s] = ViSingle[s];
+			}
 		}
-	}
-	*/
 
-	// Handle the other trivial case in which the slack variables were incorrectly defined.
-	if (lmdp->get_slack().size() != R->get_num_rewards()) {
-		throw RewardException();
-	}
-	for (int i = 0; i < (int)lmdp->get_slack().size(); i++) {
-		if (lmdp->get_slack().at(i) < 0.0) {
-			throw RewardException();
+		// Record the number of sweeps, which other partitions may be doing at the same time.
+		{
+			std::lock_guard<std::mutex> lock(partitionsMutex);
+			sweeps[oj[i]] += sweep;
+			backups += (unsigned long long)sweep * Pj.size() * (interval ? 2 : 1);
+			eliminations += eliminated;
+			andersonAccepted += accepted;
+			andersonRejected += rejected;
+			record_level(Pj, oj[i], sweep, sets, AStar[oj[i]]);
 		}
-	}
 
-	// Obtain the horizon and return the correct value iteration.
-//	Initial *s0 = lmdp->get_initial_state();
-	Horizon *h = lmdp->get_horizon();
-	if (h->is_finite()) {
-		throw CoreException();
+		// After everything, we can finally compute the set of actions ***for i + 1*** with the delta slack.
+		// If the final sweep left the values unchanged, its Q-values are exactly those of the final values.
+		// Bounds on the Q-values follow from any bounds on the values, so with interval bounds they are kept.
+		if (i != (int)k - 1) {
+			bool reuse = (interval || fusedPruning || difference == 0.0);
+
+			for (int s = 0; s < (int)Pj.size(); s++) {
+				// Use the delta function to compute the final set of AStar[i + 1].
+				// Otherwise, recompute the Q-values from the final values into the same buffer.
+				if (!reuse) {
+					double Vis = 0.0;
+					unsigned int a = 0;
+					compute_V(sets, AStar[oj[i]][s], oj[i], Pj[s], VPrime[oj[i]], Vis, a, Qi[s].data());
+				}
+				if (interval) {
+					compute_A_interval(sets, AStar[oj[i]][s], Qi[s], QiUpper[s], delta[oj[i]], AStar[oj[i + 1]][s]);
+				} else {
+					compute_A_delta(sets, AStar[oj[i]][s], Qi[s], delta[oj[i]], AStar[oj[i + 1]][s]);
+				}
+			}
+		}
+
+		// Copy the final results for these states.
+		for (unsigned int s : Pj) {
+			values[oj[i]][s] = VPrime[oj[i]][s];
+		}
+		if (interval) {
+			for (unsigned int s : Pj) {
+				valuesUpper[oj[i]][s] = ViUpper[s];
+			}
+		}
 	}
 
-	return solve_infinite_horizon(S, A, T, R, h,
-			lmdp->get_slack(), lmdp->get_partitions(), lmdp->get_orderings());
+	// Update the maximum difference found over all partitions after the subset
+	// of states have had VI executed. This does not follow the ordering, meaning
+	// that maxDifference stores the differences in order of 1, 2, 3, etc, not
+	// the ordering, e.g., 3, 1, 2, etc.
+	for (int i = 0; i < (int)k; i++) {
+		for (unsigned int s : Pj) {
+			if (fabs(VPrime[i][s] - VFixed[i][s]) > maxDifference[i]) {
+				maxDifference[i] = fabs(VPrime[i][s] - VFixed[i][s]);
+			}
+		}
+	}
 }
 
-std::vector<std::unordered_map<State *, double> > &LVI::get_V()
+void LVI::compute_fixed_levels(unsigned int level, LVIPartitionWorkspace &scratch,
+		const std::vector<unsigned int> &Pj, const std::vector<unsigned int> &oj,
+		const std::vector<std::vector<double> > &VFixed,
+		std::vector<unsigned int> &pi, ThreadPool *threads)
 {
-	return V;
-}
+	double gamma = model.get_discount_factor();
+	double convergenceCriterion = epsilon * std::max(0.1, (1.0 - gamma) / gamma);
+
+	const ActionSets &sets = scratch.sets;
+	std::vector<std::vector<unsigned int> > &AStar = scratch.AStar;
+	std::vector<std::vector<double> > &VPrime = scratch.VPrime;
+
+	// The remaining rewards keep the single action of each state. Their values are interleaved, so that
+	// each successor's rewards are read together; only the partition and its boundary are read.
+	std::vector<unsigned int> &rewards = scratch.rewards;
+	rewards.assign(oj.begin() + level, oj.end());
+	unsigned int r = (unsigned int)rewards.size();
+
+	std::vector<double> &VInterleaved = scratch.VInterleaved;
+	for (unsigned int q = 0; q < r; q++) {
+		const std::vector<double> &VFixedi = VFixed[rewards[q]];
+		for (unsigned int s : Pj) {
+			VInterleaved[(size_t)s * r + q] = VFixedi[s];
+		}
+		for (unsigned int s : scratch.boundary) {
+			VInterleaved[(size_t)s * r + q] = VFixedi[s];
+		}
+		AStar[rewards[q]] = AStar[oj[level]];
+	}
 
-PolicyMap *LVI::solve_infinite_horizon(StatesMap *S, ActionsMap *A,
-		StateTransitions *T, FactoredRewards *R, Horizon *h,
-		std::vector<float> &delta,
-		std::vector<std::vector<State *> > &P,
-		std::vector<std::vector<unsigned int> > &o)
-{
-	// Create the policy based on the horizon.
-	PolicyMap *policy = new PolicyMap(h);
+	std::vector<unsigned int> &pij = scratch.pij;
+	for (int s = 0; s < (int)Pj.size(); s++) {
+		const uint64_t *mask = sets.get(AStar[oj[level]][s]);
+		for (unsigned int w = 0; w < sets.get_num_words(); w++) {
+			if (mask[w] != 0) {
+				pij[s] = w * 64 + __builtin_ctzll(mask[w]);
+				break;
+			}
+		}
+	}
 
-	// The value of the states, one for each reward.
-	V.clear();
-	V.resize(R->get_num_rewards());
+	std::vector<double> &VNext = scratch.VNext;
+	std::vector<double> &difference = scratch.difference;
+	difference.resize(rewards.size());
+
+	// Converge until every remaining reward is within epsilon of its values under the policy.
+	unsigned int sweep = 0;
+	double maxDifference = 0.0;
+	do {
+		maxDifference = compute_fused_sweep(rewards, Pj, pij, VInterleaved, VNext, difference, threads, sweep);
+		sweep++;
+	} while (loopingVersion && maxDifference > convergenceCriterion && !should_stop());
+
+	for (unsigned int q = 0; q < r; q++) {
+		std::vector<double> &VPrimei = VPrime[rewards[q]];
+		for (unsigned int s : Pj) {
+			VPrimei[s] = VInterleaved[(size_t)s * r + q];
+		}
+	}
 
-	// We will want to remember the previous fixed values of states, too.
-	std::vector<std::unordered_map<State *, double> > VFixed;
-	VFixed.resize(R->get_num_rewards());
+	for (int s = 0; s < (int)Pj.size(); s++) {
+		pi[Pj[s]] = pij[s];
+	}
 
-	// Default all values.
-	for (auto state : *S) {
-		State *s = resolve(state);
-		for (int i = 0; i < (int)R->get_num_rewards(); i++) {
-			V[i][s] = 0.0;
-			VFixed[i][s] = 0.0;
+	// Other partitions may be writing to the counts at the same time.
+	{
+		std::lock_guard<std::mutex> lock(partitionsMutex);
+		for (unsigned int i : rewards) {
+			sweeps[i] += sweep;
+			backups += (unsigned long long)sweep * Pj.size();
+			record_level(Pj, i, sweep, sets, AStar[i]);
 		}
 	}
+}
 
-	// Compute the convergence criterion.
-	double convergenceCriterion = epsilon * std::max(0.1, (1.0 - h->get_discount_factor()) / h->get_discount_factor());
-	bool converged = false;
+void LVI::compute_policy_evaluation(const std::vector<unsigned int> &pi, std::vector<std::vector<double> > &values,
+		ThreadPool *threads)
+{
+	unsigned int n = model.get_num_states();
+	unsigned int k = model.get_num_rewards();
+	double gamma = model.get_discount_factor();
+	double convergenceCriterion = epsilon * std::max(0.1, (1.0 - gamma) / gamma);
+
+	// All of the states are evaluated at once, each with the action the policy takes there.
+	std::vector<unsigned int> states(n);
+	for (int s = 0; s < (int)n; s++) {
+		states[s] = s;
+		if (pi[s] >= model.get_num_actions()) {
+			throw PolicyException();
+		}
+	}
 
-	std::vector<std::vector<double> > difference;
-	difference.resize(P.size());
-	for (int j = 0; j < (int)P.size(); j++) {
-		difference[j].resize(R->get_num_rewards());
+	std::vector<unsigned int> rewards(k);
+	for (int i = 0; i < (int)k; i++) {
+		rewards[i] = i;
 	}
 
-	// After setting up everything, begin timing.
-	auto start = std::chrono::high_resolution_clock::now();
+	std::vector<double> VInterleaved((size_t)n * k);
+	for (int s = 0; s < (int)n; s++) {
+		for (int i = 0; i < (int)k; i++) {
+			VInterleaved[(size_t)s * k + i] = values[i][s];
+		}
+	}
 
-	std::cout << "Starting...\n"; std::cout.flush();
+	std::vector<double> VNext((size_t)n * k);
+	std::vector<double> difference(k);
 
-	//*
-	// ------------------------------------------------------------------------------
-	// ------------------------------------------------------------------------------
-	// ------------------------------------------------------------------------------
+	unsigned int sweep = 0;
+	double maxDifference = 0.0;
+	do {
+		maxDifference = compute_fused_sweep(rewards, states, pi, VInterleaved, VNext, difference, threads, sweep);
+		sweep++;
+	} while (maxDifference > convergenceCriterion && !should_stop());
 
-	// Print out the iteration's convergence table result.
-	printf("Iterations      ");
-	for (int j = 0; j < (int)P.size(); j++) {
-		for (int i = 0; i < (int)R->get_num_rewards(); i++) {
-			std::cout << o[j][i] << " ";
-		}
-		if (j != (int)P.size() - 1) {
-			std::cout << "    ";
+	for (int s = 0; s < (int)n; s++) {
+		for (int i = 0; i < (int)k; i++) {
+			values[i][s] = VInterleaved[(size_t)s * k + i];
 		}
 	}
-	std::cout << "    ";
-	for (int j = 0; j < (int)P.size(); j++) {
-		for (int i = 0; i < (int)R->get_num_rewards(); i++) {
-			printf("o(%i) = %-3i ", i, o[j][i]);
-		}
+
+	for (int i = 0; i < (int)k; i++) {
+		sweeps[i] += sweep;
 	}
-	std::cout << std::endl; std::cout.flush();
+	backups += (unsigned long long)sweep * n * k;
+}
 
-	// ------------------------------------------------------------------------------
-	// ------------------------------------------------------------------------------
-	// ------------------------------------------------------------------------------
-	//*/
+double LVI::compute_fused_sweep(const std::vector<unsigned int> &rewards,
+		const std::vector<unsigned int> &Pj, const std::vector<unsigned int> &pij,
+		std::vector<double> &values, std::vector<double> &VNext,
+		std::vector<double> &difference, ThreadPool *threads, unsigned int sweep)
+{
+	unsigned int k = model.get_num_rewards();
+	unsigned int m = model.get_num_actions();
+	unsigned int r = (unsigned int)rewards.size();
+
+	const unsigned int *rows = model.get_rows().data();
+	const unsigned int *successors = model.get_successors().data();
+	const double *T = model.get_probabilities().data();
+	const double *R = model.get_expected_rewards_interleaved().data();
+	double gamma = model.get_discount_factor();
+	double *V = values.data();
+
+	// Back up every reward of a state at once, reading each of its successors only once.
+	auto backup = [&](unsigned int s, double *VNexts) {
+		for (unsigned int q = 0; q < r; q++) {
+			VNexts[q] = 0.0;
+		}
 
-	// Iterate the outer loop until the convergence criterion is satisfied.
-	int counter = 1;
-//	while (counter < 30) {
-	while (!converged) {
-		// Update VFixed to the previous value of V.
-		for (auto state : *S) {
-			State *s = resolve(state);
-			for (int i = 0; i < (int)R->get_num_rewards(); i++) {
-				VFixed[i][s] = V[i][s];
+		unsigned int row = Pj[s] * m + pij[s];
+		for (unsigned int t = rows[row]; t < rows[row + 1]; t++) {
+			const double *Vt = V + (size_t)successors[t] * r;
+			for (unsigned int q = 0; q < r; q++) {
+				VNexts[q] += T[t] * Vt[q];
 			}
 		}
 
-		converged = true;
+		const double *Rrow = R + (size_t)row * k;
+		for (unsigned int q = 0; q < r; q++) {
+			VNexts[q] = Rrow[rewards[q]] + gamma * VNexts[q];
+		}
+	};
 
-		// For each of the partitions, run value iteration. Each time, copy the resulting value functions.
-		for (int j = 0; j < (int)P.size(); j++) {
-			// Reset the difference for *all* of the variables.
-			for (int i = 0; i < (int)R->get_num_rewards(); i++) {
-				difference[j][i] = 0.0;
+	for (unsigned int q = 0; q < r; q++) {
+		difference[q] = 0.0;
+	}
+
+	if (!gaussSeidel) {
+		// Each thread takes a contiguous chunk of the partition and keeps its own differences.
+		threads->run(Pj.size(), [&](unsigned int worker, unsigned int begin, unsigned int end) {
+			std::vector<double> &workerDifference = threads->get_scratch(worker);
+			workerDifference.assign(r, 0.0);
+
+			for (unsigned int s = begin; s < end; s++) {
+				double *VNexts = VNext.data() + (size_t)s * r;
+				backup(s, VNexts);
+
+				for (unsigned int q = 0; q < r; q++) {
+					workerDifference[q] = std::max(workerDifference[q], std::fabs(V[(size_t)Pj[s] * r + q] - VNexts[q]));
+				}
 			}
+		});
 
-			compute_partition(S, A, T, R, h, delta, P[j], o[j], VFixed, V, policy, difference[j]);
+		for (unsigned int worker = 0; worker < threads->get_num_threads(); worker++) {
+			for (unsigned int q = 0; q < r; q++) {
+				difference[q] = std::max(difference[q], threads->get_scratch(worker)[q]);
+			}
 		}
 
-		// Check for convergence.
-		for (int j = 0; j < (int)P.size(); j++) {
-			for (int i = 0; i < (int)R->get_num_rewards(); i++) {
-				if (difference[j][i] > convergenceCriterion) {
-					converged = false;
-				}
+		for (int s = 0; s < (int)Pj.size(); s++) {
+			for (unsigned int q = 0; q < r; q++) {
+				V[(size_t)Pj[s] * r + q] = VNext[(size_t)s * r + q];
 			}
 		}
+	} else {
+		bool backward = (visitOrder == LVI_VISIT_BACKWARD ||
+				(visitOrder == LVI_VISIT_ALTERNATING && sweep % 2 == 1));
 
-		//*
-		// ------------------------------------------------------------------------------
-		// ------------------------------------------------------------------------------
-		// ------------------------------------------------------------------------------
+		// Update the values in place, as compute_sweep does.
+		for (int p = 0; p < (int)Pj.size(); p++) {
+			int s = backward ? (int)Pj.size() - 1 - p : p;
 
-		// Print out the iteration's convergence table result.
-		printf("Iteration %-3i [ ", counter);
+			double *VNexts = VNext.data() + (size_t)s * r;
+			backup(s, VNexts);
 
-		float convergingMax = 0.0;
+			for (unsigned int q = 0; q < r; q++) {
+				double &Vis = V[(size_t)Pj[s] * r + q];
+				if (relaxation != 1.0) {
+					VNexts[q] = Vis + relaxation * (VNexts[q] - Vis);
+				}
 
-		for (int j = 0; j < (int)P.size(); j++) {
-//			int convergedIndex = 1;
+				difference[q] = std::max(difference[q], std::fabs(Vis - VNexts[q]));
+				Vis = VNexts[q];
+			}
+		}
+	}
 
-			for (int i = 0; i < (int)R->get_num_rewards(); i++) {
-				// NOTE: Some value functions in the ordering may converge before the ones before them, but this is
-				// not guaranteed. The only guarantee is that once a 'parent' has converged, its 'child' will converge.
-				// Eventually, this must include all value functions over all partitions.
-				if (difference[j][o[j][i]] > convergenceCriterion) {
-					std::cout << "x ";
+	return *std::max_element(difference.begin(), difference.end());
+}
 
-//					convergedIndex--;
-				} else {
-					std::cout << "o ";
-				}
+template <typename Value>
+double LVI::compute_sweep(const ActionSets &sets, const std::vector<unsigned int> &Ai, unsigned int i,
+		const std::vector<unsigned int> &Pj, std::vector<Value> &Vi,
+		std::vector<double> &ViNext, std::vector<unsigned int> &pij,
+		ThreadPool *threads, unsigned int sweep,
+		std::vector<std::vector<double> > *Qi)
+{
+	double difference = 0.0;
 
-//				if (convergedIndex >= 0) {
-					if (difference[j][o[j][i]] > convergingMax) {
-						convergingMax = difference[j][o[j][i]];
-					}
-//				}
-			}
+	if (!gaussSeidel) {
+		// Each thread takes a contiguous chunk of the partition; the sweep only reads Vi and only writes
+		// ViNext and pij, so no synchronization is needed. Each keeps its maximal difference in its scratch.
+		threads->run(Pj.size(), [&](unsigned int worker, unsigned int begin, unsigned int end) {
+			double workerDifference = 0.0;
 
-			if (j != (int)P.size() - 1) {
-				std::cout << "| ";
+			for (unsigned int s = begin; s < end; s++) {
+				// Update V according to the previously converged subset of actions. The difference is that of
+				// the value as it is stored.
+				compute_V(sets, Ai[s], i, Pj[s], Vi, ViNext[s], pij[s], Qi != nullptr ? (*Qi)[s].data() : nullptr);
+				ViNext[s] = (Value)ViNext[s];
+
+				// Continue to compute the infinity normed difference between value functions for convergence checking.
+				if (std::fabs(Vi[Pj[s]] - ViNext[s]) > workerDifference) {
+					workerDifference = std::fabs(Vi[Pj[s]] - ViNext[s]);
+				}
 			}
-		}
 
-		std::cout << "]   ";
+			threads->get_scratch(worker).assign(1, workerDifference);
+		});
 
-		for (int j = 0; j < (int)P.size(); j++) {
-			for (int i = 0; i < (int)R->get_num_rewards(); i++) {
-				// NOTE: Some value functions in the ordering may converge before the ones before them, but this is
-				// not guaranteed. The only guarantee is that once a 'parent' has converged, its 'child' will converge.
-				// Eventually, this must include all value functions over all partitions.
-//				std::cout << difference[j][i] << "\t";
-				printf("%10.6f ", difference[j][o[j][i]]);
-			}
+		// The maximum is independent of the order in which it is taken, so merging the threads' results
+		// gives exactly the serial difference.
+		for (unsigned int worker = 0; worker < threads->get_num_threads(); worker++) {
+			difference = std::max(difference, threads->get_scratch(worker)[0]);
 		}
 
-		std::cout << "\t\t" << convergingMax << std::endl; std::cout.flush();
+		// After iterating over states, update the real V[i] for all s.
+		for (int s = 0; s < (int)Pj.size(); s++) {
+			Vi[Pj[s]] = ViNext[s];
+		}
+	} else {
+		// Determine the direction of this sweep over the partition.
+		bool backward = (visitOrder == LVI_VISIT_BACKWARD ||
+				(visitOrder == LVI_VISIT_ALTERNATING && sweep % 2 == 1));
 
-		counter++;
+		// Update the values in place, so that later states in the sweep already use the new values of the
+		// earlier ones. This is inherently sequential, so the threads are not used.
+		for (int q = 0; q < (int)Pj.size(); q++) {
+			int s = backward ? (int)Pj.size() - 1 - q : q;
 
-		// ------------------------------------------------------------------------------
-		// ------------------------------------------------------------------------------
-		// ------------------------------------------------------------------------------
-		//*/
-	}
+			compute_V(sets, Ai[s], i, Pj[s], Vi, ViNext[s], pij[s], Qi != nullptr ? (*Qi)[s].data() : nullptr);
 
-	std::cout << "Complete LVI." << std::endl; std::cout.flush();
+			// Over-relax the update, unless this is plain Gauss-Seidel.
+			if (relaxation != 1.0) {
+				ViNext[s] = Vi[Pj[s]] + relaxation * (ViNext[s] - Vi[Pj[s]]);
+			}
+			ViNext[s] = (Value)ViNext[s];
 
-	// After the main loop is complete, end timing. Also, output the result of the computation time.
-	auto end = std::chrono::high_resolution_clock::now();
-	auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(end - start);
-	std::cout << "Total Elapsed Time (CPU Version): " << elapsed.count() << std::endl; std::cout.flush();
+			if (std::fabs(Vi[Pj[s]] - ViNext[s]) > difference) {
+				difference = std::fabs(Vi[Pj[s]] - ViNext[s]);
+			}
 
-	return policy;
+			Vi[Pj[s]] = ViNext[s];
+		}
+	}
+
+	return difference;
 }
 
-void LVI::compute_partition(StatesMap *S, ActionsMap *A, StateTransitions *T,
-		FactoredRewards *R, Horizon *h, std::vector<float> &delta,
-		std::vector<State *> &Pj, std::vector<unsigned int> &oj,
-		std::vector<std::unordered_map<State *, double> > &VFixed,
-		std::vector<std::unordered_map<State *, double> > &V,
-		PolicyMap *policy, std::vector<double> &maxDifference)
+unsigned long long LVI::compute_A_eliminate(ActionSets &sets, std::vector<unsigned int> &Ai,
+		std::vector<std::vector<double> > &Qi, double error, double etai)
 {
-	// The value of the states, one for each reward.
-	std::vector<std::unordered_map<State *, double> > VPrime;
-	VPrime.resize(R->get_num_rewards());
+	unsigned long long eliminated = 0;
 
-	// Compute the convergence criterion which follows from the proof of convergence.
-	double convergenceCriterion = epsilon * std::max(0.1, (1.0 - h->get_discount_factor()) / h->get_discount_factor());
+	for (int s = 0; s < (int)Ai.size(); s++) {
+		double maxQisa = -std::numeric_limits<double>::max();
+		for (double Qisa : Qi[s]) {
+			if (Qisa > maxQisa) {
+				maxQisa = Qisa;
+			}
+		}
+
+		// An action is eliminated if even its upper bound is further than eta_i below the lower bound of
+		// the best action. The margin for machine precision matches compute_A_delta.
+		double threshold = maxQisa - 2.0 * error - etai - std::numeric_limits<double>::epsilon() * 10.0;
+
+		// Most states lose nothing, so only their Q-values are looked at.
+		bool any = false;
+		for (double Qisa : Qi[s]) {
+			if (Qisa < threshold) {
+				any = true;
+				break;
+			}
+		}
+		if (!any) {
+			continue;
+		}
 
-	// Remember the set of actions available to each of the value functions. This will be computed at the end of each step.
-	std::vector<std::unordered_map<State *, std::vector<Action *> > > AStar;
-	AStar.resize(R->get_num_rewards());
+		// Remove the eliminated actions from both the set and its Q-values, keeping them parallel.
+		uint64_t *mask = sets.copy(Ai[s]);
 
-	// Setup the initial set of actions for i = 1.
-	for (auto s : Pj) {
-		for (auto action : *A) {
-			Action *a = resolve(action);
-			AStar[oj[0]][s].push_back(a);
+		int q = 0;
+		int kept = 0;
+		for (unsigned int w = 0; w < sets.get_num_words(); w++) {
+			for (uint64_t bits = mask[w]; bits != 0; bits &= bits - 1) {
+				if (Qi[s][q] < threshold) {
+					mask[w] &= ~(bits & -bits);
+					eliminated++;
+				} else {
+					Qi[s][kept] = Qi[s][q];
+					kept++;
+				}
+				q++;
+			}
 		}
+
+		Ai[s] = sets.intern(mask);
+		Qi[s].resize(kept);
 	}
 
-	// For each of the value functions, we will compute the actions set.
-	for (int i = 0; i < (int)R->get_num_rewards(); i++) {
-//std::cout << "Starting VI for Reward " << oj[i] << std::endl; std::cout.flush();
+	return eliminated;
+}
+
+void LVI::compute_A_argmax(ActionSets &sets, unsigned int Ai, unsigned int i,
+		unsigned int s, const std::vector<double> &Vi,
+		unsigned int &AiPlus1)
+{
+	compute_A_delta(sets, Ai, i, s, Vi, 0.0, AiPlus1);
+}
 
-		SASRewards *Ri = dynamic_cast<SASRewards *>(R->get(oj[i]));
+void LVI::compute_A_delta(ActionSets &sets, unsigned int Ai, unsigned int i,
+		unsigned int s, const std::vector<double> &Vi,
+		float deltai,
+		unsigned int &AiPlus1)
+{
+	std::vector<double> Qis;
+	Qis.reserve(sets.get_size(Ai));
 
-		// Setup V[i] with initial values of 0.0.
-		for (auto state : *S) {
-			State *s = resolve(state);
+	compute_A_delta(sets, Ai, i, s, Vi, deltai, Qis, AiPlus1);
+}
 
-			// NOTE: You can remove the if statement and just use VStar.at(oj[i]).at(s)!!! It is faster, since it
-			// does not matter which V[.] you initialize it to be.
+void LVI::compute_A_delta(ActionSets &sets, unsigned int Ai, unsigned int i,
+		unsigned int s, const std::vector<double> &Vi,
+		float deltai, std::vector<double> &Qis,
+		unsigned int &AiPlus1)
+{
+	Qis.clear();
 
-			// If it is in the partition, then it will be updated, so initialize to 0.0.
-//			if (std::find(Pj.begin(), Pj.end(), s) != Pj.end()) {
-//				V[oj[i]][s] = 0.0;
-//			} else {
-				VPrime[oj[i]][s] = VFixed.at(oj[i]).at(s);
-//			}
+	// For all the actions, record the value of each Q_i(s, a) for all actions a in A.
+	const uint64_t *mask = sets.get(Ai);
+	for (unsigned int w = 0; w < sets.get_num_words(); w++) {
+		for (uint64_t bits = mask[w]; bits != 0; bits &= bits - 1) {
+			Qis.push_back(compute_Q(i, s, w * 64 + __builtin_ctzll(bits), Vi));
 		}
+	}
 
-		double difference = convergenceCriterion + 1.0;
+	compute_A_delta(sets, Ai, Qis, deltai, AiPlus1);
+}
 
-		// For this V_i, converge until you reach within epsilon of V_i^*.
-		do {
-//std::cout << "Value Iteration: Convergence Check: " << difference << " vs " << convergenceCriterion << std::endl;
+void LVI::compute_A_delta(ActionSets &sets, unsigned int Ai,
+		const std::vector<double> &Qis, float deltai,
+		unsigned int &AiPlus1)
+{
+	double maxQisa = -std::numeric_limits<double>::max();
 
-			difference = 0.0;
+	// Compute max Q_i(s, a) over the current set of actions.
+	for (double Qisa : Qis) {
+		if (Qisa > maxQisa) {
+			maxQisa = Qisa;
+		}
+	}
 
-			// Copy the value of all states for this i. The constant type casting forces it to use the copy
-			// assignment instead of the move one.
-			std::unordered_map<State *, double> Vi;
-			for (auto s : Pj) {
-				Vi[s] = VPrime.at(oj[i]).at(s);
+	// Compute eta_i.
+	double etai = (1.0 - model.get_discount_factor()) * deltai;
+
+	// Compute the new A_{i+1} using the Q-values and current A_i. The mask of A_i is copied, since
+	// interning the new set may move it.
+	uint64_t *mask = sets.copy(Ai);
+
+	int q = 0;
+	for (unsigned int w = 0; w < sets.get_num_words(); w++) {
+		for (uint64_t bits = mask[w]; bits != 0; bits &= bits - 1) {
+			// Check if this is difference within eta_i, but account for machine precision issues
+			// within 1 order of magnitude.
+			if (!(fabs(maxQisa - Qis[q]) < etai + std::numeric_limits<double>::epsilon() * 10.0)) {
+				mask[w] &= ~(bits & -bits);
 			}
+			q++;
+		}
+	}
 
-			// For all the states, compute V_i(s).
-			for (auto s : Pj) {
-				Action *a = nullptr;
+	AiPlus1 = sets.intern(mask);
+}
+
+void LVI::compute_A_interval(ActionSets &sets, unsigned int Ai,
+		const std::vector<double> &QisLower, const std::vector<double> &QisUpper, float deltai,
+		unsigned int &AiPlus1)
+{
+	double maxQisa = -std::numeric_limits<double>::max();
 
-				// Update V according to the previously converged subset of actions.
-				compute_V(S, AStar.at(oj[i]).at(s), T, Ri, h, s, VPrime.at(oj[i]), Vi, a);
+	// The best action is at least the largest lower bound.
+	for (double Qisa : QisLower) {
+		if (Qisa > maxQisa) {
+			maxQisa = Qisa;
+		}
+	}
 
-				// Store the action taken as part of the policy. This will change all the time, especially over i, but whatever.
-				policy->set(s, a);
+	double etai = (1.0 - model.get_discount_factor()) * deltai;
 
-				// Continue to compute the infinity normed difference between value functions for convergence checking.
-				if (std::fabs(VPrime[oj[i]][s] - Vi[s]) > difference) {
-					difference = std::fabs(VPrime.at(oj[i]).at(s) - Vi.at(s));
-				}
-			}
+	uint64_t *mask = sets.copy(Ai);
 
-			// After iterating over states, update the real V[i] for all s.
-			for (auto s : Pj) {
-				VPrime.at(oj[i]).at(s) = Vi.at(s);
+	// Keep each action whose upper bound may still be within eta_i of the best action, with the same margin
+	// for machine precision as compute_A_delta.
+	int q = 0;
+	for (unsigned int w = 0; w < sets.get_num_words(); w++) {
+		for (uint64_t bits = mask[w]; bits != 0; bits &= bits - 1) {
+			if (!(maxQisa - QisUpper[q] < etai + std::numeric_limits<double>::epsilon() * 10.0)) {
+				mask[w] &= ~(bits & -bits);
 			}
-		} while (loopingVersion && difference > convergenceCriterion);
+			q++;
+		}
+	}
 
-//std::cout << "Value Iteration: Convergence Check: " << difference << " vs " << convergenceCriterion << std::endl;
+	AiPlus1 = sets.intern(mask);
+}
 
-		// After everything, we can finally compute the set of actions ***for i + 1*** with the delta slack.
-		if (i != (int)R->get_num_rewards() - 1) {
-			for (auto s : Pj) {
-				// Use the delta function to compute the final set of AStar[i + 1].
-				// NOTE: Intentionally, we use [s] for AStar, because this has not yet been defined for i + 1. This
-				// creates the vector for state s in place.
-				compute_A_delta(S, AStar.at(oj[i]).at(s), T, Ri, h, s, VPrime.at(oj[i]), delta[oj[i]], AStar.at(oj[i + 1])[s]);
-			}
+double LVI::compute_gap(const std::vector<unsigned int> &Pj, const std::vector<double> &lower,
+		const std::vector<double> &upper) const
+{
+	double gap = 0.0;
+	bool targeted = false;
 
-//// DEBUG!!!! NOTE: ALL ACTIONS ARE POSSIBLE FOR AStar.at(oj[0])!!!!!!!!!!!!!!!!!
-//for (auto s : Pj) {
-//std::cout << AStar.at(oj[i + 1]).at(s).size() << " ";
-//}
-//std::cout << std::endl; std::cout.flush();
+	for (unsigned int s : Pj) {
+		if (intervalTargetStates[s]) {
+			gap = std::max(gap, upper[s] - lower[s]);
+			targeted = true;
 		}
+	}
 
-		// Copy the final results for these states.
-		for (auto s : Pj) {
-//			// Also, update the maximum difference found over all partitions after the subset
-//			// of states have had VI executed.
-//			if (fabs(V.at(oj[i]).at(s) - VPrime.at(oj[i]).at(s)) > maxDifference[oj[i]]) {
-//				maxDifference[oj[i]] = fabs(V.at(oj[i]).at(s) - VPrime.at(oj[i]).at(s));
-//			}
-
-			V[oj[i]][s] = VPrime.at(oj[i]).at(s);
+	if (!targeted) {
+		for (unsigned int s : Pj) {
+			gap = std::max(gap, upper[s] - lower[s]);
 		}
 	}
 
-	/*
-	std::cout << "Completed policy for partition. Now computing actual V." << std::endl; std::cout.flush();
+	return gap;
+}
 
-	// At the very end, compute the final values of V following the policy.
-	for (int i = 0; i < R->get_num_rewards(); i++) {
-		std::cout << "Starting VI for Reward " << oj[i] << std::endl; std::cout.flush();
+unsigned int LVI::get_anderson_active_depth() const
+{
+	if (singlePrecision || is_interval()) {
+		return 0;
+	}
+	return andersonDepth;
+}
 
-		const SASRewards *Ri = dynamic_cast<const SASRewards *>(R->get(oj[i]));
+bool LVI::compute_anderson(LVIPartitionWorkspace &scratch, LVIAndersonMemory &memory,
+		const std::vector<unsigned int> &Pj, const std::vector<double> &Vi, bool extrapolate)
+{
+	unsigned int size = (unsigned int)Pj.size();
+	unsigned int depth = andersonDepth;
+
+	std::vector<double> &X = scratch.andersonX;
+	std::vector<double> &G = memory.G;
+	std::vector<double> &F = memory.F;
+	std::vector<double> &Gram = memory.Gram;
+
+	// Store the differences from the previous sweep in the oldest column, which keeps the columns in
+	// memory at [0, columns), and update its inner products with all of them.
+	if (memory.previous) {
+		unsigned int column = memory.next;
+		double *DF = &memory.DF[(std::size_t)column * size];
+		double *DG = &memory.DG[(std::size_t)column * size];
+
+		for (unsigned int s = 0; s < size; s++) {
+			DF[s] = (Vi[Pj[s]] - X[s]) - F[s];
+			DG[s] = Vi[Pj[s]] - G[s];
+		}
 
-		for (auto state : *S) {
-			const State *s = resolve(state);
+		memory.next = (column + 1) % depth;
+		memory.columns = std::min(memory.columns + 1, depth);
 
-//			if (std::find(Pj.begin(), Pj.end(), s) != Pj.end()) {
-//				V[oj[i]][s] = 0.0;
-//			} else {
-				V[oj[i]][s] = VPrime.at(oj[i]).at(s);
-//			}
+		for (unsigned int c = 0; c < memory.columns; c++) {
+			const double *DFc = &memory.DF[(std::size_t)c * size];
+			double product = 0.0;
+			for (unsigned int s = 0; s < size; s++) {
+				product += DF[s] * DFc[s];
+			}
+			Gram[column * depth + c] = product;
+			Gram[c * depth + column] = product;
 		}
+	}
 
-		double difference = convergenceCriterion + 1.0;
+	for (unsigned int s = 0; s < size; s++) {
+		F[s] = Vi[Pj[s]] - X[s];
+		G[s] = Vi[Pj[s]];
+	}
+	memory.previous = true;
 
-		// For this V_i, converge until you reach within epsilon of V_i^*.
-		while (difference > convergenceCriterion) {
-//			std::cout << "Computing Final Values: Convergence Check: " << difference << " vs " << convergenceCriterion << std::endl;
+	unsigned int columns = memory.columns;
+	if (!extrapolate || columns == 0) {
+		return false;
+	}
 
-			difference = 0.0;
+	// Find the combination of the residual differences closest to the residual, from the normal equations,
+	// with a little regularization since consecutive residuals are often nearly parallel.
+	std::vector<double> &system = scratch.andersonSystem;
+	unsigned int width = columns + 1;
 
-			// For all the states in the partition, compute V_i(s).
-			for (auto s : Pj) {
-				double Vis = compute_Q(S, T, Ri, h, s, policy->get(s), V[oj[i]]);
+	double scale = 0.0;
+	for (unsigned int c = 0; c < columns; c++) {
+		scale = std::max(scale, Gram[c * depth + c]);
+	}
+	if (scale == 0.0) {
+		return false;
+	}
 
-				if (std::fabs(V[oj[i]][s] - Vis) > difference) {
-					difference = std::fabs(V[oj[i]][s] - Vis);
-				}
+	for (unsigned int r = 0; r < columns; r++) {
+		for (unsigned int c = 0; c < columns; c++) {
+			system[r * width + c] = Gram[r * depth + c];
+		}
+		system[r * width + r] += scale * 1e-10;
 
-				V[oj[i]][s] = Vis;
-			}
+		const double *DFr = &memory.DF[(std::size_t)r * size];
+		double product = 0.0;
+		for (unsigned int s = 0; s < size; s++) {
+			product += DFr[s] * F[s];
 		}
+		system[r * width + columns] = product;
 	}
-	//*/
 
-	// Update the maximum difference found over all partitions after the subset
-	// of states have had VI executed. This does not follow the ordering, meaning
-	// that maxDifference stores the differences in order of 1, 2, 3, etc, not
-	// the ordering, e.g., 3, 1, 2, etc. Also, this is equivalent to above.. so remove this.
-	for (int i = 0; i < (int)R->get_num_rewards(); i++) {
-		for (auto s : Pj) {
-			if (fabs(VPrime.at(i).at(s) - VFixed.at(i).at(s)) > maxDifference[i]) {
-				maxDifference[i] = fabs(VPrime.at(i).at(s) - VFixed.at(i).at(s));
+	// Gaussian elimination with partial pivoting, then back substitution into the last column.
+	for (unsigned int c = 0; c < columns; c++) {
+		unsigned int pivot = c;
+		for (unsigned int r = c + 1; r < columns; r++) {
+			if (std::fabs(system[r * width + c]) > std::fabs(system[pivot * width + c])) {
+				pivot = r;
+			}
+		}
+		if (system[pivot * width + c] == 0.0) {
+			return false;
+		}
+		if (pivot != c) {
+			for (unsigned int q = 0; q < width; q++) {
+				std::swap(system[c * width + q], system[pivot * width + q]);
+			}
+		}
+
+		for (unsigned int r = c + 1; r < columns; r++) {
+			double factor = system[r * width + c] / system[c * width + c];
+			for (unsigned int q = c; q < width; q++) {
+				system[r * width + q] -= factor * system[c * width + q];
 			}
 		}
 	}
 
-//	std::cout << "Completed partition." << std::endl; std::cout.flush();
+	for (int c = (int)columns - 1; c >= 0; c--) {
+		double coefficient = system[c * width + columns];
+		for (unsigned int q = c + 1; q < columns; q++) {
+			coefficient -= system[c * width + q] * system[q * width + columns];
+		}
+		system[c * width + columns] = coefficient / system[c * width + c];
+	}
+
+	// The extrapolated values are the sweep's, less the same combination of the value differences.
+	for (unsigned int s = 0; s < size; s++) {
+		double ViNexts = G[s];
+		for (unsigned int c = 0; c < columns; c++) {
+			ViNexts -= system[c * width + columns] * memory.DG[(std::size_t)c * size + s];
+		}
+		memory.extrapolation[s] = ViNexts;
+	}
+
+	return true;
 }
 
-void LVI::compute_A_argmax(StatesMap *S, std::vector<Action *> &Ai,
-		StateTransitions *T, SASRewards *Ri, Horizon *h,
-		State *s, std::unordered_map<State *, double> &Vi,
-		std::vector<Action *> &AiPlus1)
+bool LVI::is_interval() const
 {
-	compute_A_delta(S, Ai, T, Ri, h, s, Vi, 0.0, AiPlus1);
+	return intervalBounds && model.get_discount_factor() < 1.0 && !singlePrecision &&
+			!(gaussSeidel && relaxation != 1.0);
 }
 
-void LVI::compute_A_delta(StatesMap *S, std::vector<Action *> &Ai,
-		StateTransitions *T, SASRewards *Ri, Horizon *h,
-		State *s, std::unordered_map<State *, double> &Vi,
-		float deltai,
-		std::vector<Action *> &AiPlus1)
+void LVI::seed_interval_bounds(const std::vector<std::vector<unsigned int> > &PIndices)
 {
-	double maxQisa = -std::numeric_limits<double>::max();
-	std::vector<double> Qis;
-
-	// For all the actions, compute max Q_i(s, a) over the current set of actions. Also, record the
-	// value of each Q_i(s, a) for all actions a in A.
-	for (int i = 0; i < (int)Ai.size(); i++) {
-		double Qisa = compute_Q(S, T, Ri, h, s, Ai[i], Vi);
-		Qis.push_back(Qisa);
-
-		// Determine the maximum Q_i(s, a) value.
-		if (Qisa > maxQisa) {
-			maxQisa = Qisa;
+	unsigned int n = model.get_num_states();
+	unsigned int k = model.get_num_rewards();
+	double gamma = model.get_discount_factor();
+
+	// Without targets, every state in a partition is one; a state in no partition keeps its bounds.
+	intervalTargetStates.assign(n, false);
+	if (intervalTargets.empty()) {
+		for (const std::vector<unsigned int> &Pj : PIndices) {
+			for (unsigned int s : Pj) {
+				intervalTargetStates[s] = true;
+			}
+		}
+	} else {
+		for (State *state : intervalTargets) {
+			intervalTargetStates[model.get_state_index(state)] = true;
 		}
 	}
 
-	// Compute eta_i.
-	double etai = (1.0 - h->get_discount_factor()) * deltai;
-
-	// Compute the new A_{i+1} using the Q-values and current A_i.
-	AiPlus1.clear();
-	for (int i = 0; i < (int)Ai.size(); i++) {
-		// Check if this is difference within eta_i, but account for machine precision issues
-		// within 1 order of magnitude.
-//std::cout << fabs(maxQisa - Qis[i]) << " vs (1 - " << h->get_discount_factor() << ") * " << deltai << " = " << etai << std::endl;
-		if (fabs(maxQisa - Qis[i]) < etai + std::numeric_limits<double>::epsilon() * 10.0) {
-			AiPlus1.push_back(Ai[i]);
-		}
+	// Every expected reward is within the reward's extremes, so the value of any policy is too.
+	valuesUpper.resize(k);
+	for (int i = 0; i < (int)k; i++) {
+		values[i].assign(n, model.get_min(i) / (1.0 - gamma));
+		valuesUpper[i].assign(n, model.get_max(i) / (1.0 - gamma));
 	}
 }
 
-void LVI::compute_V(StatesMap *S, std::vector<Action *> &Ai,
-		StateTransitions *T, SASRewards *Ri, Horizon *h,
-		State *s, std::unordered_map<State *, double> &Vi,
-		std::unordered_map<State *, double> &ViNext, Action *&a)
+template <typename Value>
+void LVI::compute_V(const ActionSets &sets, unsigned int Ai, unsigned int i,
+		unsigned int s, const std::vector<Value> &Vi,
+		double &ViNexts, unsigned int &a, double *Qis)
 {
 	// Compute the maximal Q_i(s, a) given the reduced set of actions.
-	ViNext[s] = -std::numeric_limits<double>::max();
-	a = nullptr;
+	ViNexts = -std::numeric_limits<double>::max();
+	a = 0;
+
+	// For all the actions, compute max Q_i(s, a) over the current set of actions, visiting the set bits
+	// of its mask in increasing order.
+	const uint64_t *mask = sets.get(Ai);
+
+	int q = 0;
+	for (unsigned int w = 0; w < sets.get_num_words(); w++) {
+		for (uint64_t bits = mask[w]; bits != 0; bits &= bits - 1) {
+			unsigned int action = w * 64 + __builtin_ctzll(bits);
 
-	// For all the actions, compute max Q_i(s, a) over the current set of actions.
-	for (int i = 0; i < (int)Ai.size(); i++) {
-		Action *action = Ai[i];
+			double Qisa = compute_Q(i, s, action, Vi);
+			if (Qis != nullptr) {
+				Qis[q] = Qisa;
+			}
+			q++;
 
-		double Qisa = compute_Q(S, T, Ri, h, s, action, Vi);
-		if (Qisa > ViNext[s]) {
-			ViNext[s] = Qisa;
-			a = action;
+			if (Qisa > ViNexts) {
+				ViNexts = Qisa;
+				a = action;
+			}
 		}
 	}
 }
 
-double LVI::compute_Q(StatesMap *S, StateTransitions *T, SASRewards *Ri,
-		Horizon *h, State *s, Action *a,
-		std::unordered_map<State *, double> &Vi)
+double LVI::compute_Q(unsigned int i, unsigned int s, unsigned int a,
+		const std::vector<double> &Vi)
 {
-	// Compute the Q_i(s, a) estimate.
-	double Qisa = 0.0;
+	// The successors of (s, a) are stored contiguously, so walk them directly.
+	unsigned int row = s * model.get_num_actions() + a;
+	unsigned int begin = model.get_rows()[row];
+	unsigned int end = model.get_rows()[row + 1];
+
+	const unsigned int *successors = model.get_successors().data();
+	const double *T = model.get_probabilities().data();
+	double ri = model.get_expected_rewards(i)[row];
+	double gamma = model.get_discount_factor();
+
+	// Compute the Q_i(s, a) estimate with the selected kernel, which gathers Vi at the successors.
+	return ri + gamma * bellmanKernel(successors, T, Vi.data(), begin, end);
+}
 
-	// For each of the successors, compute the bellman update equation.
-	for (State *sPrime : T->successors(S, s, a)) {
-		std::unordered_map<State *, double>::const_iterator VisIterator = Vi.find(sPrime);
-		if (VisIterator == Vi.end()) {
-			throw PolicyException();
-		}
+double LVI::compute_Q(unsigned int i, unsigned int s, unsigned int a,
+		const std::vector<float> &Vi)
+{
+	unsigned int row = s * model.get_num_actions() + a;
+	unsigned int begin = model.get_rows()[row];
+	unsigned int end = model.get_rows()[row + 1];
 
-		double Vis = VisIterator->second;
-		Qisa += T->get(s, a, sPrime) * (Ri->get(s, a, sPrime) + h->get_discount_factor() * Vis);
-	}
+	const unsigned int *successors = model.get_successors().data();
+	const float *T = model.get_probabilities_single().data();
+	double ri = model.get_expected_rewards_single(i)[row];
+	double gamma = model.get_discount_factor();
 
-	return Qisa;
+	return ri + gamma * bellmanKernelSingle(successors, T, Vi.data(), begin, end);
 }
+
+// The sweeps are defined here, so they are instantiated for the two ways values are stored.
+template double LVI::compute_sweep<double>(const ActionSets &sets, const std::vector<unsigned int> &Ai,
+		unsigned int i, const std::vector<unsigned int> &Pj, std::vector<double> &Vi,
+		std::vector<double> &ViNext, std::vector<unsigned int> &pij, ThreadPool *threads,
+		unsigned int sweep, std::vector<std::vector<double> > *Qi);
+template double LVI::compute_sweep<float>(const ActionSets &sets, const std::vector<unsigned int> &Ai,
+		unsigned int i, const std::vector<unsigned int> &Pj, std::vector<float> &Vi,
+		std::vector<double> &ViNext, std::vector<unsigned int> &pij, ThreadPool *threads,
+		unsigned int sweep, std::vector<std::vector<double> > *Qi);
+template void LVI::compute_V<double>(const ActionSets &sets, unsigned int Ai, unsigned int i,
+		unsigned int s, const std::vector<double> &Vi, double &ViNexts, unsigned int &a, double *Qis);
+template void LVI::compute_V<float>(const ActionSets &sets, unsigned int Ai, unsigned int i,
+		unsigned int s, const std::vector<float> &Vi, double &ViNexts, unsigned int &a, double *Qis);
@@ -0,0 +1,134 @@
+/**
+ *  The MIT License (MIT)
+ *
+ *  Copyright (c) 2014 Kyle Wray, University of Massachusetts
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy of
+ *  this software and associated documentation files (the "Software"), to deal in
+ *  the Software without restriction, including without limitation the rights to
+ *  use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ *  the Software, and to permit persons to whom the Software is furnished to do so,
+ *  subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ *  FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ *  COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ *  IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ *  CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+#include "../include/lvi_async.h"
+
+#include <chrono>
+
+LVIAsyncSolve::LVIAsyncSolve(LVI *lviSolver, LMDP *lmdp, double timeLimit)
+{
+	solver = lviSolver;
+	done = false;
+	policy = nullptr;
+
+	// The stop and the deadline are set before the thread starts, so a cancel can never be missed.
+	solver->clear_stop();
+	if (timeLimit > 0.0) {
+		solver->set_deadline(std::chrono::steady_clock::now() +
+				std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double>(timeLimit)));
+	} else {
+		solver->clear_deadline();
+	}
+
+	thread = std::thread(&LVIAsyncSolve::run, this, lmdp);
+}
+
+LVIAsyncSolve::~LVIAsyncSolve()
+{
+	cancel();
+	thread.join();
+
+	if (policy != nullptr) {
+		delete policy;
+	}
+}
+
+void LVIAsyncSolve::cancel()
+{
+	std::lock_guard<std::mutex> lock(mutex);
+	if (!done) {
+		solver->request_stop();
+	}
+}
+
+bool LVIAsyncSolve::is_done() const
+{
+	std::lock_guard<std::mutex> lock(mutex);
+	return done;
+}
+
+void LVIAsyncSolve::wait()
+{
+	std::unique_lock<std::mutex> lock(mutex);
+	finished.wait(lock, [this] { return done; });
+}
+
+bool LVIAsyncSolve::wait_for(double seconds)
+{
+	std::unique_lock<std::mutex> lock(mutex);
+	return finished.wait_for(lock, std::chrono::duration<double>(seconds), [this] { return done; });
+}
+
+PolicyMap *LVIAsyncSolve::get()
+{
+	wait();
+
+	std::lock_guard<std::mutex> lock(mutex);
+	if (error) {
+		std::rethrow_exception(error);
+	}
+
+	PolicyMap *result = policy;
+	policy = nullptr;
+	return result;
+}
+
+double LVIAsyncSolve::get_residual() const
+{
+	return solver->get_residual();
+}
+
+double LVIAsyncSolve::get_error_bound() const
+{
+	return solver->get_error_bound();
+}
+
+bool LVIAsyncSolve::get_converged() const
+{
+	return solver->get_converged();
+}
+
+void LVIAsyncSolve::run(LMDP *lmdp)
+{
+	PolicyMap *result = nullptr;
+	std::exception_ptr exception;
+
+	try {
+		result = solver->solve(lmdp);
+	} catch (...) {
+		exception = std::current_exception();
+	}
+
+	std::lock_guard<std::mutex> lock(mutex);
+
+	// Later solves with this solver are not bound by this one's stop or deadline.
+	solver->clear_stop();
+	solver->clear_deadline();
+
+	policy = result;
+	error = exception;
+	done = true;
+
+	finished.notify_all();
+}
@@ -16,6 +16,8 @@
 
 #include <iostream>
 #include <algorithm>
+#include <cmath>
+#include <limits>
 
 #include <chrono>
 
@@ -27,6 +29,8 @@ LVICuda::LVICuda()
 
 	cudaP = nullptr;
 	cudaPI = nullptr;
+	cudaVi = nullptr;
+	cudaAStar = nullptr;
 
 	d_T = nullptr;
 	d_R = nullptr;
@@ -40,6 +44,8 @@ LVICuda::LVICuda(double tolerance)
 
 	cudaP = nullptr;
 	cudaPI = nullptr;
+	cudaVi = nullptr;
+	cudaAStar = nullptr;
 
 	d_T = nullptr;
 	d_R = nullptr;
@@ -58,29 +64,32 @@ PolicyMap *LVICuda::solve_infinite_horizon(StatesMap *S, ActionsMap *A,
 {
 	initialize_variables(S, A, T, R, P);
 
-	// Create the policy based on the horizon.
-	PolicyMap *policy = new PolicyMap(h);
-
-	// The value of the states, one for each reward.
-	V.clear();
-	V.resize(R->get_num_rewards());
+	// The partitions over state indices.
+	std::vector<std::vector<unsigned int> > PIndices;
+	model.convert_partitions(P, PIndices);
+
+	// The actions are kept as indices while solving, and only become a policy at the end.
+	policyActions.assign(model.get_num_states(), model.get_num_actions());
+
+	// The value of the states, one for each reward, defaulted to 0.0 or to the initial solution.
+	// When resuming within a slack sweep, keep the values of the previous slack vector instead.
+	sweeps.clear();
+	sweeps.resize(R->get_num_rewards(), 0);
+	residual = std::numeric_limits<double>::max();
+	converged = false;
+	if (!resumeValues) {
+		values.clear();
+		values.resize(R->get_num_rewards(), std::vector<double>(model.get_num_states(), 0.0));
+		initialize_solution(policyActions);
+	}
 
 	// We will want to remember the previous fixed values of states, too.
-	std::vector<std::unordered_map<State *, double> > VFixed;
-	VFixed.resize(R->get_num_rewards());
-
-	// Default all values.
-	for (auto state : *S) {
-		State *s = resolve(state);
-		for (int i = 0; i < (int)R->get_num_rewards(); i++) {
-			V[i][s] = 0.0;
-			VFixed[i][s] = 0.0;
-		}
-	}
+	std::vector<std::vector<double> > VFixed;
+	VFixed.resize(R->get_num_rewards(), std::vector<double>(model.get_num_states(), 0.0));
 
 	// Compute the convergence criterion.
 	double convergenceCriterion = epsilon * std::max(0.1, (1.0 - h->get_discount_factor()) / h->get_discount_factor());
-	bool converged = false;
+	bool done = false;
 
 	std::vector<std::vector<double> > difference;
 	difference.resize(P.size());
@@ -91,48 +100,18 @@ PolicyMap *LVICuda::solve_infinite_horizon(StatesMap *S, ActionsMap *A,
 	// After setting up everything, begin timing.
 	auto start = std::chrono::high_resolution_clock::now();
 
-	std::cout << "Starting...\n"; std::cout.flush();
-
-	//*
-	// ------------------------------------------------------------------------------
-	// ------------------------------------------------------------------------------
-	// ------------------------------------------------------------------------------
-
-	// Print out the iteration's convergence table result.
-	printf("Iterations      ");
-	for (int j = 0; j < (int)P.size(); j++) {
-		for (int i = 0; i < (int)R->get_num_rewards(); i++) {
-			std::cout << o[j][i] << " ";
-		}
-		if (j != (int)P.size() - 1) {
-			std::cout << "    ";
-		}
-	}
-	std::cout << "    ";
-	for (int j = 0; j < (int)P.size(); j++) {
-		for (int i = 0; i < (int)R->get_num_rewards(); i++) {
-			printf("o(%i) = %-3i ", i, o[j][i]);
-		}
-	}
-	std::cout << std::endl; std::cout.flush();
-
-	// ------------------------------------------------------------------------------
-	// ------------------------------------------------------------------------------
-	// ------------------------------------------------------------------------------
-	//*/
+	// The telemetry is gathered per partition, so it must know which partition is which.
+	start_telemetry(PIndices);
 
 	// Iterate the outer loop until the convergence criterion is satisfied.
 	int counter = 1;
-	while (!converged) {
+	while (!done) {
 		// Update VFixed to the previous value of V.
-		for (auto state : *S) {
-			State *s = resolve(state);
-			for (int i = 0; i < (int)R->get_num_rewards(); i++) {
-				VFixed[i][s] = V[i][s];
-			}
+		for (int i = 0; i < (int)R->get_num_rewards(); i++) {
+			VFixed[i] = values[i];
 		}
 
-		converged = true;
+		done = true;
 
 		// For each of the partitions, run value iteration. Each time, copy the resulting value functions.
 		for (int j = 0; j < (int)P.size(); j++) {
@@ -141,129 +120,75 @@ PolicyMap *LVICuda::solve_infinite_horizon(StatesMap *S, ActionsMap *A,
 				difference[j][i] = 0.0;
 			}
 
-			compute_partition(S, A, T, R, h, delta, j, P[j], o[j], VFixed, V, policy, difference[j]);
+			compute_partition(S, A, T, R, h, delta, j, PIndices[j], o[j], VFixed, values, policyActions, difference[j]);
 		}
 
 		// Check for convergence.
 		for (int j = 0; j < (int)P.size(); j++) {
 			for (int i = 0; i < (int)R->get_num_rewards(); i++) {
 				if (difference[j][i] > convergenceCriterion) {
-					converged = false;
+					done = false;
 				}
 			}
 		}
 
-		//*
-		// ------------------------------------------------------------------------------
-		// ------------------------------------------------------------------------------
-		// ------------------------------------------------------------------------------
-
-		// Print out the iteration's convergence table result.
-		printf("Iteration %-3i [ ", counter);
-
-		for (int j = 0; j < (int)P.size(); j++) {
-			for (int i = 0; i < (int)R->get_num_rewards(); i++) {
-				// NOTE: Some value functions in the ordering may converge before the ones before them, but this is
-				// not guaranteed. The only guarantee is that once a 'parent' has converged, its 'child' will converge.
-				// Eventually, this must include all value functions over all partitions.
-				if (difference[j][o[j][i]] > convergenceCriterion) {
-					std::cout << "x ";
-				} else {
-					std::cout << "o ";
-				}
-			}
-
-			if (j != (int)P.size() - 1) {
-				std::cout << "| ";
-			}
-		}
-
-		std::cout << "]   ";
-
-		for (int j = 0; j < (int)P.size(); j++) {
-			for (int i = 0; i < (int)R->get_num_rewards(); i++) {
-				// NOTE: Some value functions in the ordering may converge before the ones before them, but this is
-				// not guaranteed. The only guarantee is that once a 'parent' has converged, its 'child' will converge.
-				// Eventually, this must include all value functions over all partitions.
-//				std::cout << difference[j][i] << "\t";
-				printf("%10.6f ", difference[j][o[j][i]]);
-			}
-		}
+		// Report the convergence of this iteration.
+		record_iteration(counter, difference, o, convergenceCriterion,
+				std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - start).count());
 
-		std::cout << std::endl; std::cout.flush();
+		record_residual(difference);
+		converged = done;
 
 		counter++;
 
-		// ------------------------------------------------------------------------------
-		// ------------------------------------------------------------------------------
-		// ------------------------------------------------------------------------------
-		//*/
+		// Once asked to stop, keep the policy of this complete iteration.
+		if (should_stop()) {
+			break;
+		}
 	}
 
-	std::cout << "Complete LVI." << std::endl; std::cout.flush();
+	iterations = counter - 1;
 
-	// After the main loop is complete, end timing. Also, output the result of the computation time.
-	auto end = std::chrono::high_resolution_clock::now();
-	auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(end - start);
-	std::cout << "Total Elapsed Time (GPU Version): " << elapsed.count() << std::endl; std::cout.flush();
+	// Provide the values keyed by state for the callers of get_V.
+	model.convert_values(values, V);
 
 	uninitialize_variables(R->get_num_rewards(), P.size());
 
-	return policy;
+	return create_policy(h);
 }
 
 void LVICuda::compute_partition(StatesMap *S, ActionsMap *A, StateTransitions *T,
 		FactoredRewards *R, Horizon *h, std::vector<float> &delta,
 		int j,
-		std::vector<State *> &Pj, std::vector<unsigned int> &oj,
-		std::vector<std::unordered_map<State *, double> > &VFixed,
-		std::vector<std::unordered_map<State *, double> > &V,
-		PolicyMap *policy, std::vector<double> &maxDifference)
+		std::vector<unsigned int> &Pj, std::vector<unsigned int> &oj,
+		std::vector<std::vector<double> > &VFixed,
+		std::vector<std::vector<double> > &values,
+		std::vector<unsigned int> &pi, std::vector<double> &maxDifference)
 {
 	StateTransitionsArray *Tarray = dynamic_cast<StateTransitionsArray *>(T);
 	if (Tarray == nullptr) {
 		throw PolicyException();
 	}
 
-	// Remember the set of actions available to each of the value functions. This will be computed at the end of each step.
-	std::vector<std::unordered_map<State *, std::vector<Action *> > > AStar;
-	AStar.resize(R->get_num_rewards());
+	// The sets of actions, interned so that states with the same set of actions share it.
+	ActionSets sets(model.get_num_actions());
 
-	// Setup the initial set of actions for i = 1.
-	for (auto s : Pj) {
-		for (auto action : *A) {
-			Action *a = resolve(action);
-			AStar[oj[0]][s].push_back(a);
-		}
-	}
+	// Remember the set of actions available to each of the value functions, indexed by the position of
+	// each state in the partition. This will be computed at the end of each step. The initial set of
+	// actions for i = 1 is all of them.
+	std::vector<std::vector<unsigned int> > AStar(R->get_num_rewards(), std::vector<unsigned int>(Pj.size(), sets.get_full()));
 
 	// For each of the value functions, we will compute the actions set.
 	for (int i = 0; i < (int)R->get_num_rewards(); i++) {
-		SASRewardsArray *Ri = dynamic_cast<SASRewardsArray *>(R->get(oj[i]));
-		if (Ri == nullptr) {
-			throw PolicyException();
-		}
-
-		// In order of cudaPj (above), e.g., 5, 8, 1, 2, ...
-		float *cudaVi = new float[S->get_num_states()];
-		for (int state = 0; state < (int)S->get_num_states(); state++) {
-			State *s = S->get(state);
-			cudaVi[state] = VFixed.at(oj[i]).at(s);
+		// In order of cudaPj (above), e.g., 5, 8, 1, 2, ... The buffers are allocated once per solve.
+		for (int s = 0; s < (int)model.get_num_states(); s++) {
+			cudaVi[cudaIndices[s]] = VFixed[oj[i]][s];
 		}
 
-		// Create the array of available actions, represented as a boolean.
-		bool *cudaAStar = new bool[Pj.size() * A->get_num_actions()];
+		// Create the array of available actions, represented as a boolean, directly from the bits of each set.
 		for (int state = 0; state < (int)Pj.size(); state++) {
-			State *s = Pj.at(state);
-
 			for (int action = 0; action < (int)A->get_num_actions(); action++) {
-				Action *a = A->get(action);
-
-				if (std::find(AStar[oj[i]][s].begin(), AStar[oj[i]][s].end(), a) != AStar[oj[i]][s].end()) {
-					cudaAStar[state * A->get_num_actions() + action] = true;
-				} else {
-					cudaAStar[state * A->get_num_actions() + action] = false;
-				}
+				cudaAStar[state * A->get_num_actions() + action] = sets.contains(AStar[oj[i]][state], action);
 			}
 		}
 
@@ -280,8 +205,8 @@ void LVICuda::compute_partition(StatesMap *S, ActionsMap *A, StateTransitions *T
 							d_R[oj[i]],
 							d_P[j],
 							d_pi[j],
-							(float)Ri->get_min(),
-							(float)Ri->get_max(),
+							(float)model.get_min(oj[i]),
+							(float)model.get_max(oj[i]),
 							(float)h->get_discount_factor(),
 							(float)epsilon,
 							(unsigned int)std::ceil((double)Pj.size() / 128.0),
@@ -296,11 +221,13 @@ void LVICuda::compute_partition(StatesMap *S, ActionsMap *A, StateTransitions *T
 
 		if (result == 0) {
 			for (int state = 0; state < (int)Pj.size(); state++) {
-				State *s = Pj.at(state);
-
 				// Set the value of the state.
-				V[oj[i]][s] = cudaVi[cudaP[j][state]];
+				values[oj[i]][Pj[state]] = cudaVi[cudaP[j][state]];
 			}
+
+			// The sweeps happen on the device, so they are not counted.
+			std::lock_guard<std::mutex> lock(partitionsMutex);
+			record_level(Pj, oj[i], 0, sets, AStar[oj[i]]);
 		} else {
 			std::cout << "Error[compute_partition]: Failed to copy CUDA data." << std::endl;
 			std::cout.flush();
@@ -314,11 +241,9 @@ void LVICuda::compute_partition(StatesMap *S, ActionsMap *A, StateTransitions *T
 			auto start = std::chrono::high_resolution_clock::now();
 #endif
 
-			for (auto s : Pj) {
+			for (int s = 0; s < (int)Pj.size(); s++) {
 				// Use the delta function to compute the final set of AStar[i + 1].
-				// NOTE: Intentionally, we use [s] for AStar, because this has not yet been defined for i + 1. This
-				// creates the vector for state s in place.
-				compute_A_delta(S, AStar.at(oj[i]).at(s), T, Ri, h, s, V.at(oj[i]), delta[oj[i]], AStar.at(oj[i + 1])[s]);
+				compute_A_delta(sets, AStar[oj[i]][s], oj[i], Pj[s], values[oj[i]], delta[oj[i]], AStar[oj[i + 1]][s]);
 			}
 
 #ifdef SHOW_DETAILED_TIMING
@@ -337,13 +262,11 @@ void LVICuda::compute_partition(StatesMap *S, ActionsMap *A, StateTransitions *T
 
 			if (result == 0) {
 				for (int state = 0; state < (int)Pj.size(); state++) {
-					State *s = Pj.at(state);
-
 					// Set the policy.
 					for (int action = 0; action < (int)A->get_num_actions(); action++) {
 						if (action == (int)cudaPI[j][state]) {
 							Action *a = A->get(action);
-							policy->set(s, a);
+							pi[Pj[state]] = model.get_action_index(a);
 							break;
 						}
 					}
@@ -361,10 +284,6 @@ void LVICuda::compute_partition(StatesMap *S, ActionsMap *A, StateTransitions *T
 			std::cout << "Total Elapsed Time (GPU Version, Copying Policy): " << elapsed.count() << std::endl; std::cout.flush();
 #endif
 			}
-
-		// Free the memory at each loop, since the MDP has been solved now.
-		delete cudaVi;
-		delete cudaAStar;
 	}
 
 	// Update the maximum difference found over all partitions after the subset
@@ -372,9 +291,9 @@ void LVICuda::compute_partition(StatesMap *S, ActionsMap *A, StateTransitions *T
 	// that maxDifference stores the differences in order of 1, 2, 3, etc, not
 	// the ordering, e.g., 3, 1, 2, etc. Also, this is equivalent to above.. so remove this.
 	for (int i = 0; i < (int)R->get_num_rewards(); i++) {
-		for (auto s : Pj) {
-			if (fabs(V.at(i).at(s) - VFixed.at(i).at(s)) > maxDifference[i]) {
-				maxDifference[i] = fabs(V.at(i).at(s) - VFixed.at(i).at(s));
+		for (unsigned int s : Pj) {
+			if (fabs(values[i][s] - VFixed[i][s]) > maxDifference[i]) {
+				maxDifference[i] = fabs(values[i][s] - VFixed[i][s]);
 			}
 		}
 	}
@@ -408,6 +327,22 @@ void LVICuda::initialize_variables(StatesMap *S, ActionsMap *A, StateTransitions
 		}
 	}
 
+	// The device-side state index of each compiled state index.
+	cudaIndices.resize(model.get_num_states());
+	for (int s = 0; s < (int)model.get_num_states(); s++) {
+		const IndexedState *state = dynamic_cast<const IndexedState *>(model.get_state(s));
+		cudaIndices[s] = state->get_index();
+	}
+
+	// The host-side values and available actions, reused by each reward of each partition.
+	unsigned int largest = 0;
+	for (int j = 0; j < ell; j++) {
+		largest = std::max(largest, (unsigned int)P[j].size());
+	}
+
+	cudaVi = new float[S->get_num_states()];
+	cudaAStar = new bool[largest * A->get_num_actions()];
+
 	int result = lvi_initialize_state_transitions(S->get_num_states(),
 												A->get_num_actions(),
 												Tarray->get_state_transitions(),
@@ -416,17 +351,23 @@ void LVICuda::initialize_variables(StatesMap *S, ActionsMap *A, StateTransitions
 		throw PolicyException();
 	}
 
+	// Only the expected rewards r_i(s, a) are sent to the device, in its order of the states.
 	d_R = new float *[k];
 
+	unsigned int m = model.get_num_actions();
+	std::vector<float> cudaR((size_t)S->get_num_states() * m);
+
 	for (int i = 0; i < k; i++) {
-		SASRewardsArray *Ri = dynamic_cast<SASRewardsArray *>(R->get(i));
-		if (Ri == nullptr) {
-			throw PolicyException();
+		const std::vector<double> &ri = model.get_expected_rewards(i);
+		for (int s = 0; s < (int)model.get_num_states(); s++) {
+			for (unsigned int a = 0; a < m; a++) {
+				cudaR[(size_t)cudaIndices[s] * m + a] = (float)ri[(size_t)s * m + a];
+			}
 		}
 
 		result = lvi_initialize_rewards(S->get_num_states(),
 									A->get_num_actions(),
-									Ri->get_rewards(),
+									cudaR.data(),
 									d_R[i]);
 		if (result != 0) {
 			throw PolicyException();
@@ -466,6 +407,12 @@ void LVICuda::uninitialize_variables(unsigned int k, unsigned int ell)
 	}
 	cudaPI = nullptr;
 
+	delete [] cudaVi;
+	cudaVi = nullptr;
+
+	delete [] cudaAStar;
+	cudaAStar = nullptr;
+
 	lvi_uninitialize(d_T, k, d_R, ell, d_P, d_pi);
 
 	d_T = nullptr;
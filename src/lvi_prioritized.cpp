@@ -0,0 +1,203 @@
+/**
+ *  The MIT License (MIT)
+ *
+ *  Copyright (c) 2014 Kyle Wray, University of Massachusetts
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy of
+ *  this software and associated documentation files (the "Software"), to deal in
+ *  the Software without restriction, including without limitation the rights to
+ *  use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ *  the Software, and to permit persons to whom the Software is furnished to do so,
+ *  subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ *  FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ *  COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ *  IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ *  CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+#include "../include/lvi_prioritized.h"
+
+#include <cmath>
+#include <algorithm>
+
+LVIPrioritized::LVIPrioritized() : LVI()
+{
+	loopingVersion = true;
+}
+
+LVIPrioritized::LVIPrioritized(double tolerance) : LVI(tolerance, true)
+{ }
+
+LVIPrioritized::~LVIPrioritized()
+{ }
+
+PolicyMap *LVIPrioritized::solve_infinite_horizon(StatesMap *S, ActionsMap *A,
+		StateTransitions *T, FactoredRewards *R, Horizon *h,
+		std::vector<float> &delta,
+		std::vector<std::vector<State *> > &P,
+		std::vector<std::vector<unsigned int> > &o)
+{
+	// Only prioritized sweeping reads the predecessors, so they are compiled here rather than with the model.
+	model.compile_predecessors();
+
+	return LVI::solve_infinite_horizon(S, A, T, R, h, delta, P, o);
+}
+
+bool LVIPrioritized::is_interval() const
+{
+	return false;
+}
+
+void LVIPrioritized::compute_partition(std::vector<float> &delta,
+		std::vector<unsigned int> &Pj, std::vector<unsigned int> &oj,
+		std::vector<std::vector<double> > &VFixed,
+		std::vector<std::vector<double> > &values,
+		std::vector<unsigned int> &pi, std::vector<double> &maxDifference,
+		ThreadPool * /* threads */)
+{
+	unsigned int k = model.get_num_rewards();
+	double gamma = model.get_discount_factor();
+
+	const unsigned int *predecessorRows = model.get_predecessor_rows().data();
+	const unsigned int *predecessors = model.get_predecessors().data();
+	const double *predecessorProbabilities = model.get_predecessor_probabilities().data();
+
+	// The buffers of this partition keep their memory between outer iterations.
+	std::unique_ptr<LVIPartitionWorkspace> temporary;
+	LVIPartitionWorkspace *scratch = get_partition_workspace(Pj, temporary);
+
+	// The value of the states, one for each reward.
+	std::vector<std::vector<double> > &VPrime = scratch->VPrime;
+
+	// Compute the convergence criterion which follows from the proof of convergence. A state is only
+	// backed up while the bound on its residual is above it.
+	double convergenceCriterion = epsilon * std::max(0.1, (1.0 - gamma) / gamma);
+
+	// The position of each state in the partition, or -1 if it is not in the partition.
+	const std::vector<int> &position = scratch->position;
+
+	// The sets of actions, interned so that states with the same set of actions share it.
+	ActionSets &sets = scratch->sets;
+
+	// Remember the set of actions available to each of the value functions, indexed by the position of
+	// each state in the partition. This will be computed at the end of each step. The initial set of
+	// actions for i = 1 is all of them.
+	std::vector<std::vector<unsigned int> > &AStar = scratch->AStar;
+	for (int i = 0; i < (int)k; i++) {
+		std::fill(AStar[i].begin(), AStar[i].end(), sets.get_full());
+	}
+
+	// The actions which obtained the values, and the upper bound on each state's Bellman residual, indexed
+	// by the position of each state in the partition.
+	std::vector<unsigned int> &pij = scratch->pij;
+	std::vector<double> &priority = scratch->priority;
+
+	// For each of the value functions, we will compute the actions set.
+	for (int i = 0; i < (int)k; i++) {
+		// Setup V[i] with the values from the previous outer step which the backups read.
+		copy_fixed_values(*scratch, Pj, VFixed[oj[i]], VPrime[oj[i]]);
+		std::vector<double> &Vi = VPrime[oj[i]];
+
+		unsigned long long count = 0;
+
+		// The queue of states, a heap keyed by their residual bound. Entries whose key no longer matches
+		// the state's current bound are stale and skipped.
+		std::vector<std::pair<double, unsigned int> > &queue = scratch->queue;
+		queue.clear();
+
+		// Compute the exact residual of every state once to seed the queue.
+		for (int s = 0; s < (int)Pj.size(); s++) {
+			double Vis = 0.0;
+			compute_V(sets, AStar[oj[i]][s], oj[i], Pj[s], Vi, Vis, pij[s]);
+			count++;
+
+			priority[s] = std::fabs(Vis - Vi[Pj[s]]);
+			if (priority[s] > convergenceCriterion) {
+				queue.push_back(std::make_pair(priority[s], s));
+				std::push_heap(queue.begin(), queue.end());
+			}
+		}
+
+		while (!queue.empty() && !should_stop()) {
+			std::pop_heap(queue.begin(), queue.end());
+			std::pair<double, unsigned int> top = queue.back();
+			queue.pop_back();
+
+			unsigned int s = top.second;
+			if (top.first != priority[s]) {
+				continue;
+			}
+
+			// Back up the state with the largest residual bound; its residual is now zero.
+			double Vis = 0.0;
+			compute_V(sets, AStar[oj[i]][s], oj[i], Pj[s], Vi, Vis, pij[s]);
+			count++;
+
+			double change = std::fabs(Vis - Vi[Pj[s]]);
+			Vi[Pj[s]] = Vis;
+			priority[s] = 0.0;
+
+			if (change == 0.0) {
+				continue;
+			}
+
+			// The backup of each predecessor p changes by at most gamma * max_a T(p, a, s) * change.
+			for (unsigned int t = predecessorRows[Pj[s]]; t < predecessorRows[Pj[s] + 1]; t++) {
+				int p = position[predecessors[t]];
+				if (p < 0) {
+					continue;
+				}
+
+				priority[p] += gamma * predecessorProbabilities[t] * change;
+				if (priority[p] > convergenceCriterion) {
+					queue.push_back(std::make_pair(priority[p], (unsigned int)p));
+					std::push_heap(queue.begin(), queue.end());
+				}
+			}
+		}
+
+		// Store the action taken as part of the policy. The partitions are disjoint, so only recording
+		// the sweeps needs the lock.
+		for (int s = 0; s < (int)Pj.size(); s++) {
+			pi[Pj[s]] = pij[s];
+		}
+
+		{
+			std::lock_guard<std::mutex> lock(partitionsMutex);
+			// The seeding pass is the only full sweep.
+			sweeps[oj[i]]++;
+			backups += count;
+			record_level(Pj, oj[i], 1, sets, AStar[oj[i]]);
+		}
+
+		// After everything, we can finally compute the set of actions ***for i + 1*** with the delta slack.
+		if (i != (int)k - 1) {
+			for (int s = 0; s < (int)Pj.size(); s++) {
+				// Use the delta function to compute the final set of AStar[i + 1].
+				compute_A_delta(sets, AStar[oj[i]][s], oj[i], Pj[s], Vi, delta[oj[i]], scratch->Qi[s], AStar[oj[i + 1]][s]);
+			}
+		}
+
+		// Copy the final results for these states.
+		for (unsigned int s : Pj) {
+			values[oj[i]][s] = Vi[s];
+		}
+	}
+
+	// Update the maximum difference found over all partitions after the subset
+	// of states have had VI executed. This does not follow the ordering.
+	for (int i = 0; i < (int)k; i++) {
+		for (unsigned int s : Pj) {
+			if (std::fabs(VPrime[i][s] - VFixed[i][s]) > maxDifference[i]) {
+				maxDifference[i] = std::fabs(VPrime[i][s] - VFixed[i][s]);
+			}
+		}
+	}
+}
@@ -0,0 +1,172 @@
+/**
+ *  The MIT License (MIT)
+ *
+ *  Copyright (c) 2014 Kyle Wray, University of Massachusetts
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy of
+ *  this software and associated documentation files (the "Software"), to deal in
+ *  the Software without restriction, including without limitation the rights to
+ *  use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ *  the Software, and to permit persons to whom the Software is furnished to do so,
+ *  subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ *  FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ *  COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ *  IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ *  CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+#include "../include/lvi_telemetry.h"
+
+#include <fstream>
+#include <limits>
+#include <algorithm>
+#include <cmath>
+
+/**
+ * Write a number as JSON. JSON has no infinity or NaN, so these are written as null, as is the largest
+ * double, which stands for a residual not yet known.
+ * @param	file	The stream to write to.
+ * @param	value	The number.
+ */
+static void write_json_number(std::ostream &file, double value)
+{
+	if (!std::isfinite(value) || value == std::numeric_limits<double>::max()) {
+		file << "null";
+	} else {
+		file << value;
+	}
+}
+
+LVITelemetry::~LVITelemetry()
+{ }
+
+LVINullTelemetry::~LVINullTelemetry()
+{ }
+
+bool LVINullTelemetry::is_enabled() const
+{
+	return false;
+}
+
+void LVINullTelemetry::record(const LVITelemetryRecord & /* record */)
+{ }
+
+LVIRingTelemetry::LVIRingTelemetry(unsigned int capacity)
+{
+	records.resize(std::max(1u, capacity));
+	first = 0;
+	size = 0;
+}
+
+LVIRingTelemetry::~LVIRingTelemetry()
+{ }
+
+bool LVIRingTelemetry::is_enabled() const
+{
+	return true;
+}
+
+void LVIRingTelemetry::record(const LVITelemetryRecord &record)
+{
+	if (size < records.size()) {
+		records[(first + size) % records.size()] = record;
+		size++;
+	} else {
+		records[first] = record;
+		first = (first + 1) % records.size();
+	}
+}
+
+void LVIRingTelemetry::clear()
+{
+	first = 0;
+	size = 0;
+}
+
+unsigned int LVIRingTelemetry::get_num_records() const
+{
+	return size;
+}
+
+const LVITelemetryRecord &LVIRingTelemetry::get_record(unsigned int r) const
+{
+	return records[(first + r) % records.size()];
+}
+
+bool LVIRingTelemetry::save_csv(std::string filename) const
+{
+	std::ofstream file(filename);
+	if (!file.is_open()) {
+		return true;
+	}
+
+	file.precision(std::numeric_limits<double>::max_digits10);
+
+	file << "iteration,partition,reward,level,residual,converged,sweeps,actions,time" << std::endl;
+
+	for (unsigned int r = 0; r < size; r++) {
+		const LVITelemetryRecord &record = get_record(r);
+
+		file << record.iteration << ",";
+		file << record.partition << ",";
+		file << record.reward << ",";
+		file << record.level << ",";
+		file << record.residual << ",";
+		file << (record.converged ? 1 : 0) << ",";
+		file << record.sweeps << ",";
+		file << record.actions << ",";
+		file << record.time << std::endl;
+	}
+
+	file.close();
+
+	return false;
+}
+
+bool LVIRingTelemetry::save_json(std::string filename) const
+{
+	std::ofstream file(filename);
+	if (!file.is_open()) {
+		return true;
+	}
+
+	file.precision(std::numeric_limits<double>::max_digits10);
+
+	file << "[" << std::endl;
+
+	for (unsigned int r = 0; r < size; r++) {
+		const LVITelemetryRecord &record = get_record(r);
+
+		file << "\t{";
+		file << "\"iteration\": " << record.iteration << ", ";
+		file << "\"partition\": " << record.partition << ", ";
+		file << "\"reward\": " << record.reward << ", ";
+		file << "\"level\": " << record.level << ", ";
+		file << "\"residual\": ";
+		write_json_number(file, record.residual);
+		file << ", ";
+		file << "\"converged\": " << (record.converged ? "true" : "false") << ", ";
+		file << "\"sweeps\": " << record.sweeps << ", ";
+		file << "\"actions\": " << record.actions << ", ";
+		file << "\"time\": ";
+		write_json_number(file, record.time);
+		file << "}";
+		if (r != size - 1) {
+			file << ",";
+		}
+		file << std::endl;
+	}
+
+	file << "]" << std::endl;
+
+	file.close();
+
+	return false;
+}
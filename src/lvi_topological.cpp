@@ -0,0 +1,284 @@
+/**
+ *  The MIT License (MIT)
+ *
+ *  Copyright (c) 2014 Kyle Wray, University of Massachusetts
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy of
+ *  this software and associated documentation files (the "Software"), to deal in
+ *  the Software without restriction, including without limitation the rights to
+ *  use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ *  the Software, and to permit persons to whom the Software is furnished to do so,
+ *  subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ *  FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ *  COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ *  IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ *  CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+#include "../include/lvi_topological.h"
+
+#include <cmath>
+#include <algorithm>
+
+LVITopological::LVITopological() : LVI()
+{
+	loopingVersion = true;
+}
+
+LVITopological::LVITopological(double tolerance) : LVI(tolerance, true)
+{ }
+
+LVITopological::~LVITopological()
+{ }
+
+PolicyMap *LVITopological::solve_infinite_horizon(StatesMap *S, ActionsMap *A,
+		StateTransitions *T, FactoredRewards *R, Horizon *h,
+		std::vector<float> &delta,
+		std::vector<std::vector<State *> > &P,
+		std::vector<std::vector<unsigned int> > &o)
+{
+	// The SCCs are computed once per partition, on its first outer step.
+	partitionComponents.clear();
+	partitionCyclic.clear();
+
+	PolicyMap *policy = LVI::solve_infinite_horizon(S, A, T, R, h, delta, P, o);
+
+	partitionComponents.clear();
+	partitionCyclic.clear();
+
+	return policy;
+}
+
+bool LVITopological::is_interval() const
+{
+	return false;
+}
+
+void LVITopological::compute_partition(std::vector<float> &delta,
+		std::vector<unsigned int> &Pj, std::vector<unsigned int> &oj,
+		std::vector<std::vector<double> > &VFixed,
+		std::vector<std::vector<double> > &values,
+		std::vector<unsigned int> &pi, std::vector<double> &maxDifference,
+		ThreadPool * /* threads */)
+{
+	unsigned int k = model.get_num_rewards();
+	double gamma = model.get_discount_factor();
+
+	// Find the SCCs of this partition, computing them if this is the first outer step. Other partitions
+	// may be doing the same at the same time.
+	std::vector<std::vector<unsigned int> > *components = nullptr;
+	std::vector<bool> *cyclic = nullptr;
+	{
+		std::lock_guard<std::mutex> lock(partitionsMutex);
+		components = &partitionComponents[&Pj];
+		cyclic = &partitionCyclic[&Pj];
+	}
+	if (components->empty() && !Pj.empty()) {
+		compute_components(Pj, *components, *cyclic);
+	}
+
+	// The buffers of this partition keep their memory between outer iterations.
+	std::unique_ptr<LVIPartitionWorkspace> temporary;
+	LVIPartitionWorkspace *scratch = get_partition_workspace(Pj, temporary);
+
+	// The value of the states, one for each reward.
+	std::vector<std::vector<double> > &VPrime = scratch->VPrime;
+
+	// Compute the convergence criterion which follows from the proof of convergence.
+	double convergenceCriterion = epsilon * std::max(0.1, (1.0 - gamma) / gamma);
+
+	// The sets of actions, interned so that states with the same set of actions share it.
+	ActionSets &sets = scratch->sets;
+
+	// Remember the set of actions available to each of the value functions, indexed by the position of
+	// each state in the partition. This will be computed at the end of each step. The initial set of
+	// actions for i = 1 is all of them.
+	std::vector<std::vector<unsigned int> > &AStar = scratch->AStar;
+	for (int i = 0; i < (int)k; i++) {
+		std::fill(AStar[i].begin(), AStar[i].end(), sets.get_full());
+	}
+
+	// The actions which obtained the values, indexed by the position of each state in the partition.
+	std::vector<unsigned int> &pij = scratch->pij;
+
+	// For each of the value functions, we will compute the actions set.
+	for (int i = 0; i < (int)k; i++) {
+		// Setup V[i] with the values from the previous outer step which the backups read.
+		copy_fixed_values(*scratch, Pj, VFixed[oj[i]], VPrime[oj[i]]);
+		std::vector<double> &Vi = VPrime[oj[i]];
+
+		unsigned long long count = 0;
+
+		// Solve each SCC in turn. All of the SCCs it can reach have already converged, so its values are
+		// final once it converges itself.
+		for (int c = 0; c < (int)components->size(); c++) {
+			const std::vector<unsigned int> &component = (*components)[c];
+
+			double difference = convergenceCriterion + 1.0;
+
+			do {
+				difference = 0.0;
+
+				// Update the values in place, as in a Gauss-Seidel sweep.
+				for (unsigned int s : component) {
+					double Vis = 0.0;
+					compute_V(sets, AStar[oj[i]][s], oj[i], Pj[s], Vi, Vis, pij[s]);
+					count++;
+
+					if (std::fabs(Vis - Vi[Pj[s]]) > difference) {
+						difference = std::fabs(Vis - Vi[Pj[s]]);
+					}
+
+					Vi[Pj[s]] = Vis;
+				}
+
+				// A single state without a self-loop only depends on solved states, so one backup is exact.
+			} while ((*cyclic)[c] && difference > convergenceCriterion && !should_stop());
+		}
+
+		// Store the action taken as part of the policy. The partitions are disjoint, so only recording
+		// the sweeps needs the lock.
+		for (int s = 0; s < (int)Pj.size(); s++) {
+			pi[Pj[s]] = pij[s];
+		}
+
+		{
+			std::lock_guard<std::mutex> lock(partitionsMutex);
+			// Record the backups as the equivalent number of full sweeps over the partition.
+			unsigned int sweep = (unsigned int)((count + Pj.size() - 1) / std::max((size_t)1, Pj.size()));
+			sweeps[oj[i]] += sweep;
+			backups += count;
+			record_level(Pj, oj[i], sweep, sets, AStar[oj[i]]);
+		}
+
+		// After everything, we can finally compute the set of actions ***for i + 1*** with the delta slack.
+		if (i != (int)k - 1) {
+			for (int s = 0; s < (int)Pj.size(); s++) {
+				// Use the delta function to compute the final set of AStar[i + 1].
+				compute_A_delta(sets, AStar[oj[i]][s], oj[i], Pj[s], Vi, delta[oj[i]], scratch->Qi[s], AStar[oj[i + 1]][s]);
+			}
+		}
+
+		// Copy the final results for these states.
+		for (unsigned int s : Pj) {
+			values[oj[i]][s] = Vi[s];
+		}
+	}
+
+	// Update the maximum difference found over all partitions after the subset
+	// of states have had VI executed. This does not follow the ordering.
+	for (int i = 0; i < (int)k; i++) {
+		for (unsigned int s : Pj) {
+			if (std::fabs(VPrime[i][s] - VFixed[i][s]) > maxDifference[i]) {
+				maxDifference[i] = std::fabs(VPrime[i][s] - VFixed[i][s]);
+			}
+		}
+	}
+}
+
+void LVITopological::compute_components(const std::vector<unsigned int> &Pj,
+		std::vector<std::vector<unsigned int> > &components,
+		std::vector<bool> &cyclic)
+{
+	unsigned int m = model.get_num_actions();
+	const unsigned int *rows = model.get_rows().data();
+	const unsigned int *successors = model.get_successors().data();
+
+	// The position of each state in the partition, or -1 if it is not in the partition.
+	std::vector<int> position(model.get_num_states(), -1);
+	for (int s = 0; s < (int)Pj.size(); s++) {
+		position[Pj[s]] = s;
+	}
+
+	// Tarjan's algorithm, with an explicit stack so that long roads do not overflow the call stack. It
+	// emits each SCC only after all of the SCCs reachable from it, i.e., in reverse topological order.
+	std::vector<int> index(Pj.size(), -1);
+	std::vector<int> lowlink(Pj.size(), 0);
+	std::vector<bool> onStack(Pj.size(), false);
+	std::vector<unsigned int> stack;
+
+	// The DFS call stack: each entry is a position and the next successor to examine.
+	std::vector<std::pair<unsigned int, unsigned int> > calls;
+
+	int counter = 0;
+
+	components.clear();
+	cyclic.clear();
+
+	for (int root = 0; root < (int)Pj.size(); root++) {
+		if (index[root] >= 0) {
+			continue;
+		}
+
+		calls.push_back(std::make_pair((unsigned int)root, rows[Pj[root] * m]));
+		index[root] = lowlink[root] = counter++;
+		stack.push_back(root);
+		onStack[root] = true;
+
+		while (!calls.empty()) {
+			unsigned int s = calls.back().first;
+			unsigned int &t = calls.back().second;
+
+			if (t < rows[(Pj[s] + 1) * m]) {
+				int sPrime = position[successors[t]];
+				t++;
+
+				if (sPrime < 0) {
+					continue;
+				}
+
+				if (index[sPrime] < 0) {
+					index[sPrime] = lowlink[sPrime] = counter++;
+					stack.push_back(sPrime);
+					onStack[sPrime] = true;
+					calls.push_back(std::make_pair((unsigned int)sPrime, rows[Pj[sPrime] * m]));
+				} else if (onStack[sPrime]) {
+					lowlink[s] = std::min(lowlink[s], index[sPrime]);
+				}
+
+				continue;
+			}
+
+			// All successors of s have been examined.
+			calls.pop_back();
+			if (!calls.empty()) {
+				unsigned int parent = calls.back().first;
+				lowlink[parent] = std::min(lowlink[parent], lowlink[s]);
+			}
+
+			if (lowlink[s] != index[s]) {
+				continue;
+			}
+
+			// The state s is the root of an SCC; pop it off the stack.
+			std::vector<unsigned int> component;
+			unsigned int sPrime = 0;
+			do {
+				sPrime = stack.back();
+				stack.pop_back();
+				onStack[sPrime] = false;
+				component.push_back(sPrime);
+			} while (sPrime != s);
+
+			// Keep the partition's order within the SCC.
+			std::sort(component.begin(), component.end());
+
+			bool isCyclic = (component.size() > 1);
+			for (unsigned int u = rows[Pj[s] * m]; !isCyclic && u < rows[(Pj[s] + 1) * m]; u++) {
+				if (successors[u] == Pj[s]) {
+					isCyclic = true;
+				}
+			}
+
+			components.push_back(component);
+			cyclic.push_back(isCyclic);
+		}
+	}
+}
@@ -0,0 +1,277 @@
+/**
+ *  The MIT License (MIT)
+ *
+ *  Copyright (c) 2014 Kyle Wray, University of Massachusetts
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy of
+ *  this software and associated documentation files (the "Software"), to deal in
+ *  the Software without restriction, including without limitation the rights to
+ *  use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ *  the Software, and to permit persons to whom the Software is furnished to do so,
+ *  subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ *  FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ *  COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ *  IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ *  CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+#include "../include/lvi_workspace.h"
+
+#include <algorithm>
+#include <limits>
+
+/**
+ * Resize a buffer, counting a growth if it has to grow.
+ * @param	buffer		The buffer. This will be updated.
+ * @param	size		The new size of the buffer.
+ * @param	growths		The number of buffer growths. This will be updated.
+ */
+template <typename T>
+static void grow(std::vector<T> &buffer, std::size_t size, unsigned long long &growths)
+{
+	if (size > buffer.capacity()) {
+		growths++;
+	}
+	buffer.resize(size);
+}
+
+LVIAndersonMemory::LVIAndersonMemory()
+{
+	clear();
+}
+
+void LVIAndersonMemory::clear()
+{
+	columns = 0;
+	next = 0;
+	previous = false;
+	extrapolated = false;
+	residual = std::numeric_limits<double>::max();
+}
+
+LVIPartitionWorkspace::LVIPartitionWorkspace(unsigned int numActions) : sets(numActions)
+{ }
+
+unsigned long long LVIPartitionWorkspace::reserve(const CompiledLMDP &model, const std::vector<unsigned int> &Pj,
+		bool singlePrecision, bool interval, unsigned int andersonDepth)
+{
+	unsigned long long growths = 0;
+
+	unsigned int size = (unsigned int)Pj.size();
+	unsigned int n = model.get_num_states();
+	unsigned int m = model.get_num_actions();
+	unsigned int k = model.get_num_rewards();
+
+	sets.clear();
+
+	grow(position, n, growths);
+	std::fill(position.begin(), position.end(), -1);
+	for (int s = 0; s < (int)size; s++) {
+		position[Pj[s]] = s;
+	}
+
+	// Count the successors outside the partition first, so that the boundary is sized once.
+	const std::vector<unsigned int> &rows = model.get_rows();
+	const std::vector<unsigned int> &successors = model.get_successors();
+
+	unsigned int count = 0;
+	for (unsigned int s : Pj) {
+		for (unsigned int t = rows[s * m]; t < rows[(s + 1) * m]; t++) {
+			if (position[successors[t]] < 0) {
+				count++;
+			}
+		}
+	}
+
+	grow(boundary, count, growths);
+	count = 0;
+	for (unsigned int s : Pj) {
+		for (unsigned int t = rows[s * m]; t < rows[(s + 1) * m]; t++) {
+			if (position[successors[t]] < 0) {
+				boundary[count++] = successors[t];
+			}
+		}
+	}
+	std::sort(boundary.begin(), boundary.end());
+	boundary.erase(std::unique(boundary.begin(), boundary.end()), boundary.end());
+
+	grow(VPrime, k, growths);
+	grow(AStar, k, growths);
+	for (int i = 0; i < (int)k; i++) {
+		grow(VPrime[i], n, growths);
+		grow(AStar[i], size, growths);
+	}
+
+	grow(Vi, size, growths);
+	grow(pij, size, growths);
+	grow(previous, size, growths);
+	grow(priority, size, growths);
+
+	// Each state's Q-values have room for every action, so resizing them to a smaller set never allocates.
+	grow(Qi, size, growths);
+	for (std::vector<double> &Qis : Qi) {
+		if (m > Qis.capacity()) {
+			growths++;
+			Qis.reserve(m);
+		}
+	}
+
+	if (singlePrecision) {
+		grow(ViSingle, n, growths);
+	}
+
+	if (interval || andersonDepth > 0) {
+		grow(ASwept, k, growths);
+		for (int i = 0; i < (int)k; i++) {
+			grow(ASwept[i], size, growths);
+		}
+		grow(swept, k, growths);
+		std::fill(swept.begin(), swept.end(), false);
+	}
+
+	if (interval) {
+		grow(ViUpper, n, growths);
+		grow(QiUpper, size, growths);
+		for (std::vector<double> &Qis : QiUpper) {
+			if (m > Qis.capacity()) {
+				growths++;
+				Qis.reserve(m);
+			}
+		}
+	}
+
+	if (andersonDepth > 0) {
+		grow(andersonX, size, growths);
+		grow(anderson, k, growths);
+		for (LVIAndersonMemory &memory : anderson) {
+			grow(memory.G, size, growths);
+			grow(memory.F, size, growths);
+			grow(memory.extrapolation, size, growths);
+			grow(memory.boundary, boundary.size(), growths);
+			grow(memory.DF, (std::size_t)size * andersonDepth, growths);
+			grow(memory.DG, (std::size_t)size * andersonDepth, growths);
+			grow(memory.Gram, (std::size_t)andersonDepth * andersonDepth, growths);
+			memory.clear();
+		}
+		grow(andersonSystem, (std::size_t)andersonDepth * (andersonDepth + 1), growths);
+	}
+
+	grow(rewards, k, growths);
+	grow(VInterleaved, (std::size_t)n * k, growths);
+	grow(VNext, (std::size_t)size * k, growths);
+	grow(difference, k, growths);
+
+	return growths;
+}
+
+LVIWorkspace::LVIWorkspace()
+{
+	growths = 0;
+}
+
+LVIWorkspace::~LVIWorkspace()
+{
+	clear();
+}
+
+void LVIWorkspace::reserve(const CompiledLMDP &model, const std::vector<std::vector<unsigned int> > &P,
+		bool singlePrecision, bool interval, unsigned int andersonDepth)
+{
+	unsigned int n = model.get_num_states();
+	unsigned int k = model.get_num_rewards();
+
+	// The sets of actions depend on the number of actions, so the partitions are only kept if it matches.
+	bool keep = (partitions.size() == P.size());
+	for (LVIPartitionWorkspace *partition : partitions) {
+		keep = keep && (partition->sets.get_num_actions() == model.get_num_actions());
+	}
+
+	if (!keep) {
+		clear();
+		for (int j = 0; j < (int)P.size(); j++) {
+			partitions.push_back(new LVIPartitionWorkspace(model.get_num_actions()));
+			growths++;
+		}
+	}
+
+	for (int j = 0; j < (int)P.size(); j++) {
+		// The sets interned by the previous solve are cleared, so count them first.
+		growths += partitions[j]->sets.get_num_sets() - 1;
+		growths += partitions[j]->reserve(model, P[j], singlePrecision, interval, andersonDepth);
+	}
+
+	grow(fixedValues, k, growths);
+	for (int i = 0; i < (int)k; i++) {
+		grow(fixedValues[i], n, growths);
+	}
+
+	if (interval) {
+		grow(fixedUpperValues, k, growths);
+		for (int i = 0; i < (int)k; i++) {
+			grow(fixedUpperValues[i], n, growths);
+		}
+	}
+
+	grow(differences, P.size(), growths);
+	for (int j = 0; j < (int)P.size(); j++) {
+		grow(differences[j], k, growths);
+	}
+}
+
+void LVIWorkspace::clear()
+{
+	for (LVIPartitionWorkspace *partition : partitions) {
+		growths += partition->sets.get_num_sets() - 1;
+		delete partition;
+	}
+	partitions.clear();
+
+	fixedValues.clear();
+	fixedValues.shrink_to_fit();
+	fixedUpperValues.clear();
+	fixedUpperValues.shrink_to_fit();
+	differences.clear();
+	differences.shrink_to_fit();
+}
+
+std::vector<std::vector<double> > &LVIWorkspace::get_fixed_values()
+{
+	return fixedValues;
+}
+
+std::vector<std::vector<double> > &LVIWorkspace::get_fixed_upper_values()
+{
+	return fixedUpperValues;
+}
+
+std::vector<std::vector<double> > &LVIWorkspace::get_differences()
+{
+	return differences;
+}
+
+unsigned int LVIWorkspace::get_num_partitions() const
+{
+	return (unsigned int)partitions.size();
+}
+
+LVIPartitionWorkspace *LVIWorkspace::get_partition(unsigned int j)
+{
+	return partitions[j];
+}
+
+unsigned long long LVIWorkspace::get_num_growths() const
+{
+	// Each new set of actions allocates, other than the set of all actions.
+	unsigned long long interned = 0;
+	for (LVIPartitionWorkspace *partition : partitions) {
+		interned += partition->sets.get_num_sets() - 1;
+	}
+	return growths + interned;
+}
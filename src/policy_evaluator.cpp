@@ -0,0 +1,859 @@
+/**
+ *  The MIT License (MIT)
+ *
+ *  Copyright (c) 2014 Kyle Wray, University of Massachusetts
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy of
+ *  this software and associated documentation files (the "Software"), to deal in
+ *  the Software without restriction, including without limitation the rights to
+ *  use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ *  the Software, and to permit persons to whom the Software is furnished to do so,
+ *  subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ *  FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ *  COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ *  IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ *  CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+#include "../include/policy_evaluator.h"
+
+#include "../../librbr/librbr/include/core/core_exception.h"
+#include "../../librbr/librbr/include/core/states/state_exception.h"
+#include "../../librbr/librbr/include/core/actions/action_exception.h"
+#include "../../librbr/librbr/include/core/rewards/reward_exception.h"
+
+#include <math.h>
+#include <cmath>
+#include <algorithm>
+#include <limits>
+
+/**
+ * Update the largest absolute value of a residual with one more of its elements. A non-finite element
+ * makes the result infinite, so that a NaN never passes a convergence check.
+ * @param	largest		The largest absolute value so far.
+ * @param	value		The next element of the residual.
+ * @return	The largest absolute value including the element.
+ */
+static inline double update_largest(double largest, double value)
+{
+	if (!std::isfinite(value)) {
+		return std::numeric_limits<double>::infinity();
+	}
+	return std::max(largest, std::fabs(value));
+}
+
+PolicyEvaluator::PolicyEvaluator()
+{
+	epsilon = 0.001;
+	pool = new ThreadPool(1);
+	compiled = nullptr;
+	method = POLICY_EVALUATION_SWEEPS;
+	preconditioner = POLICY_PRECONDITIONER_ILU0;
+	gmresRestart = 30;
+	maxIterations = 1000;
+	sweeps = 0;
+	converged = true;
+}
+
+PolicyEvaluator::PolicyEvaluator(double tolerance, unsigned int numThreads)
+{
+	epsilon = tolerance;
+	pool = new ThreadPool(std::max(1u, numThreads));
+	compiled = nullptr;
+	method = POLICY_EVALUATION_SWEEPS;
+	preconditioner = POLICY_PRECONDITIONER_ILU0;
+	gmresRestart = 30;
+	maxIterations = 1000;
+	sweeps = 0;
+	converged = true;
+}
+
+PolicyEvaluator::~PolicyEvaluator()
+{
+	delete pool;
+}
+
+void PolicyEvaluator::compile(LMDP *lmdp)
+{
+	StatesMap *S = dynamic_cast<StatesMap *>(lmdp->get_states());
+	if (S == nullptr) {
+		throw StateException();
+	}
+
+	ActionsMap *A = dynamic_cast<ActionsMap *>(lmdp->get_actions());
+	if (A == nullptr) {
+		throw ActionException();
+	}
+
+	FactoredRewards *R = dynamic_cast<FactoredRewards *>(lmdp->get_rewards());
+	if (R == nullptr) {
+		throw RewardException();
+	}
+
+	// The values of a policy only exist if they are discounted.
+	Horizon *h = lmdp->get_horizon();
+	if (h->is_finite() || h->get_discount_factor() >= 1.0) {
+		throw CoreException();
+	}
+
+	compiled = nullptr;
+	model.compile(S, A, lmdp->get_state_transitions(), R, h);
+	model.compile_interleaved_rewards();
+	compiled = lmdp;
+}
+
+void PolicyEvaluator::evaluate(PolicyMap *policy, std::vector<std::unordered_map<State *, double> > &V)
+{
+	if (compiled == nullptr) {
+		throw CoreException();
+	}
+
+	unsigned int n = model.get_num_states();
+	unsigned int k = model.get_num_rewards();
+	double gamma = model.get_discount_factor();
+	double convergenceCriterion = epsilon * std::max(0.1, (1.0 - gamma) / gamma);
+
+	restrict_to_policy(policy);
+
+	bool swept = true;
+	converged = true;
+
+	if (method == POLICY_EVALUATION_SWEEPS) {
+		values.assign((size_t)n * k, 0.0);
+		sweeps = compute_sweeps(convergenceCriterion);
+	} else {
+		compute_system();
+
+		result.resize(k);
+		for (int i = 0; i < (int)k; i++) {
+			result[i].assign(n, 0.0);
+		}
+
+		// Each reward is an independent right-hand side of the same system, so the rewards are split
+		// over the threads.
+		std::vector<unsigned int> iterations(k, 0);
+		std::vector<unsigned char> rewardConverged(k, 0);
+
+		krylov.resize(std::max(krylov.size(), (std::size_t)pool->get_num_threads()));
+
+		pool->run(k, [&](unsigned int worker, unsigned int begin, unsigned int end) {
+			for (unsigned int i = begin; i < end; i++) {
+				if (method == POLICY_EVALUATION_BICGSTAB) {
+					rewardConverged[i] = compute_bicgstab(expectedRewards[i], result[i], convergenceCriterion, iterations[i], krylov[worker]);
+				} else {
+					rewardConverged[i] = compute_gmres(expectedRewards[i], result[i], convergenceCriterion, iterations[i], krylov[worker]);
+				}
+			}
+		});
+
+		sweeps = *std::max_element(iterations.begin(), iterations.end());
+		swept = (std::find(rewardConverged.begin(), rewardConverged.end(), 0) != rewardConverged.end());
+
+		// If any reward did not converge, finish all of them with sweeps from where they stopped. A
+		// reward whose solver broke down with non-finite values starts over from zero instead.
+		if (swept) {
+			for (int i = 0; i < (int)k; i++) {
+				if (std::find_if(result[i].begin(), result[i].end(),
+						[](double value) { return !std::isfinite(value); }) != result[i].end()) {
+					result[i].assign(n, 0.0);
+				}
+			}
+
+			values.resize((size_t)n * k);
+			for (int s = 0; s < (int)n; s++) {
+				for (int i = 0; i < (int)k; i++) {
+					values[(size_t)s * k + i] = result[i][s];
+				}
+			}
+			sweeps += compute_sweeps(convergenceCriterion);
+		}
+	}
+
+	// Split the interleaved values back into one value function for each reward.
+	if (swept) {
+		result.resize(k);
+		for (int i = 0; i < (int)k; i++) {
+			result[i].resize(n);
+			for (int s = 0; s < (int)n; s++) {
+				result[i][s] = values[(size_t)s * k + i];
+			}
+		}
+	}
+
+	model.convert_values(result, V);
+}
+
+void PolicyEvaluator::evaluate(LMDP *lmdp, PolicyMap *policy, std::vector<std::unordered_map<State *, double> > &V)
+{
+	if (lmdp != compiled) {
+		compile(lmdp);
+	}
+	evaluate(policy, V);
+}
+
+bool PolicyEvaluator::evaluate_partition(const CompiledLMDP &lmdp, unsigned int i,
+		const std::vector<unsigned int> &Pj, const std::vector<unsigned int> &pij,
+		std::vector<double> &Vi, double convergenceCriterion)
+{
+	unsigned int n = lmdp.get_num_states();
+	unsigned int m = lmdp.get_num_actions();
+	unsigned int size = (unsigned int)Pj.size();
+	double gamma = lmdp.get_discount_factor();
+
+	const std::vector<unsigned int> &rows = lmdp.get_rows();
+	const std::vector<unsigned int> &successors = lmdp.get_successors();
+	const std::vector<double> &probabilities = lmdp.get_probabilities();
+	const std::vector<double> &rewards = lmdp.get_expected_rewards(i);
+
+	// The position of each state in the partition, or the partition's size for the states outside it.
+	partitionPositions.assign(n, size);
+	for (unsigned int p = 0; p < size; p++) {
+		partitionPositions[Pj[p]] = p;
+	}
+
+	matrixRows.clear();
+	matrixColumns.clear();
+	matrixValues.clear();
+	matrixDiagonal.resize(size);
+
+	expectedRewards.resize(1);
+	expectedRewards[0].resize(size);
+	partitionValues.resize(size);
+
+	// The states outside the partition keep their values, so their part of each backup is constant
+	// and moves to the right-hand side.
+	for (unsigned int p = 0; p < size; p++) {
+		unsigned int row = Pj[p] * m + pij[p];
+		double bp = rewards[row];
+
+		matrixRow.clear();
+		matrixRow.push_back(std::make_pair(p, 1.0));
+
+		for (unsigned int t = rows[row]; t < rows[row + 1]; t++) {
+			unsigned int q = partitionPositions[successors[t]];
+			if (q < size) {
+				matrixRow.push_back(std::make_pair(q, -gamma * probabilities[t]));
+			} else {
+				bp += gamma * probabilities[t] * Vi[successors[t]];
+			}
+		}
+
+		append_row(p);
+
+		expectedRewards[0][p] = bp;
+		partitionValues[p] = Vi[Pj[p]];
+	}
+	matrixRows.push_back((unsigned int)matrixColumns.size());
+
+	compute_preconditioner();
+
+	krylov.resize(std::max(krylov.size(), (std::size_t)1));
+
+	bool solved = false;
+	if (method == POLICY_EVALUATION_GMRES) {
+		solved = compute_gmres(expectedRewards[0], partitionValues, convergenceCriterion, sweeps, krylov[0]);
+	} else {
+		solved = compute_bicgstab(expectedRewards[0], partitionValues, convergenceCriterion, sweeps, krylov[0]);
+	}
+
+	if (solved) {
+		for (unsigned int p = 0; p < size; p++) {
+			Vi[Pj[p]] = partitionValues[p];
+		}
+	}
+
+	return solved;
+}
+
+void PolicyEvaluator::restrict_to_policy(PolicyMap *policy)
+{
+	unsigned int n = model.get_num_states();
+	unsigned int m = model.get_num_actions();
+	unsigned int k = model.get_num_rewards();
+
+	const std::vector<unsigned int> &rows = model.get_rows();
+	const std::vector<unsigned int> &successors = model.get_successors();
+	const std::vector<double> &probabilities = model.get_probabilities();
+	const std::vector<double> &rewards = model.get_expected_rewards_interleaved();
+
+	policyRows.clear();
+	policyRows.reserve(n + 1);
+	policySuccessors.clear();
+	policyProbabilities.clear();
+	policyRewards.clear();
+
+	// Copy the row of the policy's action at each state, so that each sweep reads contiguous memory.
+	for (int s = 0; s < (int)n; s++) {
+		policyRows.push_back((unsigned int)policySuccessors.size());
+
+		unsigned int row = s * m + model.get_action_index(policy->get(model.get_state(s)));
+		policySuccessors.insert(policySuccessors.end(),
+				successors.begin() + rows[row], successors.begin() + rows[row + 1]);
+		policyProbabilities.insert(policyProbabilities.end(),
+				probabilities.begin() + rows[row], probabilities.begin() + rows[row + 1]);
+		policyRewards.insert(policyRewards.end(),
+				rewards.begin() + (size_t)row * k, rewards.begin() + (size_t)(row + 1) * k);
+	}
+	policyRows.push_back((unsigned int)policySuccessors.size());
+}
+
+unsigned int PolicyEvaluator::compute_sweeps(double convergenceCriterion)
+{
+	unsigned int n = model.get_num_states();
+	unsigned int k = model.get_num_rewards();
+
+	valuesNext.resize((size_t)n * k);
+
+	unsigned int sweep = 0;
+	double maxDifference = 0.0;
+	do {
+		maxDifference = compute_sweep();
+		std::swap(values, valuesNext);
+		sweep++;
+	} while (maxDifference > convergenceCriterion && sweep < maxIterations);
+
+	converged = (maxDifference <= convergenceCriterion);
+
+	return sweep;
+}
+
+double PolicyEvaluator::compute_sweep()
+{
+	unsigned int n = model.get_num_states();
+	unsigned int k = model.get_num_rewards();
+	double gamma = model.get_discount_factor();
+
+	const unsigned int *rows = policyRows.data();
+	const unsigned int *successors = policySuccessors.data();
+	const double *T = policyProbabilities.data();
+	const double *R = policyRewards.data();
+	const double *V = values.data();
+	double *VNext = valuesNext.data();
+
+	// Each thread takes a contiguous chunk of the states and keeps its own largest difference.
+	pool->run(n, [&](unsigned int worker, unsigned int begin, unsigned int end) {
+		double workerDifference = 0.0;
+
+		for (unsigned int s = begin; s < end; s++) {
+			double *VNexts = VNext + (size_t)s * k;
+			for (unsigned int i = 0; i < k; i++) {
+				VNexts[i] = 0.0;
+			}
+
+			for (unsigned int t = rows[s]; t < rows[s + 1]; t++) {
+				const double *Vt = V + (size_t)successors[t] * k;
+				for (unsigned int i = 0; i < k; i++) {
+					VNexts[i] += T[t] * Vt[i];
+				}
+			}
+
+			for (unsigned int i = 0; i < k; i++) {
+				VNexts[i] = R[(size_t)s * k + i] + gamma * VNexts[i];
+			}
+
+			for (unsigned int i = 0; i < k; i++) {
+				workerDifference = std::max(workerDifference, std::fabs(V[(size_t)s * k + i] - VNexts[i]));
+			}
+		}
+
+		pool->get_scratch(worker).assign(1, workerDifference);
+	});
+
+	double maxDifference = 0.0;
+	for (unsigned int worker = 0; worker < pool->get_num_threads(); worker++) {
+		maxDifference = std::max(maxDifference, pool->get_scratch(worker)[0]);
+	}
+	return maxDifference;
+}
+
+void PolicyEvaluator::compute_system()
+{
+	unsigned int n = model.get_num_states();
+	unsigned int k = model.get_num_rewards();
+	double gamma = model.get_discount_factor();
+
+	matrixRows.clear();
+	matrixRows.reserve(n + 1);
+	matrixColumns.clear();
+	matrixColumns.reserve(policySuccessors.size() + n);
+	matrixValues.clear();
+	matrixValues.reserve(policySuccessors.size() + n);
+	matrixDiagonal.resize(n);
+
+	expectedRewards.resize(k);
+	for (int i = 0; i < (int)k; i++) {
+		expectedRewards[i].resize(n);
+		for (int s = 0; s < (int)n; s++) {
+			expectedRewards[i][s] = policyRewards[(size_t)s * k + i];
+		}
+	}
+
+	// Each row is the identity minus gamma times the policy's transitions.
+	for (int s = 0; s < (int)n; s++) {
+		matrixRow.clear();
+		matrixRow.push_back(std::make_pair((unsigned int)s, 1.0));
+
+		for (unsigned int t = policyRows[s]; t < policyRows[s + 1]; t++) {
+			matrixRow.push_back(std::make_pair(policySuccessors[t], -gamma * policyProbabilities[t]));
+		}
+
+		append_row(s);
+	}
+	matrixRows.push_back((unsigned int)matrixColumns.size());
+
+	compute_preconditioner();
+}
+
+void PolicyEvaluator::append_row(unsigned int s)
+{
+	// The columns are sorted and merged, with an explicit diagonal, as ILU(0) requires.
+	std::sort(matrixRow.begin(), matrixRow.end(),
+			[](const std::pair<unsigned int, double> &a, const std::pair<unsigned int, double> &b) {
+		return a.first < b.first;
+	});
+
+	matrixRows.push_back((unsigned int)matrixColumns.size());
+	for (const std::pair<unsigned int, double> &entry : matrixRow) {
+		if (matrixColumns.size() > matrixRows.back() && matrixColumns.back() == entry.first) {
+			matrixValues.back() += entry.second;
+			continue;
+		}
+		if (entry.first == s) {
+			matrixDiagonal[s] = (unsigned int)matrixColumns.size();
+		}
+		matrixColumns.push_back(entry.first);
+		matrixValues.push_back(entry.second);
+	}
+}
+
+void PolicyEvaluator::compute_preconditioner()
+{
+	unsigned int n = (unsigned int)matrixDiagonal.size();
+
+	if (preconditioner == POLICY_PRECONDITIONER_JACOBI) {
+		preconditionerValues.resize(n);
+		for (int s = 0; s < (int)n; s++) {
+			preconditionerValues[s] = 1.0 / matrixValues[matrixDiagonal[s]];
+		}
+	} else if (preconditioner == POLICY_PRECONDITIONER_ILU0) {
+		// Factor in place within the sparsity pattern of the matrix. The matrix is strictly
+		// diagonally dominant for gamma < 1, so the pivots never vanish.
+		preconditionerValues = matrixValues;
+		std::vector<int> &position = preconditionerPositions;
+		position.assign(n, -1);
+
+		for (int s = 0; s < (int)n; s++) {
+			for (unsigned int p = matrixRows[s]; p < matrixRows[s + 1]; p++) {
+				position[matrixColumns[p]] = (int)p;
+			}
+
+			for (unsigned int p = matrixRows[s]; p < matrixDiagonal[s]; p++) {
+				unsigned int c = matrixColumns[p];
+				preconditionerValues[p] /= preconditionerValues[matrixDiagonal[c]];
+
+				for (unsigned int q = matrixDiagonal[c] + 1; q < matrixRows[c + 1]; q++) {
+					int w = position[matrixColumns[q]];
+					if (w >= 0) {
+						preconditionerValues[w] -= preconditionerValues[p] * preconditionerValues[q];
+					}
+				}
+			}
+
+			for (unsigned int p = matrixRows[s]; p < matrixRows[s + 1]; p++) {
+				position[matrixColumns[p]] = -1;
+			}
+		}
+	} else {
+		preconditionerValues.clear();
+	}
+}
+
+void PolicyEvaluator::compute_product(const std::vector<double> &x, std::vector<double> &y) const
+{
+	unsigned int n = (unsigned int)matrixDiagonal.size();
+
+	for (unsigned int s = 0; s < n; s++) {
+		double sum = 0.0;
+		for (unsigned int p = matrixRows[s]; p < matrixRows[s + 1]; p++) {
+			sum += matrixValues[p] * x[matrixColumns[p]];
+		}
+		y[s] = sum;
+	}
+}
+
+double PolicyEvaluator::compute_residual(const std::vector<double> &b, const std::vector<double> &x,
+		std::vector<double> &r) const
+{
+	compute_product(x, r);
+
+	double largest = 0.0;
+	for (unsigned int s = 0; s < r.size(); s++) {
+		r[s] = b[s] - r[s];
+		largest = update_largest(largest, r[s]);
+	}
+	return largest;
+}
+
+void PolicyEvaluator::compute_preconditioned(const std::vector<double> &r, std::vector<double> &z) const
+{
+	unsigned int n = (unsigned int)matrixDiagonal.size();
+
+	if (preconditioner == POLICY_PRECONDITIONER_JACOBI) {
+		for (unsigned int s = 0; s < n; s++) {
+			z[s] = preconditionerValues[s] * r[s];
+		}
+	} else if (preconditioner == POLICY_PRECONDITIONER_ILU0) {
+		// Forward substitution with the unit lower triangle, then back substitution with the upper.
+		for (unsigned int s = 0; s < n; s++) {
+			double sum = r[s];
+			for (unsigned int p = matrixRows[s]; p < matrixDiagonal[s]; p++) {
+				sum -= preconditionerValues[p] * z[matrixColumns[p]];
+			}
+			z[s] = sum;
+		}
+
+		for (int s = (int)n - 1; s >= 0; s--) {
+			double sum = z[s];
+			for (unsigned int p = matrixDiagonal[s] + 1; p < matrixRows[s + 1]; p++) {
+				sum -= preconditionerValues[p] * z[matrixColumns[p]];
+			}
+			z[s] = sum / preconditionerValues[matrixDiagonal[s]];
+		}
+	} else {
+		z = r;
+	}
+}
+
+bool PolicyEvaluator::compute_bicgstab(const std::vector<double> &b, std::vector<double> &x,
+		double convergenceCriterion, unsigned int &iterations, PolicyEvaluatorKrylov &krylov) const
+{
+	unsigned int n = (unsigned int)matrixDiagonal.size();
+
+	std::vector<double> &r = krylov.r;
+	std::vector<double> &rHat = krylov.rHat;
+	std::vector<double> &p = krylov.p;
+	std::vector<double> &pHat = krylov.pHat;
+	std::vector<double> &v = krylov.v;
+	std::vector<double> &sHat = krylov.sHat;
+	std::vector<double> &t = krylov.t;
+
+	r.resize(n);
+	p.assign(n, 0.0);
+	pHat.resize(n);
+	v.assign(n, 0.0);
+	sHat.resize(n);
+	t.resize(n);
+
+	auto dot = [n](const std::vector<double> &a, const std::vector<double> &c) {
+		double sum = 0.0;
+		for (unsigned int s = 0; s < n; s++) {
+			sum += a[s] * c[s];
+		}
+		return sum;
+	};
+
+	iterations = 0;
+	if (compute_residual(b, x, r) <= convergenceCriterion) {
+		return true;
+	}
+	rHat = r;
+
+	double rho = 1.0;
+	double alpha = 1.0;
+	double omega = 1.0;
+
+	while (iterations < maxIterations) {
+		iterations++;
+
+		double rhoNext = dot(rHat, r);
+		if (!std::isfinite(rhoNext)) {
+			return false;
+		}
+		if (rhoNext == 0.0 || omega == 0.0) {
+			// Breakdown: restart from the true residual of the current solution.
+			compute_residual(b, x, r);
+			rHat = r;
+			std::fill(p.begin(), p.end(), 0.0);
+			std::fill(v.begin(), v.end(), 0.0);
+			rho = alpha = omega = 1.0;
+			rhoNext = dot(rHat, r);
+			if (rhoNext == 0.0) {
+				return false;
+			}
+		}
+
+		double beta = (rhoNext / rho) * (alpha / omega);
+		rho = rhoNext;
+		for (unsigned int s = 0; s < n; s++) {
+			p[s] = r[s] + beta * (p[s] - omega * v[s]);
+		}
+
+		compute_preconditioned(p, pHat);
+		compute_product(pHat, v);
+
+		// Breakdown: the step length is undefined, so stop and let the caller fall back to sweeps.
+		double rHatV = dot(rHat, v);
+		if (rHatV == 0.0 || !std::isfinite(rHatV)) {
+			return false;
+		}
+		alpha = rho / rHatV;
+		if (!std::isfinite(alpha)) {
+			return false;
+		}
+
+		// The residual r now becomes s = r - alpha v.
+		double largest = 0.0;
+		for (unsigned int s = 0; s < n; s++) {
+			x[s] += alpha * pHat[s];
+			r[s] -= alpha * v[s];
+			largest = update_largest(largest, r[s]);
+		}
+		if (largest <= convergenceCriterion && compute_residual(b, x, r) <= convergenceCriterion) {
+			return true;
+		}
+
+		compute_preconditioned(r, sHat);
+		compute_product(sHat, t);
+		double tt = dot(t, t);
+		omega = (tt == 0.0) ? 0.0 : dot(t, r) / tt;
+		if (!std::isfinite(omega)) {
+			return false;
+		}
+
+		largest = 0.0;
+		for (unsigned int s = 0; s < n; s++) {
+			x[s] += omega * sHat[s];
+			r[s] -= omega * t[s];
+			largest = update_largest(largest, r[s]);
+		}
+
+		// The recurrence drifts from the true residual, so confirm convergence with the latter.
+		if (largest <= convergenceCriterion && compute_residual(b, x, r) <= convergenceCriterion) {
+			return true;
+		}
+	}
+
+	return false;
+}
+
+bool PolicyEvaluator::compute_gmres(const std::vector<double> &b, std::vector<double> &x,
+		double convergenceCriterion, unsigned int &iterations, PolicyEvaluatorKrylov &krylov) const
+{
+	unsigned int n = (unsigned int)matrixDiagonal.size();
+	unsigned int restart = gmresRestart;
+
+	std::vector<double> &r = krylov.r;
+	std::vector<double> &w = krylov.w;
+	std::vector<double> &z = krylov.z;
+	std::vector<std::vector<double> > &basis = krylov.basis;
+
+	r.resize(n);
+	w.resize(n);
+	z.resize(n);
+	basis.resize(restart + 1);
+	for (std::vector<double> &vector : basis) {
+		vector.resize(n);
+	}
+
+	// The Hessenberg matrix, column by column, and the Givens rotations which make it triangular.
+	std::vector<std::vector<double> > &H = krylov.H;
+	std::vector<double> &cs = krylov.cs;
+	std::vector<double> &sn = krylov.sn;
+	std::vector<double> &g = krylov.g;
+	std::vector<double> &y = krylov.y;
+
+	H.resize(restart);
+	for (std::vector<double> &column : H) {
+		column.resize(restart + 1);
+	}
+	cs.resize(restart);
+	sn.resize(restart);
+	g.resize(restart + 1);
+	y.resize(restart);
+
+	iterations = 0;
+
+	while (true) {
+		double residual = compute_residual(b, x, r);
+		if (residual <= convergenceCriterion) {
+			return true;
+		}
+		if (iterations >= maxIterations || !std::isfinite(residual)) {
+			return false;
+		}
+
+		double beta = 0.0;
+		for (unsigned int s = 0; s < n; s++) {
+			beta += r[s] * r[s];
+		}
+		beta = std::sqrt(beta);
+
+		for (unsigned int s = 0; s < n; s++) {
+			basis[0][s] = r[s] / beta;
+		}
+		std::fill(g.begin(), g.end(), 0.0);
+		g[0] = beta;
+
+		unsigned int j = 0;
+		while (j < restart && iterations < maxIterations) {
+			iterations++;
+
+			compute_preconditioned(basis[j], z);
+			compute_product(z, w);
+
+			// Modified Gram-Schmidt against the basis so far.
+			for (unsigned int i = 0; i <= j; i++) {
+				double h = 0.0;
+				for (unsigned int s = 0; s < n; s++) {
+					h += w[s] * basis[i][s];
+				}
+				H[j][i] = h;
+				for (unsigned int s = 0; s < n; s++) {
+					w[s] -= h * basis[i][s];
+				}
+			}
+
+			double norm = 0.0;
+			for (unsigned int s = 0; s < n; s++) {
+				norm += w[s] * w[s];
+			}
+			norm = std::sqrt(norm);
+			H[j][j + 1] = norm;
+
+			if (norm > 0.0) {
+				for (unsigned int s = 0; s < n; s++) {
+					basis[j + 1][s] = w[s] / norm;
+				}
+			}
+
+			for (unsigned int i = 0; i < j; i++) {
+				double h = cs[i] * H[j][i] + sn[i] * H[j][i + 1];
+				H[j][i + 1] = -sn[i] * H[j][i] + cs[i] * H[j][i + 1];
+				H[j][i] = h;
+			}
+
+			double radius = std::hypot(H[j][j], H[j][j + 1]);
+			cs[j] = H[j][j] / radius;
+			sn[j] = H[j][j + 1] / radius;
+			H[j][j] = radius;
+			H[j][j + 1] = 0.0;
+			g[j + 1] = -sn[j] * g[j];
+			g[j] = cs[j] * g[j];
+
+			j++;
+
+			// The 2-norm of the residual bounds its largest element, so this suffices to stop.
+			if (std::fabs(g[j]) <= convergenceCriterion || norm == 0.0) {
+				break;
+			}
+		}
+
+		// Solve the triangular system for the coefficients, then add the preconditioned combination.
+		for (int i = (int)j - 1; i >= 0; i--) {
+			double sum = g[i];
+			for (unsigned int q = i + 1; q < j; q++) {
+				sum -= H[q][i] * y[q];
+			}
+			y[i] = sum / H[i][i];
+		}
+
+		std::fill(w.begin(), w.end(), 0.0);
+		for (unsigned int i = 0; i < j; i++) {
+			for (unsigned int s = 0; s < n; s++) {
+				w[s] += y[i] * basis[i][s];
+			}
+		}
+		compute_preconditioned(w, z);
+		for (unsigned int s = 0; s < n; s++) {
+			x[s] += z[s];
+		}
+	}
+}
+
+const std::vector<std::vector<double> > &PolicyEvaluator::get_values() const
+{
+	return result;
+}
+
+const CompiledLMDP &PolicyEvaluator::get_model() const
+{
+	return model;
+}
+
+void PolicyEvaluator::set_tolerance(double tolerance)
+{
+	epsilon = tolerance;
+}
+
+double PolicyEvaluator::get_tolerance() const
+{
+	return epsilon;
+}
+
+void PolicyEvaluator::set_num_threads(unsigned int numThreads)
+{
+	delete pool;
+	pool = new ThreadPool(std::max(1u, numThreads));
+}
+
+unsigned int PolicyEvaluator::get_num_threads() const
+{
+	return pool->get_num_threads();
+}
+
+void PolicyEvaluator::set_method(PolicyEvaluationMethod method)
+{
+	this->method = method;
+}
+
+PolicyEvaluationMethod PolicyEvaluator::get_method() const
+{
+	return method;
+}
+
+void PolicyEvaluator::set_preconditioner(PolicyEvaluationPreconditioner preconditioner)
+{
+	this->preconditioner = preconditioner;
+}
+
+PolicyEvaluationPreconditioner PolicyEvaluator::get_preconditioner() const
+{
+	return preconditioner;
+}
+
+void PolicyEvaluator::set_gmres_restart(unsigned int restart)
+{
+	gmresRestart = std::max(1u, restart);
+}
+
+unsigned int PolicyEvaluator::get_gmres_restart() const
+{
+	return gmresRestart;
+}
+
+void PolicyEvaluator::set_max_iterations(unsigned int iterations)
+{
+	maxIterations = iterations;
+}
+
+unsigned int PolicyEvaluator::get_max_iterations() const
+{
+	return maxIterations;
+}
+
+unsigned int PolicyEvaluator::get_num_sweeps() const
+{
+	return sweeps;
+}
+
+bool PolicyEvaluator::get_converged() const
+{
+	return converged;
+}
@@ -0,0 +1,144 @@
+/**
+ *  The MIT License (MIT)
+ *
+ *  Copyright (c) 2014 Kyle Wray, University of Massachusetts
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy of
+ *  this software and associated documentation files (the "Software"), to deal in
+ *  the Software without restriction, including without limitation the rights to
+ *  use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ *  the Software, and to permit persons to whom the Software is furnished to do so,
+ *  subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ *  FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ *  COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ *  IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ *  CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+#include "../include/thread_pool.h"
+
+#include <algorithm>
+
+ThreadPool::ThreadPool(unsigned int numThreads)
+{
+	this->numThreads = std::max(1u, numThreads);
+
+	task = nullptr;
+	count = 0;
+	generation = 0;
+	remaining = 0;
+	stopping = false;
+
+	scratch.resize(this->numThreads);
+
+	for (unsigned int worker = 1; worker < this->numThreads; worker++) {
+		threads.push_back(std::thread(&ThreadPool::work, this, worker));
+	}
+}
+
+ThreadPool::~ThreadPool()
+{
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		stopping = true;
+	}
+	started.notify_all();
+
+	for (std::thread &thread : threads) {
+		thread.join();
+	}
+}
+
+void ThreadPool::run(unsigned int count,
+		const std::function<void (unsigned int, unsigned int, unsigned int)> &task)
+{
+	// Handle the trivial case without waking any threads.
+	if (numThreads == 1) {
+		task(0, 0, count);
+		return;
+	}
+
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		this->task = &task;
+		this->count = count;
+		remaining = numThreads - 1;
+		generation++;
+	}
+	started.notify_all();
+
+	// The calling thread does the first chunk, then waits for the others.
+	run_chunk(0);
+
+	std::exception_ptr exception;
+	{
+		std::unique_lock<std::mutex> lock(mutex);
+		finished.wait(lock, [this] { return remaining == 0; });
+		this->task = nullptr;
+		std::swap(exception, error);
+	}
+
+	// Only rethrow once no thread can still reach the task, which lives in the caller's frame.
+	if (exception) {
+		std::rethrow_exception(exception);
+	}
+}
+
+std::vector<double> &ThreadPool::get_scratch(unsigned int worker)
+{
+	return scratch[worker];
+}
+
+unsigned int ThreadPool::get_num_threads() const
+{
+	return numThreads;
+}
+
+void ThreadPool::work(unsigned int worker)
+{
+	unsigned long lastGeneration = 0;
+
+	while (true) {
+		{
+			std::unique_lock<std::mutex> lock(mutex);
+			started.wait(lock, [this, lastGeneration] { return stopping || generation != lastGeneration; });
+			if (stopping) {
+				return;
+			}
+			lastGeneration = generation;
+		}
+
+		run_chunk(worker);
+
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			remaining--;
+		}
+		finished.notify_one();
+	}
+}
+
+void ThreadPool::run_chunk(unsigned int worker)
+{
+	// Split the range as evenly as possible; the first (count % numThreads) chunks get one extra.
+	unsigned int size = count / numThreads;
+	unsigned int extra = count % numThreads;
+	unsigned int begin = worker * size + std::min(worker, extra);
+	unsigned int end = begin + size + (worker < extra ? 1 : 0);
+
+	try {
+		(*task)(worker, begin, end);
+	} catch (...) {
+		std::lock_guard<std::mutex> lock(mutex);
+		if (!error) {
+			error = std::current_exception();
+		}
+	}
+}
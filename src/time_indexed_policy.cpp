@@ -0,0 +1,138 @@
+/**
+ *  The MIT License (MIT)
+ *
+ *  Copyright (c) 2014 Kyle Wray, University of Massachusetts
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy of
+ *  this software and associated documentation files (the "Software"), to deal in
+ *  the Software without restriction, including without limitation the rights to
+ *  use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ *  the Software, and to permit persons to whom the Software is furnished to do so,
+ *  subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ *  FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ *  COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ *  IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ *  CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+#include "../include/time_indexed_policy.h"
+
+#include "../../librbr/librbr/include/core/policy/policy_exception.h"
+
+#include <algorithm>
+
+TimeIndexedPolicy::TimeIndexedPolicy(unsigned int horizon, const std::vector<State *> &states,
+		const std::vector<Action *> &actions)
+{
+	this->horizon = horizon;
+	this->states = states;
+	this->actions = actions;
+
+	stateIndices.reserve(states.size());
+	for (int s = 0; s < (int)states.size(); s++) {
+		stateIndices[states[s]] = s;
+	}
+
+	nextStep = horizon;
+}
+
+TimeIndexedPolicy::~TimeIndexedPolicy()
+{ }
+
+void TimeIndexedPolicy::record(unsigned int t, const std::vector<unsigned int> &stepActions)
+{
+	unsigned int n = (unsigned int)states.size();
+
+	if (t + 1 != nextStep || stepActions.size() != n) {
+		throw PolicyException();
+	}
+
+	// A state whose action at t differs from the one at t + 1 changes at t + 1.
+	if (nextStep < horizon) {
+		for (unsigned int s = 0; s < n; s++) {
+			if (stepActions[s] != next[s]) {
+				pending.push_back(s);
+				pending.push_back(nextStep);
+				pending.push_back(next[s]);
+			}
+		}
+	}
+
+	next = stepActions;
+	nextStep = t;
+
+	if (t > 0) {
+		return;
+	}
+
+	// Every state starts with its action at step 0. Bucket the change points by state; each state's
+	// were recorded in decreasing order of step, so they are filled in from the end of its row.
+	for (unsigned int s = 0; s < n; s++) {
+		pending.push_back(s);
+		pending.push_back(0);
+		pending.push_back(next[s]);
+	}
+
+	rows.assign(n + 1, 0);
+	for (unsigned int p = 0; p < pending.size(); p += 3) {
+		rows[pending[p] + 1]++;
+	}
+	for (unsigned int s = 0; s < n; s++) {
+		rows[s + 1] += rows[s];
+	}
+
+	steps.resize(pending.size() / 3);
+	this->stepActions.resize(pending.size() / 3);
+
+	std::vector<unsigned int> fill(rows.begin() + 1, rows.end());
+	for (unsigned int p = 0; p < pending.size(); p += 3) {
+		unsigned int position = --fill[pending[p]];
+		steps[position] = pending[p + 1];
+		this->stepActions[position] = pending[p + 2];
+	}
+
+	pending.clear();
+	pending.shrink_to_fit();
+	next.clear();
+	next.shrink_to_fit();
+}
+
+Action *TimeIndexedPolicy::get(unsigned int t, State *state) const
+{
+	std::unordered_map<State *, unsigned int>::const_iterator stateIterator = stateIndices.find(state);
+	if (stateIterator == stateIndices.end()) {
+		throw PolicyException();
+	}
+	return actions[get_action_index(t, stateIterator->second)];
+}
+
+unsigned int TimeIndexedPolicy::get_action_index(unsigned int t, unsigned int s) const
+{
+	if (rows.empty() || t >= horizon || s >= states.size()) {
+		throw PolicyException();
+	}
+
+	// The last change point at or before t.
+	const unsigned int *first = steps.data() + rows[s];
+	const unsigned int *last = steps.data() + rows[s + 1];
+	const unsigned int *change = std::upper_bound(first, last, t) - 1;
+
+	return stepActions[change - steps.data()];
+}
+
+unsigned int TimeIndexedPolicy::get_horizon() const
+{
+	return horizon;
+}
+
+unsigned int TimeIndexedPolicy::get_num_changes() const
+{
+	return (unsigned int)steps.size();
+}
@@ -0,0 +1,184 @@
+/**
+ *  The MIT License (MIT)
+ *
+ *  Copyright (c) 2014 Kyle Wray, University of Massachusetts
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy of
+ *  this software and associated documentation files (the "Software"), to deal in
+ *  the Software without restriction, including without limitation the rights to
+ *  use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ *  the Software, and to permit persons to whom the Software is furnished to do so,
+ *  subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ *  FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ *  COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ *  IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ *  CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+
+/**
+ * Check that the outer iterations of LVI, and of the prioritized, topological, and LPI solvers, do not
+ * allocate once the solve is under way, by counting every call of the global operator new. The same LMDP
+ * is solved to tighter and tighter tolerances, i.e., with more and more outer iterations, and the
+ * allocations after the first outer iteration must not grow with the number of iterations. A few may
+ * remain, e.g., when a newly shrunk action set is interned, but there are as many of them however many
+ * iterations run. Build and run with
+ * make -C tests test, or alone with:
+ *     g++ -std=c++14 -O2 -pthread -o test_allocations tests/test_allocations.cpp src/lvi.cpp \
+ *         src/lvi_prioritized.cpp src/lvi_topological.cpp src/lpi.cpp src/policy_evaluator.cpp \
+ *         src/compiled_lmdp.cpp src/lmdp.cpp src/grid_lmdp.cpp src/thread_pool.cpp src/action_sets.cpp \
+ *         src/lvi_telemetry.cpp src/bellman_kernels.cpp src/lvi_workspace.cpp src/time_indexed_policy.cpp
+ * It returns 0 if the allocations do not grow.
+ */
+
+
+#include "../include/grid_lmdp.h"
+#include "../include/lvi.h"
+#include "../include/lvi_prioritized.h"
+#include "../include/lvi_topological.h"
+#include "../include/lpi.h"
+#include "../include/lvi_telemetry.h"
+
+#include <iostream>
+#include <vector>
+#include <string>
+#include <algorithm>
+#include <new>
+#include <cstdlib>
+
+/**
+ * The number of calls of the global operator new so far.
+ */
+static unsigned long long numAllocations = 0;
+
+void *operator new(std::size_t size)
+{
+	numAllocations++;
+	void *memory = std::malloc(size > 0 ? size : 1);
+	if (memory == nullptr) {
+		throw std::bad_alloc();
+	}
+	return memory;
+}
+
+void operator delete(void *memory) noexcept
+{
+	std::free(memory);
+}
+
+void operator delete(void *memory, std::size_t) noexcept
+{
+	std::free(memory);
+}
+
+/**
+ * A telemetry which remembers the number of allocations when the first outer iteration ends, and when
+ * the last one does.
+ */
+class AllocationTelemetry : public LVITelemetry {
+public:
+	AllocationTelemetry()
+	{
+		firstIteration = 0;
+		lastIteration = 0;
+		iterations = 0;
+	}
+
+	virtual ~AllocationTelemetry()
+	{ }
+
+	virtual bool is_enabled() const
+	{
+		return true;
+	}
+
+	virtual void record(const LVITelemetryRecord &record)
+	{
+		if (record.iteration == 1) {
+			firstIteration = numAllocations;
+		}
+		lastIteration = numAllocations;
+		iterations = record.iteration;
+	}
+
+	unsigned long long firstIteration;
+	unsigned long long lastIteration;
+	unsigned int iterations;
+};
+
+int main()
+{
+	GridLMDP lmdp(1, 10, 10, -0.03);
+	lmdp.set_slack(0.5f, 0.2f, 0.0f);
+	lmdp.set_split_conditional_preference();
+
+	std::vector<double> tolerances = {0.01, 0.0001, 0.000001, 0.00000001};
+
+	std::vector<std::string> names = {"LVI", "Prioritized", "Topological", "LPI", "Exact LPI"};
+
+	int failures = 0;
+
+	for (int solverIndex = 0; solverIndex < (int)names.size(); solverIndex++) {
+		unsigned int previousIterations = 0;
+		unsigned long long previousSteady = 0;
+		unsigned long long previousGrowths = 0;
+
+		for (double tolerance : tolerances) {
+			LVI *solver = nullptr;
+			if (solverIndex == 0) {
+				solver = new LVI(tolerance, false);
+			} else if (solverIndex == 1) {
+				solver = new LVIPrioritized(tolerance);
+			} else if (solverIndex == 2) {
+				solver = new LVITopological(tolerance);
+			} else {
+				solver = new LPI(tolerance, solverIndex == 3 ? 5 : 0);
+			}
+
+			AllocationTelemetry telemetry;
+			solver->set_telemetry(&telemetry);
+
+			PolicyMap *policy = solver->solve(&lmdp);
+			delete policy;
+
+			unsigned long long steady = telemetry.lastIteration - telemetry.firstIteration;
+			unsigned long long growths = solver->get_workspace().get_num_growths();
+
+			std::cout << names[solverIndex] << ", tolerance " << tolerance << ": " << telemetry.iterations <<
+					" iterations, " << steady << " allocations after the first iteration, " <<
+					growths << " buffer growths." << std::endl;
+
+			if (telemetry.iterations <= previousIterations) {
+				std::cout << "The tolerances did not increase the number of iterations." << std::endl;
+				failures++;
+			}
+
+			// A tighter tolerance may intern a few more action sets, which the workspace counts as growths.
+			if (previousIterations > 0 && steady > previousSteady + (growths - std::min(growths, previousGrowths))) {
+				std::cout << "The allocations grew with the number of iterations." << std::endl;
+				failures++;
+			}
+
+			previousIterations = telemetry.iterations;
+			previousSteady = steady;
+			previousGrowths = growths;
+
+			delete solver;
+		}
+	}
+
+	if (failures > 0) {
+		std::cout << "FAILED" << std::endl;
+		return 1;
+	}
+
+	std::cout << "PASSED" << std::endl;
+	return 0;
+}
@@ -0,0 +1,135 @@
+/**
+ *  The MIT License (MIT)
+ *
+ *  Copyright (c) 2014 Kyle Wray, University of Massachusetts
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy of
+ *  this software and associated documentation files (the "Software"), to deal in
+ *  the Software without restriction, including without limitation the rights to
+ *  use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ *  the Software, and to permit persons to whom the Software is furnished to do so,
+ *  subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ *  FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ *  COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ *  IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ *  CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+
+/**
+ * Check that Anderson acceleration saves outer iterations without the looping version, where each
+ * outer iteration sweeps each reward once, and that the accelerated solve still finds the same policy.
+ * With a single ordering, the values of the last reward are within gamma / (1 - gamma) times the
+ * convergence criterion of those of the policy, since they are a plain sweep whose residual is within
+ * the criterion; this is checked against an independent policy evaluation. Build and run with
+ * make -C tests test, or alone with:
+ *     g++ -std=c++14 -O2 -pthread -o test_anderson tests/test_anderson.cpp src/lvi.cpp \
+ *         src/compiled_lmdp.cpp src/lmdp.cpp src/grid_lmdp.cpp src/thread_pool.cpp src/action_sets.cpp \
+ *         src/lvi_telemetry.cpp src/bellman_kernels.cpp src/lvi_workspace.cpp src/time_indexed_policy.cpp \
+ *         src/policy_evaluator.cpp
+ * It returns 0 if the acceleration saved iterations and kept the policy and the bound.
+ */
+
+
+#include "../include/grid_lmdp.h"
+#include "../include/lvi.h"
+#include "../include/policy_evaluator.h"
+
+#include "../../librbr/librbr/include/core/states/state_utilities.h"
+
+#include <iostream>
+#include <cmath>
+#include <algorithm>
+
+int main()
+{
+	double tolerance = 0.00001;
+
+	int failures = 0;
+
+	for (int split = 0; split < 2; split++) {
+		GridLMDP lmdp(1, 10, 10, -0.03);
+		lmdp.set_slack(0.5f, 0.2f, 0.0f);
+		if (split == 1) {
+			lmdp.set_split_conditional_preference();
+		} else {
+			lmdp.set_default_conditional_preference();
+		}
+
+		StatesMap *S = dynamic_cast<StatesMap *>(lmdp.get_states());
+
+		double gamma = lmdp.get_horizon()->get_discount_factor();
+		double bound = gamma / (1.0 - gamma) * tolerance * std::max(0.1, (1.0 - gamma) / gamma);
+
+		for (unsigned int depth = 1; depth <= 5; depth += 2) {
+			LVI solver(tolerance, false);
+			solver.set_anderson_depth(depth);
+
+			LVIAccelerationReport report = solver.compare_acceleration(&lmdp);
+
+			std::cout << (split == 1 ? "Split" : "Default") << " preference, depth " << depth << ": " <<
+					report.plainIterations << " iterations without and " << report.acceleratedIterations <<
+					" with acceleration, " << report.accepted << " accepted, " << report.rejected << " rejected, " <<
+					report.policyDifferences << " policy differences." << std::endl;
+
+			if (report.acceleratedIterations >= report.plainIterations) {
+				std::cout << "The acceleration did not save any iterations." << std::endl;
+				failures++;
+			}
+
+			if (report.accepted == 0) {
+				std::cout << "No extrapolation was kept." << std::endl;
+				failures++;
+			}
+
+			if (report.policyDifferences != 0) {
+				std::cout << "The accelerated policy differs." << std::endl;
+				failures++;
+			}
+
+			// The other rewards' values are of the policies restricted to their levels, and with the split
+			// preference the last reward differs between the partitions, so only this case has a V^pi.
+			if (split == 1) {
+				continue;
+			}
+
+			PolicyMap *policy = solver.solve(&lmdp);
+
+			PolicyEvaluator evaluator(tolerance * 0.001, 1);
+			std::vector<std::unordered_map<State *, double> > V;
+			evaluator.evaluate(&lmdp, policy, V);
+
+			int i = (int)V.size() - 1;
+
+			double maxDifference = 0.0;
+			for (auto state : *S) {
+				State *s = resolve(state);
+				maxDifference = std::max(maxDifference, std::fabs(V[i].at(s) - solver.get_V()[i].at(s)));
+			}
+
+			std::cout << "    The values of reward " << i << " are within " << maxDifference << " of V^pi, " <<
+					"with a bound of " << bound << "." << std::endl;
+
+			if (!(maxDifference <= bound)) {
+				failures++;
+			}
+
+			delete policy;
+		}
+	}
+
+	if (failures > 0) {
+		std::cout << "FAILED" << std::endl;
+		return 1;
+	}
+
+	std::cout << "PASSED" << std::endl;
+	return 0;
+}
@@ -0,0 +1,162 @@
+/**
+ *  The MIT License (MIT)
+ *
+ *  Copyright (c) 2014 Kyle Wray, University of Massachusetts
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy of
+ *  this software and associated documentation files (the "Software"), to deal in
+ *  the Software without restriction, including without limitation the rights to
+ *  use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ *  the Software, and to permit persons to whom the Software is furnished to do so,
+ *  subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ *  FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ *  COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ *  IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ *  CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+
+
+
+/**
+ * Check that a solve on its own thread gives the policy of a synchronous solve, and that one stopped
+ * by a time limit or a cancel still gives an action for every state and reports that it did not
+ * converge. A later synchronous solve with the same solver converges again. Build and run with
+ * make -C tests test, or alone with:
+ *     g++ -std=c++14 -O2 -pthread -o test_async tests/test_async.cpp src/lvi_async.cpp src/lvi.cpp \
+ *         src/compiled_lmdp.cpp src/lmdp.cpp src/grid_lmdp.cpp src/thread_pool.cpp src/action_sets.cpp \
+ *         src/lvi_telemetry.cpp src/bellman_kernels.cpp src/lvi_workspace.cpp src/time_indexed_policy.cpp
+ * It returns 0 if every solve gives a complete policy and reports its convergence correctly.
+ */
+
+
+#include "../include/grid_lmdp.h"
+#include "../include/lvi.h"
+#include "../include/lvi_async.h"
+
+#include "../../librbr/librbr/include/core/states/state_utilities.h"
+
+#include <iostream>
+#include <string>
+
+/**
+ * Count the states of an LMDP without an action in a policy, and those whose action differs from
+ * that of another policy.
+ * @param	lmdp		The LMDP.
+ * @param	policy		The policy to check.
+ * @param	expected	The policy to compare with, or nullptr to only check for missing actions.
+ * @param	missing		The number of states without an action. This will be modified.
+ * @param	differences	The number of states with another action. This will be modified.
+ */
+void count_differences(GridLMDP &lmdp, PolicyMap *policy, PolicyMap *expected,
+		unsigned int &missing, unsigned int &differences)
+{
+	StatesMap *S = dynamic_cast<StatesMap *>(lmdp.get_states());
+
+	missing = 0;
+	differences = 0;
+
+	for (auto state : *S) {
+		State *s = resolve(state);
+		Action *a = nullptr;
+		try {
+			a = policy->get(s);
+		} catch (const PolicyException &err) {
+		}
+
+		if (a == nullptr) {
+			missing++;
+		} else if (expected != nullptr && a != expected->get(s)) {
+			differences++;
+		}
+	}
+}
+
+int main()
+{
+	double tolerance = 0.0001;
+
+	GridLMDP lmdp(1, 10, 10, -0.03);
+	lmdp.set_slack(0.5f, 0.2f, 0.0f);
+	lmdp.set_split_conditional_preference();
+
+	int failures = 0;
+	unsigned int missing = 0;
+	unsigned int differences = 0;
+
+	LVI solver(tolerance, true);
+	PolicyMap *expected = solver.solve(&lmdp);
+
+	// Without a time limit, the solve on its own thread is the synchronous solve.
+	{
+		LVIAsyncSolve solve(&solver, &lmdp, 0.0);
+		PolicyMap *policy = solve.get();
+		count_differences(lmdp, policy, expected, missing, differences);
+
+		std::cout << "No time limit: converged " << solve.get_converged() << ", " << missing <<
+				" missing actions, " << differences << " policy differences." << std::endl;
+		if (!solve.get_converged() || missing > 0 || differences > 0) {
+			failures++;
+		}
+
+		delete policy;
+	}
+
+	// A time limit which has already passed stops the solve after its first outer iteration.
+	{
+		LVIAsyncSolve solve(&solver, &lmdp, 1e-9);
+		PolicyMap *policy = solve.get();
+		count_differences(lmdp, policy, nullptr, missing, differences);
+
+		std::cout << "Past time limit: converged " << solve.get_converged() << ", " << missing <<
+				" missing actions, error bound " << solve.get_error_bound() << "." << std::endl;
+		if (solve.get_converged() || missing > 0) {
+			failures++;
+		}
+
+		delete policy;
+	}
+
+	// A cancel stops the solve once every state has an action.
+	{
+		LVIAsyncSolve solve(&solver, &lmdp, 0.0);
+		solve.cancel();
+		PolicyMap *policy = solve.get();
+		count_differences(lmdp, policy, nullptr, missing, differences);
+
+		std::cout << "Cancelled: " << missing << " missing actions." << std::endl;
+		if (missing > 0) {
+			failures++;
+		}
+
+		delete policy;
+	}
+
+	// The deadline and cancel of the solves above do not carry over to the solver.
+	PolicyMap *policy = solver.solve(&lmdp);
+	count_differences(lmdp, policy, expected, missing, differences);
+
+	std::cout << "Synchronous again: converged " << solver.get_converged() << ", " << differences <<
+			" policy differences." << std::endl;
+	if (!solver.get_converged() || missing > 0 || differences > 0) {
+		failures++;
+	}
+
+	delete policy;
+	delete expected;
+
+	if (failures > 0) {
+		std::cout << "FAILED" << std::endl;
+		return 1;
+	}
+
+	std::cout << "PASSED" << std::endl;
+	return 0;
+}
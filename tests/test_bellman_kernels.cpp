@@ -0,0 +1,127 @@
+/**
+ *  The MIT License (MIT)
+ *
+ *  Copyright (c) 2014 Kyle Wray, University of Massachusetts
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy of
+ *  this software and associated documentation files (the "Software"), to deal in
+ *  the Software without restriction, including without limitation the rights to
+ *  use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ *  the Software, and to permit persons to whom the Software is furnished to do so,
+ *  subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ *  FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ *  COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ *  IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ *  CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+
+/**
+ * Check that each vectorized Bellman backup kernel which this processor supports is within the
+ * documented tolerance of the scalar kernel, over random rows of random lengths. Build and run with
+ * make -C tests test, or alone with:
+ *     g++ -std=c++14 -O2 -o test_bellman_kernels tests/test_bellman_kernels.cpp src/bellman_kernels.cpp
+ * It returns 0 if every kernel is within the tolerance.
+ */
+
+
+#include "../include/bellman_kernels.h"
+
+#include <iostream>
+#include <vector>
+#include <random>
+#include <cmath>
+#include <algorithm>
+
+int main()
+{
+	std::mt19937 generator(12345);
+	std::uniform_real_distribution<double> unit(0.0, 1.0);
+	std::uniform_real_distribution<double> value(-100.0, 100.0);
+
+	unsigned int n = 1000;
+	std::vector<double> V(n);
+	std::vector<float> VSingle(n);
+	for (unsigned int s = 0; s < n; s++) {
+		V[s] = value(generator);
+		VSingle[s] = (float)V[s];
+	}
+
+	// Rows of every length up to 70 cover the remainders of each vector width.
+	std::vector<unsigned int> successors;
+	std::vector<double> T;
+	std::vector<float> TSingle;
+	std::vector<unsigned int> rows(1, 0);
+	for (unsigned int length = 0; length <= 70; length++) {
+		for (unsigned int t = 0; t < length; t++) {
+			successors.push_back(generator() % n);
+			T.push_back(unit(generator));
+			TSingle.push_back((float)T.back());
+		}
+		rows.push_back((unsigned int)successors.size());
+	}
+
+	BellmanISA scalarISA = BELLMAN_ISA_SCALAR;
+	BellmanKernel scalar = bellman_select_kernel(scalarISA);
+	BellmanKernelFloat scalarSingle = bellman_select_kernel_float(scalarISA);
+
+	int failures = 0;
+
+	for (int requested = BELLMAN_ISA_SSE42; requested <= BELLMAN_ISA_AVX512; requested++) {
+		BellmanISA isa = (BellmanISA)requested;
+		BellmanKernel kernel = bellman_select_kernel(isa);
+		BellmanKernelFloat kernelSingle = bellman_select_kernel_float(isa);
+
+		if (isa != (BellmanISA)requested) {
+			std::cout << bellman_isa_name((BellmanISA)requested) << ": not supported, skipped." << std::endl;
+			continue;
+		}
+
+		double largest = 0.0;
+
+		for (unsigned int r = 0; r + 1 < rows.size(); r++) {
+			unsigned int begin = rows[r];
+			unsigned int end = rows[r + 1];
+
+			// The tolerance is (end - begin) * 2^-53 times the sum of the terms' absolute values.
+			double magnitude = 0.0;
+			double magnitudeSingle = 0.0;
+			for (unsigned int t = begin; t < end; t++) {
+				magnitude += std::fabs(T[t] * V[successors[t]]);
+				magnitudeSingle += std::fabs((double)TSingle[t] * (double)VSingle[successors[t]]);
+			}
+			double tolerance = (end - begin) * std::ldexp(1.0, -53) * magnitude;
+			double toleranceSingle = (end - begin) * std::ldexp(1.0, -53) * magnitudeSingle;
+
+			double error = std::fabs(kernel(successors.data(), T.data(), V.data(), begin, end) -
+					scalar(successors.data(), T.data(), V.data(), begin, end));
+			double errorSingle = std::fabs(kernelSingle(successors.data(), TSingle.data(), VSingle.data(), begin, end) -
+					scalarSingle(successors.data(), TSingle.data(), VSingle.data(), begin, end));
+
+			if (!(error <= tolerance) || !(errorSingle <= toleranceSingle)) {
+				std::cout << bellman_isa_name(isa) << ": row of length " << (end - begin) << " is off by " <<
+						error << " (double) and " << errorSingle << " (float)." << std::endl;
+				failures++;
+			}
+
+			largest = std::max(largest, error);
+		}
+
+		std::cout << bellman_isa_name(isa) << ": largest difference " << largest << "." << std::endl;
+	}
+
+	if (failures > 0) {
+		std::cout << "FAILED: " << failures << " rows were outside the tolerance." << std::endl;
+		return 1;
+	}
+
+	std::cout << "PASSED" << std::endl;
+	return 0;
+}
@@ -0,0 +1,199 @@
+/**
+ *  The MIT License (MIT)
+ *
+ *  Copyright (c) 2014 Kyle Wray, University of Massachusetts
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy of
+ *  this software and associated documentation files (the "Software"), to deal in
+ *  the Software without restriction, including without limitation the rights to
+ *  use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ *  the Software, and to permit persons to whom the Software is furnished to do so,
+ *  subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ *  FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ *  COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ *  IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ *  CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+
+
+
+/**
+ * Check that lexicographic backward induction over a finite horizon finds the values of the first
+ * reward of each partition that plain backward induction does, that the action of every state at
+ * every step is within the slack of one step of the best for that reward, and that telemetry records
+ * each reward of each partition once per step. Build and run with make -C tests test, or alone with:
+ *     g++ -std=c++14 -O2 -pthread -o test_finite_horizon tests/test_finite_horizon.cpp src/lvi.cpp \
+ *         src/compiled_lmdp.cpp src/lmdp.cpp src/grid_lmdp.cpp src/thread_pool.cpp src/action_sets.cpp \
+ *         src/lvi_telemetry.cpp src/bellman_kernels.cpp src/lvi_workspace.cpp src/time_indexed_policy.cpp
+ * It returns 0 if the values and every step of the policy match backward induction.
+ */
+
+
+#include "../include/grid_lmdp.h"
+#include "../include/lvi.h"
+#include "../include/compiled_lmdp.h"
+#include "../include/lvi_telemetry.h"
+#include "../include/time_indexed_policy.h"
+
+#include "../../librbr/librbr/include/core/horizon.h"
+
+#include <iostream>
+#include <string>
+#include <cmath>
+#include <limits>
+#include <algorithm>
+
+/**
+ * A grid world with a finite horizon in place of its discount factor.
+ */
+class FiniteGridLMDP : public GridLMDP {
+public:
+	/**
+	 * The constructor for the FiniteGridLMDP class.
+	 * @param	seed		The random seed.
+	 * @param	size		The size of the grid.
+	 * @param	blocked		The number of blocked cells.
+	 * @param	penalty		The penalty of each step.
+	 * @param	steps		The number of steps of the horizon.
+	 */
+	FiniteGridLMDP(unsigned int seed, unsigned int size, unsigned int blocked, double penalty,
+			unsigned int steps) : GridLMDP(seed, size, blocked, penalty) {
+		delete horizon;
+		horizon = new Horizon(steps);
+	}
+};
+
+/**
+ * Compute Q_i(s, a) from the compiled form of an LMDP.
+ * @param	model	The compiled LMDP.
+ * @param	i		The index of the reward factor.
+ * @param	s		The index of the state.
+ * @param	a		The index of the action.
+ * @param	Vi		The i-th value function of the next step, indexed by state index.
+ * @return	The value of Q_i(s, a).
+ */
+double compute_Q(const CompiledLMDP &model, unsigned int i, unsigned int s, unsigned int a,
+		const std::vector<double> &Vi)
+{
+	unsigned int row = s * model.get_num_actions() + a;
+
+	double Q = 0.0;
+	for (unsigned int r = model.get_rows()[row]; r < model.get_rows()[row + 1]; r++) {
+		Q += model.get_probabilities()[r] * Vi[model.get_successors()[r]];
+	}
+
+	return model.get_expected_rewards(i)[row] + model.get_discount_factor() * Q;
+}
+
+int main()
+{
+	unsigned int H = 10;
+
+	FiniteGridLMDP lmdp(1, 10, 10, -0.03, H);
+	lmdp.set_slack(0.5f, 0.2f, 0.0f);
+	lmdp.set_default_conditional_preference();
+
+	int failures = 0;
+
+	LVI solver(0.0001, true);
+	LVIRingTelemetry ring(10000);
+	solver.set_telemetry(&ring);
+
+	TimeIndexedPolicy *policy = solver.solve_finite(&lmdp);
+
+	CompiledLMDP model;
+	model.compile(dynamic_cast<StatesMap *>(lmdp.get_states()), dynamic_cast<ActionsMap *>(lmdp.get_actions()),
+			lmdp.get_state_transitions(), dynamic_cast<FactoredRewards *>(lmdp.get_rewards()),
+			lmdp.get_horizon());
+
+	unsigned int n = model.get_num_states();
+	unsigned int m = model.get_num_actions();
+	unsigned int k = model.get_num_rewards();
+
+	// The first reward of each state's partition is maximized over every action.
+	std::vector<std::vector<unsigned int> > P;
+	model.convert_partitions(lmdp.get_partitions(), P);
+
+	std::vector<unsigned int> first(n, 0);
+	unsigned int levels = 0;
+	for (int j = 0; j < (int)P.size(); j++) {
+		for (unsigned int s : P[j]) {
+			first[s] = lmdp.get_orderings()[j][0];
+		}
+		levels += (unsigned int)lmdp.get_orderings()[j].size();
+	}
+
+	// Since the horizon has no discount factor, the slack is spread evenly over its steps.
+	std::vector<double> eta(k);
+	for (int i = 0; i < (int)k; i++) {
+		eta[i] = lmdp.get_slack()[i] / (double)H;
+	}
+
+	std::vector<std::vector<double> > V(k, std::vector<double>(n, 0.0));
+	std::vector<std::vector<double> > VNext(k, std::vector<double>(n, 0.0));
+
+	unsigned int violations = 0;
+
+	for (int t = (int)H - 1; t >= 0; t--) {
+		for (unsigned int s = 0; s < n; s++) {
+			for (unsigned int i = 0; i < k; i++) {
+				double best = std::numeric_limits<double>::lowest();
+				for (unsigned int a = 0; a < m; a++) {
+					best = std::max(best, compute_Q(model, i, s, a, VNext[i]));
+				}
+				V[i][s] = best;
+			}
+
+			unsigned int i = first[s];
+			unsigned int a = model.get_action_index(policy->get(t, model.get_state(s)));
+			if (!(V[i][s] - compute_Q(model, i, s, a, VNext[i]) <= eta[i] + 1e-9)) {
+				violations++;
+			}
+		}
+
+		std::swap(V, VNext);
+	}
+
+	double maxDifference = 0.0;
+	for (unsigned int s = 0; s < n; s++) {
+		unsigned int i = first[s];
+		maxDifference = std::max(maxDifference, std::fabs(VNext[i][s] - solver.get_V()[i].at(model.get_state(s))));
+	}
+
+	std::cout << "The values of the first rewards differ from backward induction by " << maxDifference <<
+			", with " << violations << " actions beyond the slack of a step." << std::endl;
+	if (!(maxDifference <= 1e-9) || violations > 0) {
+		failures++;
+	}
+
+	std::cout << "Recorded " << ring.get_num_records() << " records over " << solver.get_num_iterations() <<
+			" steps." << std::endl;
+	if (solver.get_num_iterations() != H || ring.get_num_records() != H * levels) {
+		failures++;
+	}
+
+	for (unsigned int i = 0; i < k; i++) {
+		if (solver.get_num_sweeps()[i] != H) {
+			std::cout << "Reward " << i << " was swept " << solver.get_num_sweeps()[i] << " times." << std::endl;
+			failures++;
+		}
+	}
+
+	delete policy;
+
+	if (failures > 0) {
+		std::cout << "FAILED" << std::endl;
+		return 1;
+	}
+
+	std::cout << "PASSED" << std::endl;
+	return 0;
+}
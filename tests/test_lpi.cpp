@@ -0,0 +1,122 @@
+/**
+ *  The MIT License (MIT)
+ *
+ *  Copyright (c) 2014 Kyle Wray, University of Massachusetts
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy of
+ *  this software and associated documentation files (the "Software"), to deal in
+ *  the Software without restriction, including without limitation the rights to
+ *  use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ *  the Software, and to permit persons to whom the Software is furnished to do so,
+ *  subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ *  FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ *  COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ *  IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ *  CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+
+
+
+/**
+ * Check that LPI with exact evaluation and with m-step evaluation finds the same policy as LVI, and
+ * that the values exact LPI returns for the last reward are those of its policy, as an independent
+ * policy evaluation computes them. Build and run with
+ * make -C tests test, or alone with:
+ *     g++ -std=c++14 -O2 -pthread -o test_lpi tests/test_lpi.cpp src/lpi.cpp src/policy_evaluator.cpp \
+ *         src/lvi.cpp src/compiled_lmdp.cpp src/lmdp.cpp src/grid_lmdp.cpp src/thread_pool.cpp \
+ *         src/action_sets.cpp src/lvi_telemetry.cpp src/bellman_kernels.cpp src/lvi_workspace.cpp \
+ *         src/time_indexed_policy.cpp
+ * It returns 0 if the policies and values agree.
+ */
+
+
+#include "../include/grid_lmdp.h"
+#include "../include/lvi.h"
+#include "../include/lpi.h"
+#include "../include/policy_evaluator.h"
+
+#include "../../librbr/librbr/include/core/states/state_utilities.h"
+
+#include <iostream>
+#include <cmath>
+#include <algorithm>
+
+int main()
+{
+	GridLMDP lmdp(1, 10, 10, -0.03);
+	lmdp.set_slack(0.5f, 0.2f, 0.0f);
+	lmdp.set_default_conditional_preference();
+
+	double tolerance = 0.0001;
+
+	StatesMap *S = dynamic_cast<StatesMap *>(lmdp.get_states());
+
+	LVI lvi(tolerance, true);
+	PolicyMap *expected = lvi.solve(&lmdp);
+
+	int failures = 0;
+
+	for (unsigned int steps = 0; steps <= 5; steps += 5) {
+		LPI lpi(tolerance, steps);
+		PolicyMap *policy = lpi.solve(&lmdp);
+
+		unsigned int differences = 0;
+		for (auto state : *S) {
+			State *s = resolve(state);
+			if (policy->get(s) != expected->get(s)) {
+				differences++;
+			}
+		}
+
+		std::cout << "Evaluation steps " << steps << ": " << lpi.get_num_improvements() << " improvements, " <<
+				lpi.get_num_evaluation_iterations() << " evaluation iterations, " << differences <<
+				" policy differences from LVI." << std::endl;
+
+		if (differences > 0) {
+			failures++;
+		}
+
+		// Only exact evaluation promises the values of the returned policy, and only for the last reward
+		// in the ordering; the others are the values of the policy restricted to their own level.
+		if (steps == 0) {
+			PolicyEvaluator evaluator(tolerance * 0.01, 1);
+
+			std::vector<std::unordered_map<State *, double> > V;
+			evaluator.evaluate(&lmdp, policy, V);
+
+			int i = (int)V.size() - 1;
+
+			double maxDifference = 0.0;
+			for (auto state : *S) {
+				State *s = resolve(state);
+				maxDifference = std::max(maxDifference, std::fabs(V[i].at(s) - lpi.get_V()[i].at(s)));
+			}
+
+			std::cout << "    Reward " << i << ": the values differ from V^pi by " << maxDifference << "." << std::endl;
+
+			if (!(maxDifference <= tolerance)) {
+				failures++;
+			}
+		}
+
+		delete policy;
+	}
+
+	delete expected;
+
+	if (failures > 0) {
+		std::cout << "FAILED" << std::endl;
+		return 1;
+	}
+
+	std::cout << "PASSED" << std::endl;
+	return 0;
+}
@@ -0,0 +1,175 @@
+/**
+ *  The MIT License (MIT)
+ *
+ *  Copyright (c) 2014 Kyle Wray, University of Massachusetts
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy of
+ *  this software and associated documentation files (the "Software"), to deal in
+ *  the Software without restriction, including without limitation the rights to
+ *  use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ *  the Software, and to permit persons to whom the Software is furnished to do so,
+ *  subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ *  FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ *  COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ *  IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ *  CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+
+
+
+/**
+ * Check that every method of the policy evaluator finds the values of the same policy, within the
+ * error bound of its tolerance of those from sweeps with a much smaller tolerance. The sweeps stop at the largest number
+ * of iterations without converging, and an undiscounted model is rejected. Build and run with
+ * make -C tests test, or alone with:
+ *     g++ -std=c++14 -O2 -pthread -o test_policy_evaluator tests/test_policy_evaluator.cpp \
+ *         src/policy_evaluator.cpp src/lvi.cpp src/compiled_lmdp.cpp src/lmdp.cpp src/grid_lmdp.cpp \
+ *         src/thread_pool.cpp src/action_sets.cpp src/lvi_telemetry.cpp src/bellman_kernels.cpp \
+ *         src/lvi_workspace.cpp src/time_indexed_policy.cpp
+ * It returns 0 if every method agrees with the sweeps.
+ */
+
+
+#include "../include/grid_lmdp.h"
+#include "../include/lvi.h"
+#include "../include/policy_evaluator.h"
+
+#include "../../librbr/librbr/include/core/horizon.h"
+#include "../../librbr/librbr/include/core/core_exception.h"
+#include "../../librbr/librbr/include/core/states/state_utilities.h"
+
+#include <iostream>
+#include <string>
+#include <cmath>
+#include <algorithm>
+
+/**
+ * A grid world without a discount factor, which policy evaluation must reject.
+ */
+class UndiscountedGridLMDP : public GridLMDP {
+public:
+	/**
+	 * The constructor for the UndiscountedGridLMDP class.
+	 * @param	seed		The random seed.
+	 * @param	size		The size of the grid.
+	 * @param	blocked		The number of blocked cells.
+	 * @param	penalty		The penalty of each step.
+	 */
+	UndiscountedGridLMDP(unsigned int seed, unsigned int size, unsigned int blocked, double penalty) :
+			GridLMDP(seed, size, blocked, penalty) {
+		delete horizon;
+		horizon = new Horizon(1.0);
+	}
+};
+
+int main()
+{
+	double tolerance = 0.0001;
+
+	GridLMDP lmdp(1, 10, 10, -0.03);
+	lmdp.set_slack(0.5f, 0.2f, 0.0f);
+	lmdp.set_default_conditional_preference();
+
+	int failures = 0;
+
+	LVI solver(tolerance, true);
+	PolicyMap *policy = solver.solve(&lmdp);
+
+	StatesMap *S = dynamic_cast<StatesMap *>(lmdp.get_states());
+
+	PolicyEvaluator reference(tolerance * 0.01, 1);
+	std::vector<std::unordered_map<State *, double> > expected;
+	reference.evaluate(&lmdp, policy, expected);
+
+	if (!reference.get_converged()) {
+		std::cout << "The reference sweeps did not converge." << std::endl;
+		failures++;
+	}
+
+	// Each evaluation stops once its residual is within the criterion, so its values are within
+	// gamma / (1 - gamma) times the criterion of those of the policy, as are those of the reference.
+	double gamma = lmdp.get_horizon()->get_discount_factor();
+	double bound = 1.01 * gamma / (1.0 - gamma) * tolerance * std::max(0.1, (1.0 - gamma) / gamma);
+
+	std::string methods[3] = {"Sweeps", "BiCGSTAB", "GMRES"};
+	std::string preconditioners[3] = {"no", "Jacobi", "ILU(0)"};
+
+	for (int method = POLICY_EVALUATION_SWEEPS; method <= POLICY_EVALUATION_GMRES; method++) {
+		for (int preconditioner = POLICY_PRECONDITIONER_NONE; preconditioner <= POLICY_PRECONDITIONER_ILU0;
+				preconditioner++) {
+			// The preconditioner only applies to the Krylov methods.
+			if (method == POLICY_EVALUATION_SWEEPS && preconditioner != POLICY_PRECONDITIONER_NONE) {
+				continue;
+			}
+
+			PolicyEvaluator evaluator(tolerance, 2);
+			evaluator.set_method((PolicyEvaluationMethod)method);
+			evaluator.set_preconditioner((PolicyEvaluationPreconditioner)preconditioner);
+
+			std::vector<std::unordered_map<State *, double> > V;
+			evaluator.evaluate(&lmdp, policy, V);
+
+			double maxDifference = 0.0;
+			for (auto state : *S) {
+				State *s = resolve(state);
+				for (int i = 0; i < (int)V.size(); i++) {
+					maxDifference = std::max(maxDifference, std::fabs(V[i].at(s) - expected[i].at(s)));
+				}
+			}
+
+			std::cout << methods[method] << " with " << preconditioners[preconditioner] <<
+					" preconditioner: converged " << evaluator.get_converged() << " in " <<
+					evaluator.get_num_sweeps() << " iterations, the values differ by " << maxDifference <<
+					"." << std::endl;
+
+			if (!evaluator.get_converged() || !(maxDifference <= bound)) {
+				failures++;
+			}
+		}
+	}
+
+	// The sweeps stop at the largest number of iterations, and report that they did not converge.
+	PolicyEvaluator capped(tolerance, 1);
+	capped.set_max_iterations(3);
+
+	std::vector<std::unordered_map<State *, double> > V;
+	capped.evaluate(&lmdp, policy, V);
+
+	std::cout << "Capped sweeps: converged " << capped.get_converged() << " in " << capped.get_num_sweeps() <<
+			" sweeps." << std::endl;
+	if (capped.get_converged() || capped.get_num_sweeps() != 3) {
+		failures++;
+	}
+
+	// Without a discount factor, the values of a policy may not exist.
+	UndiscountedGridLMDP undiscounted(1, 10, 10, -0.03);
+	undiscounted.set_default_conditional_preference();
+
+	try {
+		PolicyEvaluator evaluator(tolerance, 1);
+		evaluator.compile(&undiscounted);
+
+		std::cout << "The undiscounted model was not rejected." << std::endl;
+		failures++;
+	} catch (const CoreException &err) {
+		std::cout << "The undiscounted model was rejected." << std::endl;
+	}
+
+	delete policy;
+
+	if (failures > 0) {
+		std::cout << "FAILED" << std::endl;
+		return 1;
+	}
+
+	std::cout << "PASSED" << std::endl;
+	return 0;
+}
@@ -0,0 +1,186 @@
+/**
+ *  The MIT License (MIT)
+ *
+ *  Copyright (c) 2014 Kyle Wray, University of Massachusetts
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy of
+ *  this software and associated documentation files (the "Software"), to deal in
+ *  the Software without restriction, including without limitation the rights to
+ *  use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ *  the Software, and to permit persons to whom the Software is furnished to do so,
+ *  subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ *  FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ *  COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ *  IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ *  CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+
+
+
+/**
+ * Check that the variants of LVI solve the same LMDP alike. Splitting the Jacobi sweeps over threads
+ * and solving the partitions concurrently must not change the values or the policy at all, since each
+ * state's backup reads the same values in the same order. The prioritized and topological solvers
+ * back up the states in other orders, so they must find the same policy, with values within the
+ * tolerance of those of LVI. Evaluating the final policy backs up all of the rewards together, and
+ * must give the values of the policy as an independent policy evaluation computes them, within
+ * gamma / (1 - gamma) times the convergence criterion. Build and run with make -C tests test, or
+ * alone with:
+ *     g++ -std=c++14 -O2 -pthread -o test_solvers tests/test_solvers.cpp src/lvi.cpp \
+ *         src/lvi_prioritized.cpp src/lvi_topological.cpp src/policy_evaluator.cpp src/compiled_lmdp.cpp \
+ *         src/lmdp.cpp src/grid_lmdp.cpp src/thread_pool.cpp src/action_sets.cpp src/lvi_telemetry.cpp \
+ *         src/bellman_kernels.cpp src/lvi_workspace.cpp src/time_indexed_policy.cpp
+ * It returns 0 if every variant agrees with LVI.
+ */
+
+
+#include "../include/grid_lmdp.h"
+#include "../include/lvi.h"
+#include "../include/lvi_prioritized.h"
+#include "../include/lvi_topological.h"
+#include "../include/policy_evaluator.h"
+
+#include "../../librbr/librbr/include/core/states/state_utilities.h"
+
+#include <iostream>
+#include <string>
+#include <cmath>
+#include <algorithm>
+
+/**
+ * Solve an LMDP with a variant of LVI and compare it with the values and policy of LVI.
+ * @param	name		The name of the variant.
+ * @param	solver		The variant, which this deletes.
+ * @param	lmdp		The LMDP.
+ * @param	expected	The solver of LVI, after solving the LMDP.
+ * @param	policy		The policy of LVI.
+ * @param	tolerance	The largest difference allowed between the values.
+ * @return	True if the variant agrees with LVI, and false otherwise.
+ */
+bool compare(std::string name, LVI *solver, GridLMDP &lmdp, LVI &expected, PolicyMap *policy, double tolerance)
+{
+	StatesMap *S = dynamic_cast<StatesMap *>(lmdp.get_states());
+
+	PolicyMap *result = solver->solve(&lmdp);
+
+	double maxDifference = 0.0;
+	unsigned int differences = 0;
+	for (auto state : *S) {
+		State *s = resolve(state);
+		for (int i = 0; i < (int)expected.get_V().size(); i++) {
+			maxDifference = std::max(maxDifference, std::fabs(solver->get_V()[i].at(s) - expected.get_V()[i].at(s)));
+		}
+		if (result->get(s) != policy->get(s)) {
+			differences++;
+		}
+	}
+
+	std::cout << name << ": the values differ from LVI by " << maxDifference << ", with " << differences <<
+			" policy differences." << std::endl;
+
+	delete result;
+	delete solver;
+
+	return (maxDifference <= tolerance && differences == 0);
+}
+
+int main()
+{
+	double tolerance = 0.0001;
+
+	int failures = 0;
+
+	for (int split = 0; split < 2; split++) {
+		GridLMDP lmdp(1, 10, 10, -0.03);
+		lmdp.set_slack(0.5f, 0.2f, 0.0f);
+		if (split == 1) {
+			lmdp.set_split_conditional_preference();
+		} else {
+			lmdp.set_default_conditional_preference();
+		}
+
+		std::cout << (split == 1 ? "Split" : "Default") << " preference:" << std::endl;
+
+		LVI expected(tolerance, true);
+		PolicyMap *policy = expected.solve(&lmdp);
+
+		// These read and write exactly the values sequential LVI does, so they must match it exactly.
+		LVI *threaded = new LVI(tolerance, true);
+		threaded->set_num_threads(4);
+		if (!compare("    Threaded sweeps", threaded, lmdp, expected, policy, 0.0)) {
+			failures++;
+		}
+
+		LVI *concurrent = new LVI(tolerance, true);
+		concurrent->set_concurrent_partitions(true);
+		concurrent->set_num_threads(4);
+		if (!compare("    Concurrent partitions", concurrent, lmdp, expected, policy, 0.0)) {
+			failures++;
+		}
+
+		// With several partitions, a state whose best actions are nearly tied may take another of them
+		// in another order, so these are only compared with a single ordering.
+		if (split == 0) {
+			if (!compare("    Prioritized sweeping", new LVIPrioritized(tolerance), lmdp, expected, policy, tolerance)) {
+				failures++;
+			}
+			if (!compare("    Topological", new LVITopological(tolerance), lmdp, expected, policy, tolerance)) {
+				failures++;
+			}
+		}
+
+		// The evaluation stops once its residual is within the criterion, so its values are within
+		// gamma / (1 - gamma) times the criterion of those of the policy.
+		double gamma = lmdp.get_horizon()->get_discount_factor();
+		double bound = gamma / (1.0 - gamma) * tolerance * std::max(0.1, (1.0 - gamma) / gamma);
+
+		LVI evaluated(tolerance, true);
+		evaluated.set_policy_evaluation(true);
+		evaluated.set_num_threads(2);
+		PolicyMap *evaluatedPolicy = evaluated.solve(&lmdp);
+
+		PolicyEvaluator evaluator(tolerance * 0.01, 1);
+		std::vector<std::unordered_map<State *, double> > V;
+		evaluator.evaluate(&lmdp, evaluatedPolicy, V);
+
+		StatesMap *S = dynamic_cast<StatesMap *>(lmdp.get_states());
+
+		double maxDifference = 0.0;
+		unsigned int differences = 0;
+		for (auto state : *S) {
+			State *s = resolve(state);
+			for (int i = 0; i < (int)V.size(); i++) {
+				maxDifference = std::max(maxDifference, std::fabs(V[i].at(s) - evaluated.get_V()[i].at(s)));
+			}
+			if (evaluatedPolicy->get(s) != policy->get(s)) {
+				differences++;
+			}
+		}
+
+		std::cout << "    Policy evaluation: the values differ from V^pi by " << maxDifference << ", with " <<
+				differences << " policy differences from LVI." << std::endl;
+
+		if (!(maxDifference <= bound) || differences > 0) {
+			failures++;
+		}
+
+		delete evaluatedPolicy;
+		delete policy;
+	}
+
+	if (failures > 0) {
+		std::cout << "FAILED" << std::endl;
+		return 1;
+	}
+
+	std::cout << "PASSED" << std::endl;
+	return 0;
+}
@@ -0,0 +1,147 @@
+/**
+ *  The MIT License (MIT)
+ *
+ *  Copyright (c) 2014 Kyle Wray, University of Massachusetts
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy of
+ *  this software and associated documentation files (the "Software"), to deal in
+ *  the Software without restriction, including without limitation the rights to
+ *  use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ *  the Software, and to permit persons to whom the Software is furnished to do so,
+ *  subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ *  FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ *  COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ *  IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ *  CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+
+
+
+/**
+ * Check that the telemetry of a solve records each reward of each partition once per outer iteration,
+ * that the sweeps it records add up to those the solver counts, and that the final iteration of a
+ * converged solve is recorded as converged. A ring smaller than the solve keeps only the newest
+ * records, and the CSV export holds a header and one line per record. Build and run with
+ * make -C tests test, or alone with:
+ *     g++ -std=c++14 -O2 -pthread -o test_telemetry tests/test_telemetry.cpp src/lvi.cpp \
+ *         src/compiled_lmdp.cpp src/lmdp.cpp src/grid_lmdp.cpp src/thread_pool.cpp src/action_sets.cpp \
+ *         src/lvi_telemetry.cpp src/bellman_kernels.cpp src/lvi_workspace.cpp src/time_indexed_policy.cpp
+ * It returns 0 if the records match the solve.
+ */
+
+
+#include "../include/grid_lmdp.h"
+#include "../include/lvi.h"
+#include "../include/lvi_telemetry.h"
+
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <cstdio>
+
+int main()
+{
+	double tolerance = 0.0001;
+
+	GridLMDP lmdp(1, 10, 10, -0.03);
+	lmdp.set_slack(0.5f, 0.2f, 0.0f);
+	lmdp.set_split_conditional_preference();
+
+	int failures = 0;
+
+	LVI solver(tolerance, true);
+	if (solver.get_telemetry()->is_enabled()) {
+		std::cout << "The default telemetry is enabled." << std::endl;
+		failures++;
+	}
+
+	LVIRingTelemetry ring(10000);
+	solver.set_telemetry(&ring);
+	delete solver.solve(&lmdp);
+
+	unsigned int iterations = solver.get_num_iterations();
+	unsigned int k = (unsigned int)solver.get_num_sweeps().size();
+
+	unsigned int levels = 0;
+	for (const std::vector<unsigned int> &oj : lmdp.get_orderings()) {
+		levels += (unsigned int)oj.size();
+	}
+
+	std::cout << "Recorded " << ring.get_num_records() << " records over " << iterations << " iterations." << std::endl;
+	if (ring.get_num_records() != iterations * levels) {
+		failures++;
+	}
+
+	std::vector<unsigned int> sweeps(k, 0);
+	for (unsigned int r = 0; r < ring.get_num_records(); r++) {
+		const LVITelemetryRecord &record = ring.get_record(r);
+
+		// The records of an iteration follow those of the one before, partition by partition.
+		if (record.iteration != r / levels + 1 || record.reward >= k) {
+			std::cout << "Record " << r << " is out of order." << std::endl;
+			failures++;
+			break;
+		}
+
+		sweeps[record.reward] += record.sweeps;
+
+		if (record.iteration == iterations && !record.converged) {
+			std::cout << "Record " << r << " of the final iteration did not converge." << std::endl;
+			failures++;
+		}
+	}
+
+	for (unsigned int i = 0; i < k; i++) {
+		std::cout << "Reward " << i << ": " << sweeps[i] << " sweeps recorded, " << solver.get_num_sweeps()[i] <<
+				" counted." << std::endl;
+		if (sweeps[i] != solver.get_num_sweeps()[i]) {
+			failures++;
+		}
+	}
+
+	// A small ring keeps the newest records.
+	LVIRingTelemetry small(4);
+	solver.set_telemetry(&small);
+	delete solver.solve(&lmdp);
+
+	if (small.get_num_records() != 4 || small.get_record(3).iteration != solver.get_num_iterations()) {
+		std::cout << "The small ring did not keep the newest records." << std::endl;
+		failures++;
+	}
+
+	std::string filename = "test_telemetry.csv";
+	if (ring.save_csv(filename)) {
+		std::cout << "The records could not be saved." << std::endl;
+		failures++;
+	} else {
+		std::ifstream file(filename);
+		std::string line;
+		unsigned int lines = 0;
+		while (std::getline(file, line)) {
+			lines++;
+		}
+		file.close();
+		std::remove(filename.c_str());
+
+		if (lines != ring.get_num_records() + 1) {
+			std::cout << "The CSV export has " << lines << " lines." << std::endl;
+			failures++;
+		}
+	}
+
+	if (failures > 0) {
+		std::cout << "FAILED" << std::endl;
+		return 1;
+	}
+
+	std::cout << "PASSED" << std::endl;
+	return 0;
+}
@@ -0,0 +1,117 @@
+/**
+ *  The MIT License (MIT)
+ *
+ *  Copyright (c) 2014 Kyle Wray, University of Massachusetts
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy of
+ *  this software and associated documentation files (the "Software"), to deal in
+ *  the Software without restriction, including without limitation the rights to
+ *  use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ *  the Software, and to permit persons to whom the Software is furnished to do so,
+ *  subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ *  FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ *  COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ *  IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ *  CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+
+/**
+ * Check that a thread pool runs every index of a range exactly once, and that an exception thrown by
+ * any chunk, the caller's or a worker's, is rethrown by run once every chunk has completed, leaving
+ * the pool usable. Build and run with
+ * make -C tests test, or alone with:
+ *     g++ -std=c++14 -O2 -pthread -o test_thread_pool tests/test_thread_pool.cpp src/thread_pool.cpp
+ * It returns 0 if the pool behaves.
+ */
+
+
+#include "../include/thread_pool.h"
+
+#include <iostream>
+#include <vector>
+#include <atomic>
+#include <stdexcept>
+
+int main()
+{
+	unsigned int numThreads = 4;
+	ThreadPool pool(numThreads);
+
+	int failures = 0;
+
+	// Every index is run exactly once, for ranges smaller and larger than the number of workers.
+	for (unsigned int count = 0; count < 50; count++) {
+		std::vector<std::atomic<int> > visits(count);
+		for (std::atomic<int> &visit : visits) {
+			visit = 0;
+		}
+
+		pool.run(count, [&](unsigned int /* worker */, unsigned int begin, unsigned int end) {
+			for (unsigned int index = begin; index < end; index++) {
+				visits[index]++;
+			}
+		});
+
+		for (unsigned int index = 0; index < count; index++) {
+			if (visits[index] != 1) {
+				std::cout << "Index " << index << " of " << count << " ran " << visits[index] << " times." << std::endl;
+				failures++;
+			}
+		}
+	}
+
+	// An exception of any worker, including the caller as worker 0, reaches the caller only after all
+	// of the other chunks have finished.
+	for (unsigned int repetition = 0; repetition < 100; repetition++) {
+		for (unsigned int thrower = 0; thrower < numThreads; thrower++) {
+			std::atomic<unsigned int> finished(0);
+			bool caught = false;
+
+			try {
+				pool.run(numThreads, [&](unsigned int worker, unsigned int /* begin */, unsigned int /* end */) {
+					if (worker == thrower) {
+						throw std::runtime_error("chunk failed");
+					}
+					finished++;
+				});
+			} catch (const std::runtime_error &) {
+				caught = true;
+			}
+
+			if (!caught) {
+				std::cout << "The exception of worker " << thrower << " was not rethrown." << std::endl;
+				failures++;
+			}
+			if (finished != numThreads - 1) {
+				std::cout << "Only " << finished << " of the other chunks finished before the rethrow." << std::endl;
+				failures++;
+			}
+		}
+	}
+
+	// The pool still runs tasks afterwards.
+	std::atomic<unsigned int> total(0);
+	pool.run(1000, [&](unsigned int /* worker */, unsigned int begin, unsigned int end) {
+		total += end - begin;
+	});
+	if (total != 1000) {
+		std::cout << "The pool ran " << total << " of 1000 indices after the exceptions." << std::endl;
+		failures++;
+	}
+
+	if (failures > 0) {
+		std::cout << "FAILED" << std::endl;
+		return 1;
+	}
+
+	std::cout << "PASSED" << std::endl;
+	return 0;
+}